@@ -27,6 +27,7 @@ if(USE_CONAN)
 	find_package(OpenCV REQUIRED COMPONENTS core calib3d imgcodecs imgproc highgui dnn ml)
 	find_package(taocpp-json REQUIRED)
 	find_package(magic_enum REQUIRED)
+	find_package(libjpeg-turbo REQUIRED)
 
 	add_library(onnxruntime SHARED IMPORTED)
 	set_target_properties(onnxruntime PROPERTIES
@@ -42,6 +43,8 @@ else(USE_CONAN)
 		"${CMAKE_CURRENT_SOURCE_DIR}/extern/di/include"
 		"${CMAKE_CURRENT_SOURCE_DIR}/extern/PEGTL/include"
 		"${CMAKE_CURRENT_SOURCE_DIR}/extern/abseil-cpp"
+		"${CMAKE_CURRENT_SOURCE_DIR}/extern/opencv-4.5.5/3rdparty/libjpeg-turbo/src"
+		"${CMAKE_CURRENT_SOURCE_DIR}/extern/opencv-4.5.5/build/3rdparty/libjpeg-turbo"
 	)
 	include_directories(
         ${OFIQ_LINK_INCLUDE_LIST}
@@ -107,6 +110,10 @@ else(USE_CONAN)
 		IMPORTED_LOCATION ${CMAKE_CURRENT_SOURCE_DIR}/extern/opencv-4.5.5/build/install/lib/libopencv_flann.so.4.5.5
 		INTERFACE_INCLUDE_DIRECTORIES ${CMAKE_CURRENT_SOURCE_DIR}/extern/opencv-4.5.5/build/install/include/opencv4
 	)
+	add_library(libjpeg-turbo STATIC IMPORTED)
+	set_target_properties(libjpeg-turbo PROPERTIES
+		IMPORTED_LOCATION ${CMAKE_CURRENT_SOURCE_DIR}/extern/opencv-4.5.5/build/3rdparty/lib/liblibjpeg-turbo.a
+	)
 endif(USE_CONAN)
 
 # Find all source files
@@ -122,6 +129,7 @@ if(USE_CONAN)
 		opencv::opencv
 		taocpp::json
 		magic_enum::magic_enum
+		libjpeg-turbo::jpeg
 		onnxruntime
 	)
 else(USE_CONAN)
@@ -136,6 +144,7 @@ else(USE_CONAN)
 		OpenCV::ml
 		OpenCV::features2d
 		OpenCV::flann
+		libjpeg-turbo
 		)
 endif(USE_CONAN)
 
@@ -158,7 +167,9 @@ target_link_libraries(ofiq_lib
 	)
 
 # add a test application
-add_executable(OFIQSampleApp ${OFIQLIB_SOURCE_DIR}/src/OFIQSampleApp.cpp)
+add_executable(OFIQSampleApp
+	${OFIQLIB_SOURCE_DIR}/src/OFIQSampleApp.cpp
+	${OFIQLIB_SOURCE_DIR}/src/OFIQSampleServer.cpp)
 target_link_libraries(OFIQSampleApp
 	PRIVATE ofiq_lib
 	PRIVATE ${OFIQ_LINK_LIB_LIST}
@@ -25,6 +25,7 @@ if(USE_CONAN)
 	find_package(OpenCV REQUIRED COMPONENTS core calib3d imgcodecs imgproc highgui dnn ml)
 	find_package(taocpp-json REQUIRED)
 	find_package(magic_enum REQUIRED)
+	find_package(libjpeg-turbo REQUIRED)
 
 	add_library(onnxruntime SHARED IMPORTED)
 	if( ARCHITECTURE STREQUAL "x64" )
@@ -48,6 +49,8 @@ else(USE_CONAN)
 		"${CMAKE_CURRENT_SOURCE_DIR}/extern/di/include"
 		"${CMAKE_CURRENT_SOURCE_DIR}/extern/PEGTL/include"
 		"${CMAKE_CURRENT_SOURCE_DIR}/extern/abseil-cpp"
+		"${CMAKE_CURRENT_SOURCE_DIR}/extern/opencv-4.5.5/3rdparty/libjpeg-turbo/src"
+		"${CMAKE_CURRENT_SOURCE_DIR}/extern/opencv-4.5.5/build/3rdparty/libjpeg-turbo"
 	)
 	include_directories(
         ${OFIQ_LINK_INCLUDE_LIST}
@@ -149,6 +152,7 @@ if(USE_CONAN)
 		opencv::opencv
 		taocpp::json
 		magic_enum::magic_enum
+		libjpeg-turbo::jpeg
 		onnxruntime
 	)
 else(USE_CONAN)
@@ -197,7 +201,9 @@ target_link_libraries(ofiq_lib
 set_target_properties(ofiq_lib PROPERTIES LINK_FLAGS "/ignore:4099")
 
 # add a test application
-add_executable(OFIQSampleApp ${OFIQLIB_SOURCE_DIR}/src/OFIQSampleApp.cpp)
+add_executable(OFIQSampleApp
+	${OFIQLIB_SOURCE_DIR}/src/OFIQSampleApp.cpp
+	${OFIQLIB_SOURCE_DIR}/src/OFIQSampleServer.cpp)
 target_link_libraries(OFIQSampleApp
 	PRIVATE ofiq_lib
 	PRIVATE ${OFIQ_LINK_LIB_LIST}
@@ -115,6 +115,110 @@ namespace OFIQ
         virtual OFIQ::ReturnStatus vectorQuality(
             const OFIQ::Image& image, OFIQ::FaceImageQualityAssessment& assessments) = 0;
 
+        /**
+         * @brief  This function takes an encoded image and outputs quality information.
+         *
+         * @details Same as vectorQuality() but the image is passed as JPEG or PNG encoded
+         * byte array. This allows implementations to decode only the parts of the image
+         * needed for the assessment, e.g. a down-scaled version for the face detection and
+         * the face region at full resolution.
+         * The default implementation returns ReturnCode::NotImplemented.
+         *
+         * @param[in] encodedImage
+         * JPEG or PNG encoded single face image
+         *
+         * @param[out] assessments
+         * An ImageQualityAssessments structure, see vectorQuality().
+         * 
+         * @return OFIQ::ReturnStatus
+         */
+        virtual OFIQ::ReturnStatus vectorQualityFromEncodedImage(
+            const std::vector<uint8_t>& /*encodedImage*/, OFIQ::FaceImageQualityAssessment& /*assessments*/)
+        {
+            return OFIQ::ReturnStatus(OFIQ::ReturnCode::NotImplemented, "vectorQualityFromEncodedImage");
+        }
+
+        /**
+         * @brief  This function recomputes the quality component values from native quality scores.
+         *
+         * @details The native quality scores of a previous call to vectorQuality() are mapped to
+         * quality component values with the quality mappings of the current configuration, e.g. after
+         * the sigmoid parameters have been changed. No image is processed.
+         * The default implementation returns ReturnCode::NotImplemented.
+         *
+         * @param[in,out] assessments
+         * An ImageQualityAssessments structure holding the native quality scores. The scalar
+         * values of all configured measures are overwritten, except for results with the
+         * return code QualityMeasureReturnCode::FailureToAssess.
+         * 
+         * @return OFIQ::ReturnStatus
+         */
+        virtual OFIQ::ReturnStatus rescoreQuality(OFIQ::FaceImageQualityAssessment& /*assessments*/)
+        {
+            return OFIQ::ReturnStatus(OFIQ::ReturnCode::NotImplemented, "rescoreQuality");
+        }
+
+        /**
+         * @brief  This function takes an image and outputs quality information together with
+         * the pre-processing artifacts.
+         *
+         * @details Same as vectorQuality(), in addition the results of the pre-processing (face
+         * detection, pose estimation, landmark extraction, alignment and segmentation) are returned
+         * in a binary encoding. They can be stored, e.g. in an artifact store, and passed to
+         * vectorQualityFromArtifacts() to assess the image again without running the pre-processing.
+         * The default implementation returns ReturnCode::NotImplemented.
+         *
+         * @param[in] image
+         * Single face image
+         *
+         * @param[out] assessments
+         * An ImageQualityAssessments structure, see vectorQuality().
+         *
+         * @param[out] artifacts
+         * Encoded pre-processing artifacts. Empty if the pre-processing failed.
+         * 
+         * @return OFIQ::ReturnStatus
+         */
+        virtual OFIQ::ReturnStatus vectorQualityWithArtifacts(
+            const OFIQ::Image& /*image*/,
+            OFIQ::FaceImageQualityAssessment& /*assessments*/,
+            std::vector<uint8_t>& /*artifacts*/)
+        {
+            return OFIQ::ReturnStatus(OFIQ::ReturnCode::NotImplemented, "vectorQualityWithArtifacts");
+        }
+
+        /**
+         * @brief  This function takes an image and its pre-processing artifacts and outputs quality information.
+         *
+         * @details Same as vectorQuality(), but instead of running the pre-processing the results
+         * returned by vectorQualityWithArtifacts() are used. Only the aligned face is recomputed.
+         * The artifacts must have been computed with the same configuration.
+         * The default implementation returns ReturnCode::NotImplemented.
+         *
+         * @param[in] image
+         * Single face image the artifacts have been computed for
+         *
+         * @param[in] artifacts
+         * Pointer to the encoded pre-processing artifacts
+         *
+         * @param[in] artifactsSize
+         * Number of bytes of the encoded pre-processing artifacts. If 0, the pre-processing is
+         * considered as failed.
+         *
+         * @param[out] assessments
+         * An ImageQualityAssessments structure, see vectorQuality().
+         * 
+         * @return OFIQ::ReturnStatus
+         */
+        virtual OFIQ::ReturnStatus vectorQualityFromArtifacts(
+            const OFIQ::Image& /*image*/,
+            const uint8_t* /*artifacts*/,
+            size_t /*artifactsSize*/,
+            OFIQ::FaceImageQualityAssessment& /*assessments*/)
+        {
+            return OFIQ::ReturnStatus(OFIQ::ReturnCode::NotImplemented, "vectorQualityFromArtifacts");
+        }
+
         /**
          * @brief
          * Factory method to return a shared pointer to the Interface object.
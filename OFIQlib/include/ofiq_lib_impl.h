@@ -31,6 +31,7 @@
 #include "Executor.h"
 #include "ofiq_lib.h"
 #include "NeuronalNetworkContainer.h"
+#include "ResultCache.h"
 
  /**
   * @brief Namespace for OFIQ implementations.
@@ -88,6 +89,56 @@ namespace OFIQ_LIB
         OFIQ::ReturnStatus vectorQuality(
             const OFIQ::Image& image, OFIQ::FaceImageQualityAssessment& assessments) override;
 
+        /**
+         * @brief Run the computation of all measures set in the configuration on an encoded image.
+         * @details JPEG images are decoded on demand, see \link OFIQ_LIB::EncodedImage EncodedImage\endlink.
+         * 
+         * @param[in] encodedImage JPEG or PNG encoded input image.
+         * @param[out] assessments Container to store the resulting scores.
+         * @return OFIQ::ReturnStatus 
+         */
+        OFIQ::ReturnStatus vectorQualityFromEncodedImage(
+            const std::vector<uint8_t>& encodedImage, OFIQ::FaceImageQualityAssessment& assessments) override;
+
+        /**
+         * @brief Recompute the quality component values of all measures set in the configuration
+         * from the native quality scores.
+         * 
+         * @param[in,out] assessments Container holding the native quality scores.
+         * @return OFIQ::ReturnStatus 
+         */
+        OFIQ::ReturnStatus rescoreQuality(OFIQ::FaceImageQualityAssessment& assessments) override;
+
+        /**
+         * @brief Run the computation of all measures set in the configuration and return the pre-processing artifacts.
+         * 
+         * @param[in] image Input image.
+         * @param[out] assessments Container to store the resulting scores.
+         * @param[out] artifacts Pre-processing artifacts serialized by \link OFIQ_LIB::Session::serialize()
+         * Session::serialize()\endlink, empty if the pre-processing failed.
+         * @return OFIQ::ReturnStatus 
+         */
+        OFIQ::ReturnStatus vectorQualityWithArtifacts(
+            const OFIQ::Image& image,
+            OFIQ::FaceImageQualityAssessment& assessments,
+            std::vector<uint8_t>& artifacts) override;
+
+        /**
+         * @brief Run the computation of all measures set in the configuration using stored pre-processing artifacts.
+         * 
+         * @param[in] image Input image.
+         * @param[in] artifacts Pre-processing artifacts serialized by \link OFIQ_LIB::Session::serialize()
+         * Session::serialize()\endlink.
+         * @param[in] artifactsSize Number of bytes of the artifacts.
+         * @param[out] assessments Container to store the resulting scores.
+         * @return OFIQ::ReturnStatus 
+         */
+        OFIQ::ReturnStatus vectorQualityFromArtifacts(
+            const OFIQ::Image& image,
+            const uint8_t* artifacts,
+            size_t artifactsSize,
+            OFIQ::FaceImageQualityAssessment& assessments) override;
+
     private:
         /**
          * @brief Pointer to the executor instance, see \link OFIQ_LIB::modules::measures::Executor \endlink.
@@ -126,6 +177,12 @@ namespace OFIQ_LIB
          */
         std::unique_ptr<NeuronalNetworkContainer> networks;
 
+        /**
+         * @brief Cache of assessments of previously processed images, see \link OFIQ_LIB::ResultCache ResultCache\endlink.
+         * @details Null if the cache is disabled in the configuration.
+         */
+        std::unique_ptr<ResultCache> m_resultCache;
+
         /**
          * @brief Create a Executor object
          * 
@@ -140,6 +197,14 @@ namespace OFIQ_LIB
          */
         void CreateNetworks();
 
+        /**
+         * @brief Create the result cache if it is enabled in the configuration.
+         * @details The cache is configured by <code>params.result_cache.capacity</code> (0 disables
+         * the cache) and <code>params.result_cache.file</code> (optional persistence file, relative
+         * to the configuration directory).
+         */
+        void CreateResultCache();
+
         /**
          * @brief Perform the preprocessing.
          * 
@@ -157,6 +222,38 @@ namespace OFIQ_LIB
          * OFIQImpl::performPreprocessing()\endlink method
          */
         void alignFaceImage(Session& session) const;
+
+        /**
+         * @brief Restore the pre-processing results from serialized artifacts instead of running the pre-processing.
+         * @details Unless it has been serialized, the aligned face is recomputed from the image and the stored
+         * transformation matrix.
+         * 
+         * @param session Session object containing the original facial image.
+         * @param artifacts Pre-processing artifacts serialized by \link OFIQ_LIB::Session::serialize()
+         * Session::serialize()\endlink.
+         * @param artifactsSize Number of bytes of the artifacts.
+         * @throws OFIQError with ReturnCode::FaceDetectionError if the artifacts are empty and with
+         * ReturnCode::UnknownError if they are invalid.
+         */
+        void restorePreprocessing(Session& session, const uint8_t* artifacts, size_t artifactsSize) const;
+
+        /**
+         * @brief Returns true if gray scale images are kept single channel during the alignment,
+         * see <code>params.preprocessing.keep_gray_scale</code>.
+         */
+        bool keepGrayScale() const;
+
+        /**
+         * @brief Perform the preprocessing and the computation of all measures on a session.
+         * @details If the preprocessing fails, all measures are set to FailureToAssess.
+         * 
+         * @param session Session object containing the input image.
+         * @param preprocessing Function filling the session with the pre-processing results, by default
+         * \link OFIQ_LIB::OFIQImpl::performPreprocessing() performPreprocessing()\endlink.
+         * @return OFIQ::ReturnStatus 
+         */
+        OFIQ::ReturnStatus assessQuality(
+            Session& session, const std::function<void(Session&)>& preprocessing = nullptr);
     };
 }
 
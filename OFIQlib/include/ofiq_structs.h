@@ -41,6 +41,20 @@
   */
 namespace OFIQ
 {
+    /**
+     * @brief
+     * Pixel formats of images
+     */
+    enum class PixelFormat
+    {
+        /** 24 bit color image with channel order red, green, blue */
+        RGB,
+        /** 24 bit color image with channel order blue, green, red */
+        BGR,
+        /** 8 bit intensity image */
+        GRAY
+    };
+
     /**
      * @brief
      * Struct representing a single image
@@ -57,8 +71,16 @@ namespace OFIQ
         /** Managed pointer to raster scanned data.
          * Either RGB color or intensity.
          * If image_depth == 24 this points to  3WH bytes  RGBRGBRGB...
-         * If image_depth ==  8 this points to  WH bytes  IIIIIII */
+         * (or BGRBGRBGR... if pixelFormat is PixelFormat::BGR)
+         * If image_depth ==  8 this points to  WH bytes  IIIIIII
+         * Rows are tightly packed unless a stride is set. */
         std::shared_ptr<uint8_t> data;
+        /** Number of bytes between the beginnings of two consecutive rows.
+         * The value 0 denotes tightly packed rows, see \link OFIQ::Image::rowStride rowStride\endlink. */
+        size_t stride{ 0 };
+        /** Channel order of 24 bit images. Images with a depth of 8 are always
+         * intensity images regardless of this value. */
+        PixelFormat pixelFormat{ PixelFormat::RGB };
 
         /** 
          * @brief Constructor 
@@ -86,15 +108,47 @@ namespace OFIQ
         {
         }
 
-        /** @brief This function returns the size of the image data. */
+        /**
+         * @brief Creates an image referencing pixel data owned by the caller.
+         *
+         * @attention No data are copied. The caller must keep the pixel data alive and
+         * unchanged as long as the image or any copy of it is in use.
+         *
+         * @param width of the image.
+         * @param height of the image.
+         * @param pixelFormat of the image, determines the depth.
+         * @param pixels Pointer to the first pixel of the image.
+         * @param stride Number of bytes between the beginnings of two consecutive rows,
+         * 0 for tightly packed rows.
+         * @return Image referencing the pixel data.
+         */
+        static Image borrow(
+            uint16_t width, uint16_t height, PixelFormat pixelFormat, uint8_t* pixels, size_t stride = 0)
+        {
+            Image image;
+            image.width = width;
+            image.height = height;
+            image.depth = pixelFormat == PixelFormat::GRAY ? 8 : 24;
+            image.pixelFormat = pixelFormat;
+            image.stride = stride;
+            image.data = std::shared_ptr<uint8_t>(pixels, [](uint8_t*) { /* borrowed memory */ });
+            return image;
+        }
+
+        /** @brief This function returns the size of the image data without row padding. */
         size_t size() const { return (static_cast<size_t>(width) * height * (depth / 8)); }
 
+        /** @brief This function returns the number of bytes between the beginnings of two consecutive rows. */
+        size_t rowStride() const { return stride != 0 ? stride : static_cast<size_t>(width) * (depth / 8); }
+
         /**
          * @brief Overwrites the data of the image being a deepcopy of the specified
          * parameters.
          * 
          * @details This method can be used by a binding such as Java/JNI when the memory
          * of the specified data is managed by another mechanism such as Java's garbage collector.
+         * The specified data are expected to be tightly packed RGB or intensity values, the
+         * stride and pixel format of the image are reset accordingly.
          *
          * @param[in] width of the image.
          * @param[in] height of the image.
@@ -106,6 +160,8 @@ namespace OFIQ
             this->width = width;
             this->height = height;
             this->depth = depth;
+            this->stride = 0;
+            this->pixelFormat = PixelFormat::RGB;
             size_t size = this->size();
             this->data.reset(new uint8_t[size], std::default_delete<uint8_t[]>());
             memcpy(this->data.get(), data.get(), size);
@@ -480,6 +536,14 @@ namespace OFIQ
          */
         BoundingBox boundingBox;
 
+        /**
+         * @brief Face embedding computed by the unified quality score network.
+         * @details Only set if "UnifiedQualityScore"."export_embedding" is enabled in the
+         * configuration and the network has an embedding output; empty otherwise.
+         * 
+         */
+        std::vector<float> embedding;
+
         /**
          * @brief Default contructor
          * 
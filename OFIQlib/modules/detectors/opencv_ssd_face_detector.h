@@ -91,5 +91,12 @@ namespace OFIQ_LIB::modules::detectors
          * 
          */
         double m_minimalRelativeFaceSize;
+
+        /**
+         * @brief Resample the image directly into the network's input resolution instead of padding
+         * and resizing it. Read from the configuration file; false by default.
+         * 
+         */
+        bool m_downscaledInput = false;
     };
 }
@@ -48,11 +48,14 @@ namespace OFIQ_LIB::modules::detectors
         const std::string paramConfidenceThreshold = pathPrefix + "confidence_thr";
         const std::string paramPadding = pathPrefix + "padding";
         const std::string paramMinimalRelativeFaceSize = pathPrefix + "min_rel_face_size";
+        const std::string paramDownscaledInput = pathPrefix + "downscaled_input";
 
 
         m_confidenceThreshold = config.GetNumber(paramConfidenceThreshold);
         m_padding = config.GetNumber(paramPadding);
         m_minimalRelativeFaceSize = config.GetNumber(paramMinimalRelativeFaceSize);
+        if (!config.GetBool(paramDownscaledInput, m_downscaledInput))
+            m_downscaledInput = false;
         const auto fileNameProtoTxt = config.getDataDir() + "/" + config.GetString(paramPrototxt);
         const auto fileNameCaffeModel =
             config.getDataDir() + "/" + config.GetString(paramCaffemodel);
@@ -79,16 +82,11 @@ namespace OFIQ_LIB::modules::detectors
 
         auto& faceImage = session.image();
 
-        const bool isRGB = faceImage.depth == 24;
-
-        cv::Mat cvImage(
-            faceImage.height,
-            faceImage.width,
-            isRGB ? CV_8UC3 : CV_8UC1,
-            faceImage.data.get());
-
-        if (!isRGB)
-            cv::cvtColor(cvImage, cvImage, cv::COLOR_GRAY2RGB);
+        // If a down-scaled version of the image is available, it is used instead of the full
+        // resolution image; each of its pixels covers scale x scale pixels of the image.
+        const auto& detectionImage = session.hasDetectionImage() ? session.getDetectionImage() : faceImage;
+        const double scale = session.hasDetectionImage() ? session.getDetectionImageScaleDenominator() : 1.0;
+        const bool isRGB = detectionImage.depth == 24;
 
         int paddingHorizontal = 0;
         int paddingVertical = 0;
@@ -96,20 +94,56 @@ namespace OFIQ_LIB::modules::detectors
         {
             paddingHorizontal = static_cast<int>(faceImage.width * m_padding);
             paddingVertical = static_cast<int>(faceImage.height * m_padding);
-            cv::Mat paddedImage{
-                cvImage.rows + paddingVertical * 2,
-                cvImage.cols + paddingHorizontal * 2,
-                cvImage.type() };
-            cv::copyMakeBorder(cvImage, paddedImage, paddingVertical, paddingVertical, paddingHorizontal, paddingHorizontal, BORDER_CONSTANT);
-            cvImage = paddedImage;
         }
+        const int paddedWidth = faceImage.width + paddingHorizontal * 2;
+        const int paddedHeight = faceImage.height + paddingVertical * 2;
+
+        const Size inputSize(300, 300);
+        Mat inputImage;
+        if (session.hasDetectionImage() || m_downscaledInput)
+        {
+            // The (down-scaled) image is resampled directly into the network's input resolution
+            // at the sampling positions of resizing the padded full resolution image; the padding
+            // remains black and no padded copy of the image is made. Note that warpAffine() quantizes
+            // the sub-pixel offsets differently than resize(), so this input is only an approximation
+            // of the full resolution path.
+            const double scaleX = inputSize.width / static_cast<double>(paddedWidth);
+            const double scaleY = inputSize.height / static_cast<double>(paddedHeight);
+            Mat toInputSize = (Mat_<double>(2, 3) <<
+                scaleX * scale, 0, scaleX * (paddingHorizontal + scale / 2) - 0.5,
+                0, scaleY * scale, scaleY * (paddingVertical + scale / 2) - 0.5);
+
+            warpAffine(
+                wrapToCvImage(detectionImage),
+                inputImage,
+                toInputSize,
+                inputSize,
+                INTER_LINEAR,
+                BORDER_CONSTANT,
+                Scalar(0, 0, 0));
+        }
+        else
+        {
+            // the padded image is resized to the network's input resolution by blobFromImage()
+            inputImage = wrapToCvImage(faceImage);
+            if (m_padding > 0)
+            {
+                Mat paddedImage;
+                cv::copyMakeBorder(inputImage, paddedImage, paddingVertical, paddingVertical, paddingHorizontal, paddingHorizontal, BORDER_CONSTANT);
+                inputImage = paddedImage;
+            }
+        }
+
+        if (!isRGB)
+            cv::cvtColor(inputImage, inputImage, cv::COLOR_GRAY2RGB);
 
         auto meanBGR = Scalar(104, 117, 123);
-        bool doSwapRB = true; // need to swap RB for RGB images
+        // need to swap RB for RGB images
+        bool doSwapRB = !isRGB || detectionImage.pixelFormat != OFIQ::PixelFormat::BGR;
         bool doCrop = false;
 
         // Create a 4D blob from the image.
-        Mat blob = dnn::blobFromImage(cvImage, 1.0, Size(300, 300), meanBGR, doSwapRB, doCrop);
+        Mat blob = dnn::blobFromImage(inputImage, 1.0, inputSize, meanBGR, doSwapRB, doCrop);
 
         // Run a model.
         m_dnnNet->setInput(blob /*, "", 1.0, mean*/);
@@ -142,10 +176,10 @@ namespace OFIQ_LIB::modules::detectors
                     b < 1 &&
                     r - l > m_minimalRelativeFaceSize)
                 {
-                    auto left = static_cast<int>(round(l * static_cast<float>(cvImage.cols))) - paddingHorizontal;
-                    auto top = static_cast<int>(round(t * static_cast<float>(cvImage.rows))) - paddingVertical;
-                    auto width = static_cast<int>(round((r - l) * static_cast<float>(cvImage.cols)));
-                    auto height = static_cast<int>(round((b - t) * static_cast<float>(cvImage.rows)));
+                    auto left = static_cast<int>(round(l * static_cast<float>(paddedWidth))) - paddingHorizontal;
+                    auto top = static_cast<int>(round(t * static_cast<float>(paddedHeight))) - paddingVertical;
+                    auto width = static_cast<int>(round((r - l) * static_cast<float>(paddedWidth)));
+                    auto height = static_cast<int>(round((b - t) * static_cast<float>(paddedHeight)));
                     
                     classIds.push_back((int)(data[i + 1]) - 1); // Skip 0th background class id.
                     confidences.push_back(confidence);
@@ -28,6 +28,7 @@
 
 #include "ofiq_lib.h"
 #include "PartExtractor.h"
+#include "Session.h"
 #include <opencv2/opencv.hpp>
 
 /**
@@ -79,6 +80,40 @@ namespace OFIQ_LIB::modules::landmarks
         (const OFIQ::FaceLandmarks& faceLandmarks, const int height, const int width, 
          const float alpha = 0);
 
+        /**
+         * @brief Computes the part of the face mask of
+         * \link GetFaceMask(const OFIQ::FaceLandmarks&, const int, const int, const float) GetFaceMask()\endlink
+         * covered by the face region, without allocating the complete mask image.
+         * @details The face region is the square around the convex hull of the landmarks which is rasterized,
+         * clipped to the mask image. All pixels of the mask image outside this region are 0.
+         * @param faceLandmarks Facial landmarks object
+         * @param height Height of the mask image
+         * @param width Width of the mask image
+         * @param region Returns the face region in coordinates of the mask image.
+         * @param alpha Should be 0; different values have only be used for NIST submissions.
+         * @return Mask of the face region
+         */
+        static cv::Mat GetFaceMaskRegion
+        (const OFIQ::FaceLandmarks& faceLandmarks, const int height, const int width, cv::Rect& region,
+         const float alpha = 0);
+
+        /**
+         * @brief Returns the face mask of the specified landmarks like
+         * \link GetFaceMask(const OFIQ::FaceLandmarks&, const int, const int, const float) GetFaceMask()\endlink,
+         * reusing a mask already computed for the same arguments in the session.
+         * @details The returned mask shares its pixels with the mask memoized by the session,
+         * see \link OFIQ_LIB::Session::getFaceMask() Session::getFaceMask()\endlink, and must not be modified.
+         * @param session Session memoizing the masks
+         * @param faceLandmarks Facial landmarks object
+         * @param height Height of the mask image
+         * @param width Width of the mask image
+         * @param alpha Should be 0; different values have only be used for NIST submissions.
+         * @return Mask image
+         */
+        static cv::Mat GetFaceMask
+        (const Session& session, const OFIQ::FaceLandmarks& faceLandmarks, const int height, const int width,
+         const float alpha = 0);
+
         /**
          * @brief Convenience method for computing the Euclidean distance between two landmark points.
          * @param a First landmark point
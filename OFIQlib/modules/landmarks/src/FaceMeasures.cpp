@@ -95,6 +95,17 @@ namespace OFIQ_LIB::modules::landmarks
 
     cv::Mat FaceMeasures::GetFaceMask(
         const OFIQ::FaceLandmarks& faceLandmarks, const int height, const int width, const float alpha)
+    {
+        cv::Rect region;
+        cv::Mat regionMask = GetFaceMaskRegion(faceLandmarks, height, width, region, alpha);
+        cv::Mat faceRegion = cv::Mat::zeros(cv::Size(width, height), CV_8UC1);
+        if (!region.empty())
+            regionMask.copyTo(faceRegion(region));
+        return faceRegion;
+    }
+
+    cv::Mat FaceMeasures::GetFaceMaskRegion(
+        const OFIQ::FaceLandmarks& faceLandmarks, const int height, const int width, cv::Rect& region, const float alpha)
     {
         std::vector<cv::Point2i> landmarkPoints;
         for (const auto& landmark : faceLandmarks.landmarks)
@@ -167,44 +178,41 @@ namespace OFIQ_LIB::modules::landmarks
         }
         // generate mask of convex hull
         cv::Mat mask = cv::Mat::zeros(cv::Size(imgSize, imgSize), CV_8UC1);
-
         cv::fillConvexPoly(mask, hullPoints, cv::Scalar(1));
-        cv::Mat faceRegion = cv::Mat::zeros(cv::Size(width, height), CV_8UC1);
-        cv::Mat maskRescaled;
-        cv::resize(mask, maskRescaled, cv::Size(c - a, d - b), 0, 0, cv::INTER_NEAREST);
-        int left = 0;
-        int top = 0;
-        int right = maskRescaled.cols;
-        int bottom = maskRescaled.rows;
-        int an = a;
-        int bn = b;
-        int cn = c;
-        int dn = d;
-        if (a < 0)
-        {
-            left -= a;
-            an = 0;
-        }
-        if (c > width)
-        {
-            right = maskRescaled.cols - (c - width);
-            cn = width;
-        }
-        if (b < 0)
-        {
-            top -= b;
-            bn = 0;
-        }
-        if (d > height)
+
+        // Rescale the mask to the square (a,b)-(c,d) by nearest neighbour interpolation, computing only
+        // the part of the square inside the mask image. The source indices are computed as done by
+        // cv::resize with cv::INTER_NEAREST.
+        CV_Assert(c > a && d > b);
+        region = cv::Rect(a, b, c - a, d - b) & cv::Rect(0, 0, width, height);
+        cv::Mat faceRegion(region.size(), CV_8UC1);
+        if (region.empty())
+            return faceRegion;
+        double ifx = 1. / (static_cast<double>(c - a) / imgSize);
+        double ify = 1. / (static_cast<double>(d - b) / imgSize);
+        std::vector<int> xOffsets(region.width);
+        for (int x = 0; x < region.width; x++)
+            xOffsets[x] = std::min(cvFloor((region.x - a + x) * ifx), imgSize - 1);
+        for (int y = 0; y < region.height; y++)
         {
-            bottom = maskRescaled.rows - (d - height);
-            dn = height;
+            int sy = std::min(cvFloor((region.y - b + y) * ify), imgSize - 1);
+            const uchar* src = mask.ptr<uchar>(sy);
+            uchar* dst = faceRegion.ptr<uchar>(y);
+            for (int x = 0; x < region.width; x++)
+                dst[x] = src[xOffsets[x]];
         }
-        cv::Mat crop = maskRescaled(cv::Range(top, bottom), cv::Range(left, right));
-        crop.copyTo(faceRegion(cv::Range(bn, dn), cv::Range(an, cn)));
         return faceRegion;
     }
 
+    cv::Mat FaceMeasures::GetFaceMask(
+        const Session& session, const OFIQ::FaceLandmarks& faceLandmarks, const int height, const int width, const float alpha)
+    {
+        return session.getFaceMask(faceLandmarks, height, width, alpha, [&faceLandmarks, height, width, alpha]()
+        {
+            return GetFaceMask(faceLandmarks, height, width, alpha);
+        });
+    }
+
     double FaceMeasures::GetMaxPairDistance(
         const OFIQ::FaceLandmarks& landmarks, landmarks::FaceParts facePart)
     {
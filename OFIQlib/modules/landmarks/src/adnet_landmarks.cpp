@@ -65,13 +65,13 @@ namespace OFIQ_LIB::modules::landmarks
         }
 
         // init onnx session
-        void init_session(const std::vector<uint8_t>& i_model_data)
+        void init_session(const std::vector<uint8_t>& i_model_data, const OnnxRuntimeThreading& i_threading)
         {
             m_ort_session = std::make_unique<Ort::Session>(
                 m_ortenv,
                 i_model_data.data(), 
                 i_model_data.size(),
-                Ort::SessionOptions{nullptr});
+                CreateOnnxRuntimeSessionOptions(i_threading));
 
 
             get_parameter_from_model(
@@ -249,7 +249,7 @@ namespace OFIQ_LIB::modules::landmarks
                 (std::istreambuf_iterator<char>(instream)),
                 std::istreambuf_iterator<char>());
 
-            landmarkExtractor_->init_session(modelData);
+            landmarkExtractor_->init_session(modelData, getOnnxRuntimeThreading(config));
         }
         catch (const std::exception&)
         {
@@ -283,44 +283,20 @@ namespace OFIQ_LIB::modules::landmarks
         const size_t faceIndex = 0; // take largest face found
         OFIQ::BoundingBox detectedFace = faceRects[faceIndex];
 
-        cv::Mat cvImage = copyToCvImage(session.image());
-        Point2i translationVector{ 0, 0 };
-
         if (detectedFace.faceDetector == FaceDetectorType::OPENCVSSD) {
-            // SSD bounding box does not have to be quadratic -> check and make it square
-            cv::Mat cvImage_maybe_padded;
-            OFIQ::BoundingBox detectedFaceSquare;
-            
-            OFIQ_LIB::makeSquareBoundingBoxWithPadding(
-                detectedFace,
-                cvImage,
-                cvImage_maybe_padded,
-                detectedFaceSquare,
-                translationVector
-            );
-            cvImage = cvImage_maybe_padded;
-            detectedFace = detectedFaceSquare;
-
+            // SSD bounding box does not have to be quadratic -> make it square
+            detectedFace = OFIQ_LIB::makeSquareBoundingBox(detectedFace);
         } // if opencvssd
 
-        // crop image
-        // Define the region of interest (ROI) for cropping
-        cv::Rect roi(
-            detectedFace.xleft,
-            detectedFace.ytop,
-            detectedFace.width,
-            detectedFace.height); // (x, y, width, height)
-
-        // Crop the image using the ROI
-        cv::Mat croppedImage = cvImage(roi);
-        if (!croppedImage.isContinuous())
-            croppedImage = croppedImage.clone();
+        // crop image: only the face region is copied, parts of the region
+        // outside the image are padded with black
+        cv::Mat croppedImage = copyRegionToCvImage(session.image(), detectedFace);
 
         std::vector<float> landmarks_from_net = landmarkExtractor_->extractLandMarks(croppedImage);
         float scalingFactor = detectedFace.height / 256.0f;
 
-        int offset_x = detectedFace.xleft - translationVector.x;
-        int offset_y = detectedFace.ytop - translationVector.y;
+        int offset_x = detectedFace.xleft;
+        int offset_y = detectedFace.ytop;
         for (int i = 0; i < landmarks_from_net.size(); i += 2)
         {
             auto x = static_cast<int>(
@@ -55,5 +55,12 @@ namespace OFIQ_LIB::modules::measures
          * @param session Session object.
          */
         void Execute(OFIQ_LIB::Session & session) override;
+
+        /**
+         * @brief Returns the quality components LeftwardCropOfTheFaceImage, RightwardCropOfTheFaceImage,
+         * MarginAboveOfTheFaceImage and MarginBelowOfTheFaceImage.
+         * @return List of enum values of the quality components.
+         */
+        std::vector<OFIQ::QualityMeasure> GetQualityComponents() const override;
     };
 }
\ No newline at end of file
@@ -56,5 +56,14 @@ namespace OFIQ_LIB::modules::measures
          * @param session Session object.
          */
         void Execute(OFIQ_LIB::Session & session) override;
+
+        /**
+         * @brief Maps a native quality score to its quality component value.
+         * @details The quality component value is 12.5 times the entropy, rounded and clipped to [0,100].
+         * @param measure Enum value of the quality component.
+         * @param rawValue Native quality score.
+         * @return Quality component value.
+         */
+        double ConvertRawScore(OFIQ::QualityMeasure measure, double rawValue) override;
     };
 }
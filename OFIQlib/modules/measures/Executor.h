@@ -68,6 +68,12 @@ namespace OFIQ_LIB::modules::measures
          */
         void ExecuteAll(Session & i_currentSession) const;
 
+        /**
+         * @brief Recompute the quality component values of the activated measures from the native quality scores.
+         * @param assessment Container holding the native quality scores.
+         */
+        void RescoreAll(OFIQ::FaceImageQualityAssessment& assessment) const;
+
         /**
          * @brief Return the list of the activated measures.
          *
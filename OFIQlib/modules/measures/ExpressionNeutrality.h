@@ -29,6 +29,7 @@
 
 #include "landmarks.h"
 #include "Measure.h"
+#include "TreeEnsemble.h"
 #include <ONNXRTSegmentation.h>
 
  /**
@@ -79,5 +80,17 @@ namespace OFIQ_LIB::modules::measures
          * Set by ExpressionNeutrality.adaboost_model_path in the configuration file.
          */
         std::shared_ptr<cv::ml::Boost> m_classifier;
+
+        /**
+         * @brief Flattened trees of the AdaBoost classifier, used for the prediction if they
+         * reproduce the predictions of m_classifier. Otherwise nullptr.
+         */
+        std::unique_ptr<TreeEnsemble> m_treeEnsemble;
+
+        /**
+         * @brief If true, CNN2 runs in a separate thread concurrently to CNN1.
+         * Set by ExpressionNeutrality.concurrent_inference in the configuration file.
+         */
+        bool m_concurrentInference = true;
     };
 }
\ No newline at end of file
@@ -62,5 +62,15 @@ namespace OFIQ_LIB::modules::measures
          * @see \link OFIQ_LIB::modules::segmentations::FaceOcclusionSegmentation FaceOcclusionSegmentation\endlink
          */
         void Execute(OFIQ_LIB::Session & session) override;
+
+        /**
+         * @brief Maps a native quality score to its quality component value.
+         * @details The quality component value is 100 times the fraction of the face region
+         * that is not occluded.
+         * @param measure Enum value of the quality component.
+         * @param rawValue Native quality score.
+         * @return Quality component value.
+         */
+        double ConvertRawScore(OFIQ::QualityMeasure measure, double rawValue) override;
     };
 }
\ No newline at end of file
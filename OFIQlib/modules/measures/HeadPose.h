@@ -55,5 +55,21 @@ namespace OFIQ_LIB::modules::measures
          * OFIQImpl::performPreprocessing()\endlink method.
          */
         void Execute(OFIQ_LIB::Session & session) override;
+
+        /**
+         * @brief Maps a native quality score to its quality component value.
+         * @details The quality component value is 100 times the squared cosine of the angle,
+         * where negative cosine values are set to 0.
+         * @param measure Enum value of the quality component.
+         * @param rawValue Native quality score.
+         * @return Quality component value.
+         */
+        double ConvertRawScore(OFIQ::QualityMeasure measure, double rawValue) override;
+
+        /**
+         * @brief Returns the quality components HeadPoseYaw, HeadPosePitch and HeadPoseRoll.
+         * @return List of enum values of the quality components.
+         */
+        std::vector<OFIQ::QualityMeasure> GetQualityComponents() const override;
     };
 }
\ No newline at end of file
@@ -55,5 +55,14 @@ namespace OFIQ_LIB::modules::measures
          * @param session Session object containing the original facial image and pre-processing results.
          */
         void Execute(OFIQ_LIB::Session & session) override;
+
+        /**
+         * @brief Maps a native quality score to its quality component value.
+         * @details The sigmoid-based quality mapping is applied to \f$|x-0.45|\f$.
+         * @param measure Enum value of the quality component.
+         * @param rawValue Native quality score.
+         * @return Quality component value.
+         */
+        double ConvertRawScore(OFIQ::QualityMeasure measure, double rawValue) override;
     };
 }
\ No newline at end of file
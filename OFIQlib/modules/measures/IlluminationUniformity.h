@@ -59,5 +59,14 @@ namespace OFIQ_LIB::modules::measures
          * OFIQImpl::performPreprocessing()\endlink method.
          */
         void Execute(OFIQ_LIB::Session & session) override;
+
+        /**
+         * @brief Maps a native quality score to its quality component value.
+         * @details The quality component value is \f$\mathrm{round}(100\cdot x^{0.3})\f$.
+         * @param measure Enum value of the quality component.
+         * @param rawValue Native quality score.
+         * @return Quality component value.
+         */
+        double ConvertRawScore(OFIQ::QualityMeasure measure, double rawValue) override;
     };
 }
\ No newline at end of file
@@ -56,5 +56,20 @@ namespace OFIQ_LIB::modules::measures
          * OFIQImpl::performPreprocessing()\endlink method.
          */
         void Execute(OFIQ_LIB::Session & session) override;
+
+        /**
+         * @brief Maps a native quality score to its quality component value.
+         * @details The mean is mapped by a product of two sigmoid functions, the variance by a sine function.
+         * @param measure Enum value of the quality component.
+         * @param rawValue Native quality score.
+         * @return Quality component value.
+         */
+        double ConvertRawScore(OFIQ::QualityMeasure measure, double rawValue) override;
+
+        /**
+         * @brief Returns the quality components LuminanceMean and LuminanceVariance.
+         * @return List of enum values of the quality components.
+         */
+        std::vector<OFIQ::QualityMeasure> GetQualityComponents() const override;
     };
 }
\ No newline at end of file
@@ -195,6 +195,35 @@ namespace OFIQ_LIB::modules::measures
          */
         void SetQualityMeasure(OFIQ_LIB::Session& session, OFIQ::QualityMeasure measure, double rawValue, OFIQ::QualityMeasureReturnCode code);
 
+        /**
+         * @brief Maps a native quality score to its quality component value.
+         * @details Unless overwritten, the sigmoid-based quality mapping configured for <code>measure</code>
+         * is applied, see \link OFIQ_LIB::modules::measures::Measure::ExecuteScalarConversion(OFIQ::QualityMeasure,double) 
+         * ExecuteScalarConversion()\endlink. Measures using a different mapping overwrite this method, such that
+         * the quality component values can be recomputed from stored native quality scores.
+         * @param measure Enum value of the quality component, one of 
+         * \link OFIQ_LIB::modules::measures::Measure::GetQualityComponents() GetQualityComponents()\endlink.
+         * @param rawValue Native quality score.
+         * @return Quality component value.
+         */
+        virtual double ConvertRawScore(OFIQ::QualityMeasure measure, double rawValue);
+
+        /**
+         * @brief Returns the quality components computed by the measure.
+         * @details Unless overwritten, the list contains only the value returned by
+         * \link OFIQ_LIB::modules::measures::Measure::GetQualityMeasure() GetQualityMeasure()\endlink.
+         * @return List of enum values of the quality components.
+         */
+        virtual std::vector<OFIQ::QualityMeasure> GetQualityComponents() const;
+
+        /**
+         * @brief Recomputes the quality component values of this measure from the native quality scores.
+         * @details Components of the measure missing in <code>assessment</code> or with the return code
+         * FailureToAssess are left unchanged.
+         * @param assessment Assessment holding the native quality scores.
+         */
+        void Rescore(OFIQ::FaceImageQualityAssessment& assessment);
+
     protected:
         /**
          * @brief Sigmoid function.
@@ -61,27 +61,19 @@ namespace OFIQ_LIB::modules::measures
 
     private:
         /**
-         * @brief Creates a mask image from the convex full of the specified landmarks.
-         * @param landmarks Facial landmarks.
-         * @param cvImage The mask image returned has the same dimension as <code>cvImage</code>.
-         * @return Mask image
+         * @brief Adds the BGR values of the pixels of a region of the aligned face to sums. Only pixels
+         * inside the landmarked region of the session and inside the convex hull of the landmarks are
+         * summed, i.e. all other pixels of the region count as black.
+         * @param session Session object.
+         * @param faceMask Mask of the convex hull of the aligned face landmarks, of the size of the aligned face.
+         * @param region Region of the aligned face; an error occurs if it exceeds the aligned face.
+         * @param sums Sums of the blue, green and red values.
          */
-        cv::Mat CreateMaskedImage(const OFIQ::FaceLandmarks& landmarks, const cv::Mat& cvImage) const;
-
-        /**
-         * @brief Extracts two rectangular regions from an image and returns its concatenation.
-         * @param maskedImage The input image from which the two regions are extracted.
-         * @param leftRegionOfInterest First region
-         * @param rightRegionOfInterest Second region
-         * @return Concatenation if the requested regions; the first columns correspond to
-         * <code>rightRegionOfInterest</code> and the last columns correspond to 
-         * <code>leftRegionOfInterest</code>.
-         * @attention An error occurs if the height of the two requested regions differ.
-         */
-        cv::Mat ReduceImageToRegionOfInterest(
-            const cv::Mat& maskedImage, 
-            const cv::Rect& leftRegionOfInterest, 
-            const cv::Rect& rightRegionOfInterest) const;
+        void AddMaskedRegionSums(
+            const Session& session,
+            const cv::Mat& faceMask,
+            const cv::Rect& region,
+            cv::Scalar& sums) const;
         
         /**
          * @brief Combines two CIELAB values a* and b* to computed
@@ -79,6 +79,16 @@ namespace OFIQ_LIB::modules::measures
          */
         void Execute(OFIQ_LIB::Session & session) override;
 
+        /**
+         * @brief Maps a native quality score to its quality component value.
+         * @details Ratios below (or equal to) the lower threshold are mapped to 100, ratios above
+         * (or equal to) the upper threshold to 0; in between, the sigmoid function is interpolated.
+         * @param measure Enum value of the quality component.
+         * @param rawValue Native quality score.
+         * @return Quality component value.
+         */
+        double ConvertRawScore(OFIQ::QualityMeasure measure, double rawValue) override;
+
     private:
         /**
          * @brief Lower threshold.
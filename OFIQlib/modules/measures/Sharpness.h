@@ -27,6 +27,7 @@
 #pragma once
 
 #include "Measure.h"
+#include "TreeEnsemble.h"
 
 /**
  * @brief Provides measures implemented in OFIQ.
@@ -56,6 +57,19 @@ namespace OFIQ_LIB::modules::measures
          */
         void Execute(OFIQ_LIB::Session & session) override;
 
+        /**
+         * @brief Computation of the input features using different edge detectors.
+         * @details The 26 features are the masked means and standard deviations of the absolute
+         * responses of cv::Laplacian() on the blurred image, of the differences to cv::blur() and
+         * of cv::Sobel(), all computed in a single pass over the image.
+         * 
+         * @param image Input image, 8 bit gray scale or BGR.
+         * @param mask  Input region of the face, 8 bit of the size of the image.
+         * @param applyBlur Wheter or not rub a GaussianBlur before the edge detection.
+         * @return cv::Mat Container storing the results of the different edge detectors, 1 x 26 of type CV_64F.
+         */
+        static cv::Mat GetClassifierFocusFeatures(const cv::Mat& image, const cv::Mat& mask, bool applyBlur);
+
     private:
 
         /**
@@ -69,6 +83,12 @@ namespace OFIQ_LIB::modules::measures
          */
         std::shared_ptr<cv::ml::RTrees> m_rtree;
 
+        /**
+         * @brief Flattened trees of the random forest, used for the prediction if they
+         * reproduce the predictions of m_rtree. Otherwise nullptr.
+         */
+        std::unique_ptr<TreeEnsemble> m_treeEnsemble;
+
         /**
          * @brief The sharpness measure can be computed on the aligned or the original image. useAligned set to true will 
          * run the computation on the aligned image. The member is read from the configuration file.
@@ -93,26 +113,16 @@ namespace OFIQ_LIB::modules::measures
          * @brief Get the cropped face region.
          * 
          * @param session Data container.
-         * @param faceCrop Computed crop of the face.
+         * @param faceCrop Computed crop of the face; gray scale if the input image is cropped.
          * @param maskCrop Mask used for the cropping. Will be computed in the method.
          * @param useAligned Switch for using the aligned image.
          * @param faceRegionAlpha Enlarge the face region by passing this parameter.
          */
         void GetCroppedImages(
-            const Session& session,
+            Session& session,
             cv::Mat& faceCrop,
             cv::Mat& maskCrop,
             bool useAligned,
             float faceRegionAlpha) const;
-        
-        /**
-         * @brief Computation of the input features using different edge detectors.
-         * 
-         * @param image Input image.
-         * @param mask  Input region of the face.
-         * @param applyBlur Wheter or not rub a GaussianBlur before the edge detection.
-         * @return cv::Mat Container storing the results of the different edge detectors.
-         */
-        cv::Mat GetClassifierFocusFeatures(const cv::Mat& image, const cv::Mat& mask, bool applyBlur) const;
     };
 }
\ No newline at end of file
@@ -57,6 +57,8 @@ namespace OFIQ_LIB::modules::measures
          * @details The algorithm uses a iResNet50 model M from https://github.com/IrvingMeng/MagFace 
          * trained on MS1MV2 with MagFace loss without DDP parallelisation. 
          * The algorithm takes as input the image I output by the alignment algorithm. 
+         * If the embedding export is enabled, the first output of the model with more than one element,
+         * e.g. the feature vector, is stored in OFIQ::FaceImageQualityAssessment::embedding.
          * 
          * @param session Session object computed by the \link OFIQ_LIB::OFIQImpl::performPreprocessing() 
          * OFIQImpl::performPreprocessing()\endlink method.
@@ -69,5 +71,11 @@ namespace OFIQ_LIB::modules::measures
          * 
          */
         ONNXRuntimeSegmentation m_onnxRuntimeEnv;
+
+        /**
+         * @brief If true, the embedding output of the model is exported along the quality score.
+         * Set by UnifiedQualityScore.export_embedding in the configuration file.
+         */
+        bool m_exportEmbedding = false;
     };
 }
\ No newline at end of file
@@ -33,7 +33,10 @@ namespace OFIQ_LIB::modules::measures
 {
     static const auto qualityMeasure = OFIQ::QualityMeasure::BackgroundUniformity;
 
-    static cv::Mat GetGradients(const cv::Mat& L);
+    static cv::Mat GetBackgroundMask(
+        const cv::Mat& T, int imageWidth, int imageHeight, const cv::Rect& crop, const cv::Mat& S0);
+
+    static double GetMeanGradient(const cv::Mat& L, const cv::Mat& B);
 
     BackgroundUniformity::BackgroundUniformity(
         const Configuration& configuration)
@@ -52,52 +55,36 @@ namespace OFIQ_LIB::modules::measures
     void BackgroundUniformity::Execute(OFIQ_LIB::Session & session)
     {
         // Input: Aligned image I
-        auto I = session.getAlignedFace();
+        auto I = session.getAlignedFaceNative();
 
         // Input: Transformation T
         auto T = session.getAlignedFaceTransformationMatrix();
 
-        // Input: face parsing segmentation map S
-        auto S = session.getFaceParsingImage();
+        // Input: face parsing segmentation map S, represented by the mask of the pixels with Sij=0
+        auto S0 = session.getFaceParsingClassHistogram().GetMask(0);
 
         // Input: dimensions (w,h) of the original image
         auto h = session.image().height;
         auto w = session.image().width;
 
-        // Step 1. Create a completely black (0) grey scale image A of dimensions (w,h)
-        auto A = cv::Mat::zeros(h,w,CV_8U);
-
-        // Step 2. Apply the transformation T to A and/or pad the image
-        // to dimension 616x616 to obtain a padding mask P. For padding use white colour (255)
-        cv::Mat P = cv::Mat::zeros(I.rows,I.cols,CV_8U);
-        cv::warpAffine(A, P, T, cv::Size(I.cols, I.rows), cv::INTER_NEAREST, 0, 255);
+        // Steps 1 and 2. The padding mask P marks the pixels set to white when warping a black image
+        // of dimensions (w,h) by T. Instead of warping an image of the original resolution, P is
+        // derived in Step 6 from the inverse transformation for the pixels kept by Steps 3 and 4.
+        const cv::Rect crop(m_cropLeft, m_cropTop,
+            I.cols - m_cropLeft - m_cropRight, I.rows - m_cropTop - m_cropBottom);
 
         // Step 3. Crop both I and P by 62 pixels from both sides and by 108 pixels from the bottom.
-        I = cv::Mat(I, cv::Range(m_cropTop,I.rows-m_cropBottom),cv::Range(m_cropLeft,I.cols-m_cropRight));
-        P = cv::Mat(P, cv::Range(m_cropTop,P.rows-m_cropBottom),cv::Range(m_cropLeft,P.cols-m_cropRight));
+        I = I(crop);
 
         // Step 4. Resize both I and P to size (354,295)
         cv::resize(I, I, cv::Size(m_targetWidth, m_targetHeight), 0.0, 0.0, cv::INTER_LINEAR);
-        cv::resize(P, P, cv::Size(m_targetWidth, m_targetHeight), 0.0, 0.0, cv::INTER_NEAREST);
 
         // Step 5. Crop the segmentation map S by 23 pixels from both sides and 108 pixels from the bottom
-        auto marginX = (S.cols-I.cols)/2; // marginX shall be 23 as per ISO/IEC 29794-5
-        S = cv::Mat(S, cv::Range(0, I.rows), cv::Range(marginX, S.cols-marginX));
+        auto marginX = (S0.cols-I.cols)/2; // marginX shall be 23 as per ISO/IEC 29794-5
+        S0 = cv::Mat(S0, cv::Range(0, I.rows), cv::Range(marginX, S0.cols-marginX));
 
         // Step 6. Compute the background mask B with Bij=1, if Sij=0 and Pij=0, and Bij otherwise
-        cv::Mat B = cv::Mat::zeros(P.rows,P.cols, CV_8U);
-        for (int i = 0; i < P.rows; i++)
-        {
-            for (int j = 0; j < P.cols; j++)
-            {
-                if (P.at<uchar>(i,j) == 0 && S.at<uchar>(i,j) == 0)
-                {
-                    B.data[B.cols*i+j] = 1;
-                }
-            }
-        }
-
-
+        cv::Mat B = GetBackgroundMask(T, w, h, crop, S0);
 
         // Step 7. Apply to B the OpenCV function erode with kernel size 4.
         cv::Mat kernel = cv::Mat::ones(m_erosionKernelSize, m_erosionKernelSize, CV_8U);
@@ -114,50 +101,122 @@ namespace OFIQ_LIB::modules::measures
 
         // Step 8. Compute the luminance image L for image I as specified in ISO/IEC CD2 29794-5:2023 [1].
         // Each pixel value is encoded as an integer value between 0 (black) and 255 (white)
-        auto L = GetLuminanceImageFromBGR(I);
+        auto L = GetLuminanceImage(I);
 
-        // Step 9. Algorithm 2 (Luminance Gradients)
-        auto G = GetGradients(L);
-        double m = 0.0;
-        int n = 0;
-        for (int i = 0; i < G.rows; i++)
+        // Step 9. Algorithm 2 (Luminance Gradients), averaged over the background
+        double m = GetMeanGradient(L, B);
+
+        SetQualityMeasure(session, qualityMeasure, m, OFIQ::QualityMeasureReturnCode::Success);
+    }
+
+    /**
+     * @brief Computes the background mask of the resized aligned image: 1 where the segmentation
+     * map S is 0, i.e. the mask S0 of class 0 is non-zero, and the pixel is no padding of the
+     * alignment, 0 otherwise.
+     * @details A pixel is padding if the aligned pixel it is resized from maps outside of the
+     * original image. The mapping replicates cv::resize() with INTER_NEAREST and the fixed-point
+     * inverse mapping of cv::warpAffine() with INTER_NEAREST, such that the mask equals the one
+     * obtained by warping a black image of the original size with a white border.
+     */
+    static cv::Mat GetBackgroundMask(
+        const cv::Mat& T, int imageWidth, int imageHeight, const cv::Rect& crop, const cv::Mat& S0)
+    {
+        // inverse transformation as computed by cv::warpAffine()
+        cv::Mat_<double> transformation;
+        T.convertTo(transformation, CV_64F);
+        double M[6];
+        std::copy(transformation.begin(), transformation.end(), M);
+        double D = M[0] * M[4] - M[1] * M[3];
+        D = D != 0 ? 1. / D : 0;
+        double A11 = M[4] * D;
+        double A22 = M[0] * D;
+        M[0] = A11; M[1] *= -D;
+        M[3] *= -D; M[4] = A22;
+        double b1 = -M[0] * M[2] - M[1] * M[5];
+        double b2 = -M[3] * M[2] - M[4] * M[5];
+        M[2] = b1; M[5] = b2;
+
+        constexpr int abBits = 10;
+        constexpr int abScale = 1 << abBits;
+        constexpr int roundDelta = abScale / 2;
+
+        // source pixels of the nearest neighbour resize as computed by cv::resize()
+        const double ifx = 1. / (static_cast<double>(S0.cols) / crop.width);
+        const double ify = 1. / (static_cast<double>(S0.rows) / crop.height);
+        std::vector<int> adelta(S0.cols);
+        std::vector<int> bdelta(S0.cols);
+        for (int j = 0; j < S0.cols; j++)
         {
-            for (int j = 0; j < G.cols; j++)
+            int x = std::min(cvFloor(j * ifx), crop.width - 1) + crop.x;
+            adelta[j] = cv::saturate_cast<int>(M[0] * x * abScale);
+            bdelta[j] = cv::saturate_cast<int>(M[3] * x * abScale);
+        }
+
+        cv::Mat B(S0.rows, S0.cols, CV_8U);
+        for (int i = 0; i < S0.rows; i++)
+        {
+            int y = std::min(cvFloor(i * ify), crop.height - 1) + crop.y;
+            int X0 = cv::saturate_cast<int>((M[1] * y + M[2]) * abScale) + roundDelta;
+            int Y0 = cv::saturate_cast<int>((M[4] * y + M[5]) * abScale) + roundDelta;
+            const uchar* segmentation = S0.ptr<uchar>(i);
+            uchar* background = B.ptr<uchar>(i);
+            for (int j = 0; j < S0.cols; j++)
             {
-                if (B.at<uchar>(i, j))
-                {
-                    m += G.at<double>(i, j);
-                    ++n;
-                }
+                int X = cv::saturate_cast<short>((X0 + adelta[j]) >> abBits);
+                int Y = cv::saturate_cast<short>((Y0 + bdelta[j]) >> abBits);
+                bool isPadding = static_cast<unsigned>(X) >= static_cast<unsigned>(imageWidth) ||
+                    static_cast<unsigned>(Y) >= static_cast<unsigned>(imageHeight);
+                background[j] = !isPadding && segmentation[j] != 0 ? 1 : 0;
             }
         }
 
-        if (n > 0)
-            m /= (double)n;
-
-        SetQualityMeasure(session, qualityMeasure, m, OFIQ::QualityMeasureReturnCode::Success);
+        return B;
     }
 
-    static cv::Mat GetGradients(const cv::Mat& L)
+    /**
+     * @brief Computes the mean of the gradient magnitudes of the luminance image L over the mask B.
+     * @details The gradients are those of cv::Sobel() with ksize -1 (Scharr) and BORDER_REFLECT_101.
+     * For an 8 bit image, they are integers and computed exactly row by row; the magnitudes are summed
+     * in the order of the pixels.
+     */
+    static double GetMeanGradient(const cv::Mat& L, const cv::Mat& B)
     {
-        cv::Mat sX;
-        cv::Mat sY;
-
-        cv::Sobel(L, sX, CV_32F,1, 0, -1);
-        cv::Sobel(L, sY, CV_32F,0, 1, -1);
+        const int cols = L.cols;
+        std::vector<int> left(cols);
+        std::vector<int> right(cols);
+        for (int j = 0; j < cols; j++)
+        {
+            left[j] = cv::borderInterpolate(j - 1, cols, cv::BORDER_REFLECT_101);
+            right[j] = cv::borderInterpolate(j + 1, cols, cv::BORDER_REFLECT_101);
+        }
 
-        cv::Mat G = cv::Mat::zeros(L.rows, L.cols, CV_64F);
+        std::vector<int> squaredMagnitudes(cols);
+        double sum = 0.0;
+        int n = 0;
         for (int i = 0; i < L.rows; i++)
         {
-            for (int j = 0; j < L.cols; j++)
+            const uchar* mask = B.ptr<uchar>(i);
+            const uchar* above = L.ptr<uchar>(cv::borderInterpolate(i - 1, L.rows, cv::BORDER_REFLECT_101));
+            const uchar* row = L.ptr<uchar>(i);
+            const uchar* below = L.ptr<uchar>(cv::borderInterpolate(i + 1, L.rows, cv::BORDER_REFLECT_101));
+            for (int j = 0; j < cols; j++)
+            {
+                const int l = left[j];
+                const int r = right[j];
+                int gx = 3 * (above[r] - above[l]) + 10 * (row[r] - row[l]) + 3 * (below[r] - below[l]);
+                int gy = 3 * (below[l] - above[l]) + 10 * (below[j] - above[j]) + 3 * (below[r] - above[r]);
+                squaredMagnitudes[j] = gx * gx + gy * gy;
+            }
+            for (int j = 0; j < cols; j++)
             {
-                auto& v = G.at<double>(i, j);
-                auto sx = (double)sX.at<float>(i, j);
-                auto sy = (double)sY.at<float>(i, j);
-                v = sqrt(sx * sx + sy * sy);
+                if (mask[j])
+                {
+                    sum += std::sqrt(static_cast<double>(squaredMagnitudes[j]));
+                    ++n;
+                }
             }
         }
 
-        return G;
+        return n > 0 ? sum / n : 0.0;
     }
-}
\ No newline at end of file
+}
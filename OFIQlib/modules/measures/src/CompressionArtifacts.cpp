@@ -72,7 +72,7 @@ namespace OFIQ_LIB::modules::measures
             std::vector<uint8_t> modelData(
                 (std::istreambuf_iterator<char>(instream)),
                 std::istreambuf_iterator<char>());
-            m_onnxRuntimeEnv.initialize(modelData, m_dim, m_dim);
+            m_onnxRuntimeEnv.initialize(modelData, m_dim, m_dim, getOnnxRuntimeThreading(configuration));
         }
         catch (std::exception&)
         {
@@ -99,4 +99,9 @@ namespace OFIQ_LIB::modules::measures
         double rawScoreDown = eyeMidPoint.y / t;
         SetQualityMeasure(session, qualityDown, rawScoreDown, OFIQ::QualityMeasureReturnCode::Success);
     }
-}
\ No newline at end of file
+
+    std::vector<OFIQ::QualityMeasure> CropOfTheFaceImage::GetQualityComponents() const
+    {
+        return { qualityLeft, qualityRight, qualityUp, qualityDown };
+    }
+}
@@ -45,14 +45,19 @@ namespace OFIQ_LIB::modules::measures
 
     void DynamicRange::Execute(OFIQ_LIB::Session & session)
     {
-        cv::Mat alignedImage = session.getAlignedFace();
+        cv::Mat alignedImage = session.getAlignedFaceNative();
         cv::Mat cvMask = session.getAlignedFaceLandmarkedRegion();
         cv::Mat faceSegmentation;
         cv::bitwise_and(alignedImage, alignedImage, faceSegmentation, cvMask);
-        auto luminanceImage = GetLuminanceImageFromBGR(faceSegmentation);
+        auto luminanceImage = GetLuminanceImage(faceSegmentation);
 
         auto rawScore = ComputeEntropy(luminanceImage, cvMask);
-        auto scalarScore = round(12.5 * rawScore);
+        SetQualityMeasure(session, qualityMeasure, rawScore, OFIQ::QualityMeasureReturnCode::Success);
+    }
+
+    double DynamicRange::ConvertRawScore(OFIQ::QualityMeasure, double rawValue)
+    {
+        auto scalarScore = round(12.5 * rawValue);
         if (scalarScore < 0.0)
         {
             scalarScore = 0.0;
@@ -61,7 +66,7 @@ namespace OFIQ_LIB::modules::measures
         {
             scalarScore = 100.0;
         }
-        session.assessment().qAssessments[qualityMeasure] = { rawScore, scalarScore, OFIQ::QualityMeasureReturnCode::Success };
+        return scalarScore;
     }
 
     static double ComputeEntropy(const cv::Mat& luminanceImage, const cv::Mat& maskImage)
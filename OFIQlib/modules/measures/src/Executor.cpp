@@ -55,4 +55,10 @@ namespace OFIQ_LIB::modules::measures
         }
         log("\nfinished\n");
     }
+
+    void Executor::RescoreAll(OFIQ::FaceImageQualityAssessment& assessment) const
+    {
+        for (const auto& measure : m_measures)
+            measure->Rescore(assessment);
+    }
 }
\ No newline at end of file
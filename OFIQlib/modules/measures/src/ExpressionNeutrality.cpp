@@ -28,6 +28,7 @@
 #include "FaceMeasures.h"
 #include "OFIQError.h"
 #include <fstream>
+#include <future>
 #include <opencv2/ml.hpp>
 #include <cmath>
 
@@ -37,14 +38,35 @@ namespace OFIQ_LIB::modules::measures
     static const std::string modelConfigItemCNN1 = "params.measures.ExpressionNeutrality.cnn1_model_path";
     static const std::string modelConfigItemCNN2 = "params.measures.ExpressionNeutrality.cnn2_model_path";
     static const std::string modelConfigItemAdaboost = "params.measures.ExpressionNeutrality.adaboost_model_path";
+    static const std::string concurrentConfigItem = "params.measures.ExpressionNeutrality.concurrent_inference";
 
     static const uint16_t dimCNN1 = 224;
     static const uint16_t dimCNN2 = 260;
 
+    /**
+     * @brief Resizes the normalized face crop to the input size of a CNN and returns the planar
+     * network input, i.e. the layout of cv::dnn::blobFromImage() without an intermediate blob.
+     */
+    static std::vector<float> GetNetInput(const cv::Mat& transformed, int dim)
+    {
+        cv::Mat resized;
+        cv::resize(transformed, resized, cv::Size(dim, dim), 0, 0, cv::INTER_LINEAR);
+
+        std::vector<float> netInput(static_cast<size_t>(resized.channels()) * dim * dim);
+        std::vector<cv::Mat> planes;
+        for (int c = 0; c < resized.channels(); c++)
+            planes.emplace_back(dim, dim, CV_32F, netInput.data() + static_cast<size_t>(c) * dim * dim);
+        cv::split(resized, planes);
+        return netInput;
+    }
+
     ExpressionNeutrality::ExpressionNeutrality(
         const Configuration& configuration)
         : Measure{ configuration, qualityMeasure }
     {
+        if (!configuration.GetBool(concurrentConfigItem, m_concurrentInference))
+            m_concurrentInference = true;
+
         auto modelPathCNN1 = configuration.getDataDir() + "/" + configuration.GetString(modelConfigItemCNN1);
         auto modelPathCNN2 = configuration.getDataDir() + "/" + configuration.GetString(modelConfigItemCNN2);
         auto modelPathAdaboost = configuration.getDataDir() + "/" + configuration.GetString(modelConfigItemAdaboost);
@@ -56,7 +78,7 @@ namespace OFIQ_LIB::modules::measures
             std::vector<uint8_t> modelData(
                 (std::istreambuf_iterator<char>(instream)),
                 std::istreambuf_iterator<char>());
-            m_onnxRuntimeEnvCNN1.initialize(modelData, dimCNN1, dimCNN1);
+            m_onnxRuntimeEnvCNN1.initialize(modelData, dimCNN1, dimCNN1, getOnnxRuntimeThreading(configuration));
         }
         catch (std::exception&)
         {
@@ -72,7 +94,7 @@ namespace OFIQ_LIB::modules::measures
             std::vector<uint8_t> modelData(
                 (std::istreambuf_iterator<char>(instream)),
                 std::istreambuf_iterator<char>());
-            m_onnxRuntimeEnvCNN2.initialize(modelData, dimCNN2, dimCNN2);
+            m_onnxRuntimeEnvCNN2.initialize(modelData, dimCNN2, dimCNN2, getOnnxRuntimeThreading(configuration));
         }
         catch (const std::exception&)
         {
@@ -92,6 +114,13 @@ namespace OFIQ_LIB::modules::measures
                 std::string("Loading adaboost model for expression neutrality failed"));
         }
 
+        if (TreeEnsemble::IsSupported(*m_classifier))
+        {
+            m_treeEnsemble = std::make_unique<TreeEnsemble>(*m_classifier);
+            if (!m_treeEnsemble->MatchesModel(*m_classifier, cv::ml::DTrees::PREDICT_SUM))
+                m_treeEnsemble.reset();
+        }
+
         SigmoidParameters defaultValues;
         defaultValues.h = 100.0;
         defaultValues.x0 = -5000.0;
@@ -115,30 +144,36 @@ namespace OFIQ_LIB::modules::measures
         transformed /= 255.0;
         transformed -= mean;
         transformed /= std;
-        cv::Mat resized1;
-        cv::resize(transformed, resized1, cv::Size(dimCNN1, dimCNN1), 0, 0, cv::INTER_LINEAR);
-        cv::Mat blob = cv::dnn::blobFromImage({ resized1 });
 
-        std::vector<float> net_input;
-        net_input.assign(blob.begin<float>(), blob.end<float>());
-        auto outCNN1 = m_onnxRuntimeEnvCNN1.run(net_input);
+        // both CNNs share the normalized crop and are independent of each other
+        auto runCNN2 = [this, &transformed]()
+        {
+            auto netInput = GetNetInput(transformed, dimCNN2);
+            return m_onnxRuntimeEnvCNN2.run(netInput);
+        };
+        std::future<std::vector<Ort::Value>> futureCNN2;
+        if (m_concurrentInference)
+            futureCNN2 = std::async(std::launch::async, runCNN2);
+
+        auto netInput = GetNetInput(transformed, dimCNN1);
+        auto outCNN1 = m_onnxRuntimeEnvCNN1.run(netInput);
         auto features1 = cv::Mat(1, 1280, CV_32F, outCNN1[0].GetTensorMutableData<float>());
 
-        cv::Mat resized2;
-        cv::resize(transformed, resized2, cv::Size(dimCNN2, dimCNN2), 0, 0, cv::INTER_LINEAR);
-        blob = cv::dnn::blobFromImage({ resized2 });
-
-        net_input.clear();
-        net_input.assign(blob.begin<float>(), blob.end<float>());
-        auto outCNN2 = m_onnxRuntimeEnvCNN2.run(net_input);
+        auto outCNN2 = m_concurrentInference ? futureCNN2.get() : runCNN2();
         auto features2 = cv::Mat(1, 1408, CV_32F, outCNN2[0].GetTensorMutableData<float>());
 
         cv::Mat features;
         cv::hconcat(features1, features2, features);
         
-        cv::Mat predResults;
-        this->m_classifier->predict(features, predResults, cv::ml::DTrees::PREDICT_SUM);
-        double rawScore = predResults.at<float>(0, 0);
+        double rawScore;
+        if (m_treeEnsemble)
+            rawScore = m_treeEnsemble->PredictSum(features.ptr<float>(0));
+        else
+        {
+            cv::Mat predResults;
+            this->m_classifier->predict(features, predResults, cv::ml::DTrees::PREDICT_SUM);
+            rawScore = predResults.at<float>(0, 0);
+        }
         SetQualityMeasure(session, qualityMeasure, rawScore, OFIQ::QualityMeasureReturnCode::Success);
     }
 }
\ No newline at end of file
@@ -29,6 +29,7 @@
 #include "FaceMeasures.h"
 #include "FaceParts.h"
 #include <opencv2/imgproc.hpp>
+#include <climits>
 
 using PartExtractor = OFIQ_LIB::modules::landmarks::PartExtractor;
 using FaceParts = OFIQ_LIB::modules::landmarks::FaceParts;
@@ -46,7 +47,7 @@ namespace OFIQ_LIB::modules::measures
     void EyesVisible::Execute(OFIQ_LIB::Session & session)
     {
         auto alignedFaceLandmarks = session.getAlignedFaceLandmarks();
-        cv::Mat faceOcclusionMask = session.getFaceOcclusionSegmentationImage();
+        const BitMask& faceOcclusionMask = session.getFaceOcclusionSegmentationBitMask();
         OFIQ::Landmarks leftEye = PartExtractor::getFacePart(alignedFaceLandmarks, FaceParts::LEFT_EYE);
         OFIQ::Landmarks rightEye = PartExtractor::getFacePart(alignedFaceLandmarks, FaceParts::RIGHT_EYE);
 
@@ -91,13 +92,30 @@ namespace OFIQ_LIB::modules::measures
         };
 
         std::vector<std::vector<cv::Point2i>> contours = { leftRect, rightRect };
-        cv::Mat EVZMask = cv::Mat::zeros(faceOcclusionMask.size(), CV_8U);
-        cv::drawContours(EVZMask, contours, -1, 1, -1);
-        
+        // the EVZ is only rasterized within its bounding box, with a margin of one pixel
+        std::vector<cv::Point2i> corners = leftRect;
+        corners.insert(corners.end(), rightRect.begin(), rightRect.end());
+        cv::Rect EVZRegion = cv::boundingRect(corners);
+        EVZRegion -= cv::Point(1, 1);
+        EVZRegion += cv::Size(2, 2);
+        EVZRegion &= faceOcclusionMask.GetRegion();
+        BitMask EVZMask;
+        if (!EVZRegion.empty())
+        {
+            cv::Mat EVZRegionMask = cv::Mat::zeros(EVZRegion.size(), CV_8U);
+            cv::drawContours(EVZRegionMask, contours, -1, 1, -1, cv::LINE_8, cv::noArray(), INT_MAX, -EVZRegion.tl());
+            EVZMask = BitMask(EVZRegionMask, EVZRegion.tl());
+        }
+
         // Compute proportion of occlusion of EVZ
-        cv::Mat occlusionMask = EVZMask.mul(1- faceOcclusionMask);
-        double rawScore = cv::sum(occlusionMask).val[0] / cv::sum(EVZMask).val[0];
-        double scalarScore = round(100 * (1 - rawScore));
+        double rawScore = static_cast<double>(EVZMask.CountNonZeroWithout(faceOcclusionMask)) / 
+            static_cast<double>(EVZMask.CountNonZero());
+        SetQualityMeasure(session, qualityMeasure, rawScore, OFIQ::QualityMeasureReturnCode::Success);
+    }
+
+    double EyesVisible::ConvertRawScore(OFIQ::QualityMeasure, double rawValue)
+    {
+        double scalarScore = round(100 * (1 - rawValue));
         if (scalarScore < 0)
         {
             scalarScore = 0;
@@ -106,6 +124,6 @@ namespace OFIQ_LIB::modules::measures
         {
             scalarScore = 100;
         }
-        session.assessment().qAssessments[qualityMeasure] = { rawScore, scalarScore, OFIQ::QualityMeasureReturnCode::Success };
+        return scalarScore;
     }
 }
\ No newline at end of file
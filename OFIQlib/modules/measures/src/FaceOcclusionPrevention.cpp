@@ -42,8 +42,8 @@ namespace OFIQ_LIB::modules::measures
 
     void FaceOcclusionPrevention::Execute(OFIQ_LIB::Session & session)
     {
-        cv::Mat mask = session.getAlignedFaceLandmarkedRegion();
-        int G = cv::countNonZero(mask);
+        const BitMask& mask = session.getAlignedFaceLandmarkedRegionBitMask();
+        int64_t G = mask.CountNonZero();
         if (G == 0)
         {
             double rawScore = 0.0;
@@ -51,10 +51,15 @@ namespace OFIQ_LIB::modules::measures
             return;
         }
         
-        cv::Mat faceOcclusionMask = session.getFaceOcclusionSegmentationImage();
-        cv::Mat occlusionMask = mask.mul(1 - faceOcclusionMask);
-        double rawScore = cv::countNonZero(occlusionMask) / (double)G;
-        double scalarScore = round(100 * (1 - rawScore));
+        // pixels of the landmarked region not covered by the face occlusion segmentation
+        const BitMask& faceOcclusionMask = session.getFaceOcclusionSegmentationBitMask();
+        double rawScore = mask.CountNonZeroWithout(faceOcclusionMask) / (double)G;
+        SetQualityMeasure(session, qualityMeasure, rawScore, OFIQ::QualityMeasureReturnCode::Success);
+    }
+
+    double FaceOcclusionPrevention::ConvertRawScore(OFIQ::QualityMeasure, double rawValue)
+    {
+        double scalarScore = round(100 * (1 - rawValue));
         if (scalarScore < 0)
         {
             scalarScore = 0;
@@ -63,6 +68,6 @@ namespace OFIQ_LIB::modules::measures
         {
             scalarScore = 100;
         }
-        session.assessment().qAssessments[qualityMeasure] = { rawScore, scalarScore, OFIQ::QualityMeasureReturnCode::Success };
+        return scalarScore;
     }
 }
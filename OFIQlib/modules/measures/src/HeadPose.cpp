@@ -38,24 +38,28 @@ namespace OFIQ_LIB::modules::measures
     {
     }
 
-    OFIQ::QualityMeasureResult CalculateQuality(const double& rawValue)
+    double HeadPose::ConvertRawScore(OFIQ::QualityMeasure, double rawValue)
     {
         auto myCos = cos(rawValue * M_PI / 180);
 		myCos = std::max(0.0,myCos);
 		myCos *= myCos;
-        auto scalarScore = round(100 * myCos);
-        return {rawValue, scalarScore, OFIQ::QualityMeasureReturnCode::Success};
+        return round(100 * myCos);
+    }
+
+    std::vector<OFIQ::QualityMeasure> HeadPose::GetQualityComponents() const
+    {
+        return {
+            OFIQ::QualityMeasure::HeadPoseYaw,
+            OFIQ::QualityMeasure::HeadPosePitch,
+            OFIQ::QualityMeasure::HeadPoseRoll };
     }
 
     void HeadPose::Execute(OFIQ_LIB::Session & session)
     {
         auto headPose = session.getPose();
 
-        session.assessment().qAssessments[OFIQ::QualityMeasure::HeadPoseRoll] =
-            CalculateQuality(headPose[2]);
-        session.assessment().qAssessments[OFIQ::QualityMeasure::HeadPosePitch] =
-            CalculateQuality(headPose[0]);
-        session.assessment().qAssessments[OFIQ::QualityMeasure::HeadPoseYaw] =
-            CalculateQuality(headPose[1]);
+        SetQualityMeasure(session, OFIQ::QualityMeasure::HeadPoseRoll, headPose[2], OFIQ::QualityMeasureReturnCode::Success);
+        SetQualityMeasure(session, OFIQ::QualityMeasure::HeadPosePitch, headPose[0], OFIQ::QualityMeasureReturnCode::Success);
+        SetQualityMeasure(session, OFIQ::QualityMeasure::HeadPoseYaw, headPose[1], OFIQ::QualityMeasureReturnCode::Success);
     }
 }
\ No newline at end of file
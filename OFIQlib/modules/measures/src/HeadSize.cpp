@@ -53,9 +53,13 @@ namespace OFIQ_LIB::modules::measures
         double T = tmetric(faceLandmarks);
 
         double rawScore = T / (double)session.image().height;
-        double convertedScore = abs(rawScore - 0.45);
 
-        auto scalarScore = ExecuteScalarConversion(qualityMeasure, convertedScore);
-        session.assessment().qAssessments[qualityMeasure] = {rawScore, scalarScore, OFIQ::QualityMeasureReturnCode::Success};
+        SetQualityMeasure(session, qualityMeasure, rawScore, OFIQ::QualityMeasureReturnCode::Success);
+    }
+
+    double HeadSize::ConvertRawScore(OFIQ::QualityMeasure measure, double rawValue)
+    {
+        double convertedScore = abs(rawValue - 0.45);
+        return ExecuteScalarConversion(measure, convertedScore);
     }
 }
\ No newline at end of file
@@ -38,6 +38,21 @@ namespace OFIQ_LIB::modules::measures
 {
     static const auto qualityMeasure = OFIQ::QualityMeasure::IlluminationUniformity;
 
+    /**
+     * @brief Computes the luminance of a region of the aligned face segmented by the landmarked region,
+     * i.e. pixels outside of the face region are black.
+     */
+    static cv::Mat GetFaceRegionLuminance(const Session& session, const cv::Rect& region)
+    {
+        cv::Mat image = session.getAlignedFaceRegion(region);
+        if (image.empty())
+            return image;
+        cv::Mat mask = session.getAlignedFaceLandmarkedRegionBitMask().Unpack(region);
+        cv::Mat faceSegmentation = cv::Mat::zeros(image.size(), image.type());
+        image.copyTo(faceSegmentation, mask);
+        return GetLuminanceImage(faceSegmentation);
+    }
+
     IlluminationUniformity::IlluminationUniformity(
         const Configuration& configuration)
         : Measure{ configuration, qualityMeasure }
@@ -47,15 +62,6 @@ namespace OFIQ_LIB::modules::measures
     void IlluminationUniformity::Execute(OFIQ_LIB::Session & session)
     {
         auto landmarks = session.getAlignedFaceLandmarks();
-        cv::Mat alignedImage = session.getAlignedFace();
-
-        // Find and segment the face region
-        cv::Mat mask = session.getAlignedFaceLandmarkedRegion() * 255;
-        cv::Mat faceSegmentation;
-        cv::bitwise_and(alignedImage, alignedImage, faceSegmentation, mask);
-
-        // Recover the image luminance from RGB
-        auto luminanceImage = GetLuminanceImageFromBGR(faceSegmentation);
 
         // Compute the RMZ and LMZ of the face
         OFIQ::LandmarkPoint leftEyeCenter;
@@ -66,8 +72,10 @@ namespace OFIQ_LIB::modules::measures
         cv::Rect leftRegionOfInterest;
         cv::Rect rightRegionOfInterest;
         CalculateRegionOfInterest(leftRegionOfInterest, rightRegionOfInterest, leftEyeCenter, rightEyeCenter, interEyeDistance, eyeMouthDistance);
-        auto leftRegion = luminanceImage(leftRegionOfInterest);
-        auto rightRegion = luminanceImage(rightRegionOfInterest);
+
+        // Segment the face region and recover the image luminance from RGB, within the RMZ and LMZ only
+        auto leftRegion = GetFaceRegionLuminance(session, leftRegionOfInterest);
+        auto rightRegion = GetFaceRegionLuminance(session, rightRegionOfInterest);
 
         if (leftRegion.empty() || rightRegion.empty())
         {
@@ -88,8 +96,11 @@ namespace OFIQ_LIB::modules::measures
         // Get the sum of the minimums
         double rawScore = cv::sum(minHistogram).val[0];
 
-        double scalarScore = round(100 * (std::pow(rawScore, 0.3)));
-        session.assessment().qAssessments[qualityMeasure] = 
-            { rawScore, scalarScore, OFIQ::QualityMeasureReturnCode::Success };
+        SetQualityMeasure(session, qualityMeasure, rawScore, OFIQ::QualityMeasureReturnCode::Success);
+    }
+
+    double IlluminationUniformity::ConvertRawScore(OFIQ::QualityMeasure, double rawValue)
+    {
+        return round(100 * (std::pow(rawValue, 0.3)));
     }
 }
\ No newline at end of file
@@ -41,14 +41,14 @@ namespace OFIQ_LIB::modules::measures
 
     void Luminance::Execute(OFIQ_LIB::Session & session)
     {
-        cv::Mat aligned = session.getAlignedFace();
+        cv::Mat aligned = session.getAlignedFaceNative();
 
         // Get landmarked region segmentation map
         auto landmarks = session.getLandmarks();
-        auto mask = landmarks::FaceMeasures::GetFaceMask(session.getAlignedFaceLandmarks(), aligned.rows, aligned.cols);
+        auto mask = landmarks::FaceMeasures::GetFaceMask(session, session.getAlignedFaceLandmarks(), aligned.rows, aligned.cols);
 
         // Recover the image luminance from RGB data of image
-        auto luminanceImage = GetLuminanceImageFromBGR(aligned);
+        auto luminanceImage = GetLuminanceImage(aligned);
 
         // Compute the luminance histogram
         cv::Mat1f histogram;
@@ -62,9 +62,7 @@ namespace OFIQ_LIB::modules::measures
             mean += static_cast<double>(histogram.at<float>(i)) * static_cast<double>(i) / 255.0;
         }
 
-        double scalarScoreMean = round(100 * Sigmoid(mean, 0.2, 0.05) * (1 - Sigmoid(mean, 0.8, 0.05)));
-        session.assessment().qAssessments[OFIQ::QualityMeasure::LuminanceMean] = 
-            { mean, scalarScoreMean, OFIQ::QualityMeasureReturnCode::Success };
+        SetQualityMeasure(session, OFIQ::QualityMeasure::LuminanceMean, mean, OFIQ::QualityMeasureReturnCode::Success);
 
         // Compute the variance of the luminance histogram
         double variance = 0;
@@ -73,8 +71,18 @@ namespace OFIQ_LIB::modules::measures
             variance += histogram.at<float>(i) * std::pow(i / 255.0 - mean, 2);
         }
 
-        double scalarScoreVariance = round(100 * sin((60 * variance) / (60 * variance + 1) * M_PI));
-        session.assessment().qAssessments[OFIQ::QualityMeasure::LuminanceVariance] = 
-            { variance, scalarScoreVariance, OFIQ::QualityMeasureReturnCode::Success };
+        SetQualityMeasure(session, OFIQ::QualityMeasure::LuminanceVariance, variance, OFIQ::QualityMeasureReturnCode::Success);
+    }
+
+    double Luminance::ConvertRawScore(OFIQ::QualityMeasure measure, double rawValue)
+    {
+        if (measure == OFIQ::QualityMeasure::LuminanceVariance)
+            return round(100 * sin((60 * rawValue) / (60 * rawValue + 1) * M_PI));
+        return round(100 * Sigmoid(rawValue, 0.2, 0.05) * (1 - Sigmoid(rawValue, 0.8, 0.05)));
+    }
+
+    std::vector<OFIQ::QualityMeasure> Luminance::GetQualityComponents() const
+    {
+        return { OFIQ::QualityMeasure::LuminanceMean, OFIQ::QualityMeasure::LuminanceVariance };
     }
 }
\ No newline at end of file
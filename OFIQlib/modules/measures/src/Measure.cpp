@@ -66,11 +66,33 @@ namespace OFIQ_LIB::modules::measures
         }
         else
         {
-            scalarScore = ExecuteScalarConversion(measure, rawScore);
+            scalarScore = ConvertRawScore(measure, rawScore);
         }
         session.assessment().qAssessments[measure] = {rawScore, scalarScore, code};
     }
 
+    double Measure::ConvertRawScore(OFIQ::QualityMeasure measure, double rawValue)
+    {
+        return ExecuteScalarConversion(measure, rawValue);
+    }
+
+    std::vector<OFIQ::QualityMeasure> Measure::GetQualityComponents() const
+    {
+        return { GetQualityMeasure() };
+    }
+
+    void Measure::Rescore(OFIQ::FaceImageQualityAssessment& assessment)
+    {
+        for (auto measure : GetQualityComponents())
+        {
+            auto it = assessment.qAssessments.find(measure);
+            if (it == assessment.qAssessments.end() ||
+                it->second.code == OFIQ::QualityMeasureReturnCode::FailureToAssess)
+                continue;
+            it->second.scalar = ConvertRawScore(measure, it->second.rawScore);
+        }
+    }
+
     std::string Measure::GetName() const
     {
         return Measure::GetMeasureName(this->m_measure);
@@ -41,8 +41,7 @@ namespace OFIQ_LIB::modules::measures
     void MouthOcclusionPrevention::Execute(OFIQ_LIB::Session & session)
     {
         auto alignedFaceLandmarks = session.getAlignedFaceLandmarks();
-        cv::Mat alignedFace = session.getAlignedFace();
-        cv::Mat faceOcclusionMask = session.getFaceOcclusionSegmentationImage();
+        const BitMask& faceOcclusionMask = session.getFaceOcclusionSegmentationBitMask();
 
         std::vector<cv::Point2i> landmarks;
         for (int i = 76; i < 88; i++)
@@ -50,12 +49,29 @@ namespace OFIQ_LIB::modules::measures
             landmarks.push_back({ alignedFaceLandmarks.landmarks[i].x, alignedFaceLandmarks.landmarks[i].y });
         }
 
-        cv::Mat mask = cv::Mat::zeros(alignedFace.size(), CV_8UC1);
-        cv::fillConvexPoly(mask, landmarks, cv::Scalar(1));
+        // the mouth polygon is only rasterized within its bounding box, with a margin of one pixel
+        cv::Rect region = cv::boundingRect(landmarks);
+        region -= cv::Point(1, 1);
+        region += cv::Size(2, 2);
+        region &= faceOcclusionMask.GetRegion();
+        BitMask mask;
+        if (!region.empty())
+        {
+            for (auto& landmark : landmarks)
+                landmark -= region.tl();
+            cv::Mat regionMask = cv::Mat::zeros(region.size(), CV_8UC1);
+            cv::fillConvexPoly(regionMask, landmarks, cv::Scalar(1));
+            mask = BitMask(regionMask, region.tl());
+        }
 
-        cv::Mat occlusionMask = mask.mul(1 - faceOcclusionMask);
-        double rawScore = cv::sum(occlusionMask).val[0] / cv::sum(mask).val[0];
-        double scalarScore = round(100 * (1 - rawScore));
+        double rawScore = static_cast<double>(mask.CountNonZeroWithout(faceOcclusionMask)) / 
+            static_cast<double>(mask.CountNonZero());
+        SetQualityMeasure(session, qualityMeasure, rawScore, OFIQ::QualityMeasureReturnCode::Success);
+    }
+
+    double MouthOcclusionPrevention::ConvertRawScore(OFIQ::QualityMeasure, double rawValue)
+    {
+        double scalarScore = round(100 * (1 - rawValue));
         if (scalarScore < 0)
         {
             scalarScore = 0;
@@ -64,6 +80,6 @@ namespace OFIQ_LIB::modules::measures
         {
             scalarScore = 100;
         }
-        session.assessment().qAssessments[qualityMeasure] = { rawScore, scalarScore, OFIQ::QualityMeasureReturnCode::Success };
+        return scalarScore;
     }
 }
\ No newline at end of file
@@ -39,25 +39,33 @@ namespace OFIQ_LIB::modules::measures
 
     static const auto qualityMeasure = OFIQ::QualityMeasure::NaturalColour;
 
-    static bool IsColoured(const cv::Mat& image)
+    /**
+     * @brief Checks whether any pixel of the aligned face has different channel values.
+     * @details The aligned face is scanned in stripes, such that a colour image is usually
+     * recognized from the first stripe without copying the complete image.
+     */
+    static bool IsColoured(const Session& session)
     {
-        int channelCount = image.channels();
-
-        if (channelCount != 3)
+        const int stripeRows = 16;
+        cv::Size size = session.getAlignedFaceSize();
+        for (int y = 0; y < size.height; y += stripeRows)
         {
-            return false;
-        }
+            cv::Mat image = session.getAlignedFaceRegion(
+                cv::Rect(0, y, size.width, std::min(stripeRows, size.height - y)));
+            if (image.channels() != 3)
+            {
+                return false;
+            }
 
-        for (int i = 0; i < image.rows; i++)
-        {
-            for (int j = 0; j < image.cols; j++)
+            for (int i = 0; i < image.rows; i++)
             {
-                uchar c0 = image.data[channelCount*(i*image.cols+j)+0];
-                uchar c1 = image.data[channelCount*(i*image.cols+j)+1];
-                uchar c2 = image.data[channelCount*(i*image.cols+j)+2];
-                if (c0 != c1 || c0 != c2 || c1 != c2)
+                const cv::Vec3b* row = image.ptr<cv::Vec3b>(i);
+                for (int j = 0; j < image.cols; j++)
                 {
-                    return true;
+                    if (row[j][0] != row[j][1] || row[j][0] != row[j][2] || row[j][1] != row[j][2])
+                    {
+                        return true;
+                    }
                 }
             }
         }
@@ -81,20 +89,15 @@ namespace OFIQ_LIB::modules::measures
     void NaturalColour::Execute(OFIQ_LIB::Session & session)
     {
         auto landmarks = session.getAlignedFaceLandmarks();
-        auto alignedFace = session.getAlignedFace();
 
-        if (!IsColoured(alignedFace))
+        // gray scale sessions keep a single channel aligned face, no need to scan it
+        if (session.isGrayScale() || !IsColoured(session))
         {
             double D = 0.0;
             SetQualityMeasure(session, qualityMeasure, D, OFIQ::QualityMeasureReturnCode::Success);
             return;
         }
 
-        cv::Mat cvMask = session.getAlignedFaceLandmarkedRegion();
-        cv::Mat faceSegmentation;
-        cv::bitwise_and(alignedFace, alignedFace, faceSegmentation, cvMask);
-
-        cv::Mat maskedImage = CreateMaskedImage(landmarks, faceSegmentation);
         OFIQ::LandmarkPoint leftEyeCenter;
         OFIQ::LandmarkPoint rightEyeCenter;
         double interEyeDistance;
@@ -103,38 +106,61 @@ namespace OFIQ_LIB::modules::measures
         cv::Rect leftRegionOfInterest;
         cv::Rect rightRegionOfInterest;
         CalculateRegionOfInterest(leftRegionOfInterest, rightRegionOfInterest, leftEyeCenter, rightEyeCenter, interEyeDistance, eyeMouthDistance);
-        cv::Mat reducedImage = ReduceImageToRegionOfInterest(maskedImage, leftRegionOfInterest, rightRegionOfInterest);
-        double meanChannelA;
-        double meanChannelB;
-        if (reducedImage.empty())
+
+        // the face is segmented and averaged within the two regions of interest only
+        cv::Size size = session.getAlignedFaceSize();
+        cv::Mat faceMask = FaceMeasures::GetFaceMask(session, landmarks, size.height, size.width);
+        cv::Scalar sums;
+        AddMaskedRegionSums(session, faceMask, rightRegionOfInterest, sums);
+        AddMaskedRegionSums(session, faceMask, leftRegionOfInterest, sums);
+        auto numPixels = static_cast<double>(rightRegionOfInterest.area()) + leftRegionOfInterest.area();
+        if (numPixels == 0)
         {
             double D = 100.0;
             SetQualityMeasure(session, qualityMeasure, D, OFIQ::QualityMeasureReturnCode::FailureToAssess);
             return;
         }
-        ConvertBGRToCIELAB(reducedImage, meanChannelA, meanChannelB);
+        double meanChannelA;
+        double meanChannelB;
+        // the means are computed as cv::mean() does
+        ConvertMeanBGRToCIELAB(
+            sums[0] * (1. / numPixels), sums[1] * (1. / numPixels), sums[2] * (1. / numPixels),
+            meanChannelA, meanChannelB);
         double rawScore = CalculateScore(meanChannelA, meanChannelB);
         SetQualityMeasure(session, qualityMeasure, rawScore, OFIQ::QualityMeasureReturnCode::Success);
     }
 
-    cv::Mat NaturalColour::CreateMaskedImage(const OFIQ::FaceLandmarks& landmarks, const cv::Mat& cvImage) const
+    void NaturalColour::AddMaskedRegionSums(
+        const Session& session,
+        const cv::Mat& faceMask,
+        const cv::Rect& region,
+        cv::Scalar& sums) const
     {
-        auto cvMask = FaceMeasures::GetFaceMask(landmarks, cvImage.rows, cvImage.cols);
-        cv::Mat maskedImage;
-        cvImage.copyTo(maskedImage, cvMask);
-        return maskedImage;
-    }
+        cv::Mat image = session.getAlignedFaceRegion(region);
+        if (image.empty())
+            return;
+        cv::Mat regionMask = session.getAlignedFaceLandmarkedRegionBitMask().Unpack(region);
+        cv::Mat hullMask = faceMask(region);
 
-    cv::Mat NaturalColour::ReduceImageToRegionOfInterest(
-        const cv::Mat& maskedImage,
-        const cv::Rect& leftRegionOfInterest,
-        const cv::Rect& rightRegionOfInterest) const
-    {
-        auto leftRegion = maskedImage(leftRegionOfInterest);
-        auto rightRegion = maskedImage(rightRegionOfInterest);
-        cv::Mat reducedImage;
-        cv::hconcat(std::vector{ rightRegion, leftRegion}, reducedImage);
-        return reducedImage;
+        int64_t blue = 0;
+        int64_t green = 0;
+        int64_t red = 0;
+        for (int i = 0; i < image.rows; i++)
+        {
+            const cv::Vec3b* pixels = image.ptr<cv::Vec3b>(i);
+            const uchar* inRegion = regionMask.ptr<uchar>(i);
+            const uchar* inHull = hullMask.ptr<uchar>(i);
+            for (int j = 0; j < image.cols; j++)
+            {
+                if (inRegion[j] && inHull[j])
+                {
+                    blue += pixels[j][0];
+                    green += pixels[j][1];
+                    red += pixels[j][2];
+                }
+            }
+        }
+        sums += cv::Scalar(static_cast<double>(blue), static_cast<double>(green), static_cast<double>(red));
     }
 
     double NaturalColour::CalculateScore(double meanChannelA, double meanChannelB) const
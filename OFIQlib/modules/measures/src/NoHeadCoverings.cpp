@@ -55,43 +55,39 @@ namespace OFIQ_LIB::modules::measures
 
     void NoHeadCoverings::Execute(OFIQ_LIB::Session & session)
     {
-        cv::Mat M = session.getFaceParsingImage();
+        const auto& M = session.getFaceParsingClassHistogram();
 
         // Crop M from the bottom by 204 pixels
-        cv::Rect rect(0, 0, M.cols, M.rows - 204);
-        cv::Mat croppedImage = M(rect);
+        cv::Size size = M.GetSize();
+        cv::Range rows(0, size.height - 204);
 
         // Count the number n of pixels in M having value 16 or 18
-        cv::Mat mask;
-        cv::Mat clothMask;
-        cv::Mat hatMask;
-        // set all values above and below Segment::cloth to 0
-        cv::threshold(croppedImage, mask, static_cast<uchar>(Segment::cloth) - 1, 255, cv::THRESH_TOZERO);
-        cv::threshold(mask, clothMask, static_cast<uchar>(Segment::cloth), 255, cv::THRESH_TOZERO_INV);
-        // set all values above and below Segment::hat to 0
-        cv::threshold(mask, hatMask, static_cast<uchar>(Segment::hat) - 1, 255, cv::THRESH_TOZERO);
-        cv::threshold(hatMask, hatMask, static_cast<uchar>(Segment::hat), 255, cv::THRESH_TOZERO_INV);
-        auto clothPixels = cv::countNonZero(clothMask);
-        auto hatPixels = cv::countNonZero(hatMask);
+        auto clothPixels = M.Count(static_cast<uchar>(Segment::cloth), rows);
+        auto hatPixels = M.Count(static_cast<uchar>(Segment::hat), rows);
 
         // Output n/m where m is the number of pixels in M
         auto nonZeroPixels = clothPixels + hatPixels;
-        auto totalPixels = croppedImage.size().area();
+        auto totalPixels = static_cast<int64_t>(size.width) * rows.size();
         double rawScore = nonZeroPixels / (double)totalPixels;
 
+        SetQualityMeasure(session, qualityMeasure, rawScore, OFIQ::QualityMeasureReturnCode::Success);
+    }
+
+    double NoHeadCoverings::ConvertRawScore(OFIQ::QualityMeasure, double rawValue)
+    {
         double scalarScore = 0.0;
 
-        if (rawScore <= this->m_t0)
+        if (rawValue <= this->m_t0)
         {
             scalarScore = 100.0;
         }
-        else if (rawScore >= this->m_t1)
+        else if (rawValue >= this->m_t1)
         {
             scalarScore = 0.0;
         }
         else
         {
-            double s = 1 / (1 + std::exp((this->m_x0 - rawScore) / this->m_w));
+            double s = 1 / (1 + std::exp((this->m_x0 - rawValue) / this->m_w));
             double s0 = 1 / (1 + std::exp((this->m_x0 - this->m_t0) / this->m_w));
             double s1 = 1 / (1 + std::exp((this->m_x0 - this->m_t1) / this->m_w));
             double h = s1 - s;
@@ -101,6 +97,6 @@ namespace OFIQ_LIB::modules::measures
             scalarScore = round(100.0 * q);
         }
 
-        session.assessment().qAssessments[qualityMeasure] = { rawScore, scalarScore, OFIQ::QualityMeasureReturnCode::Success };
+        return scalarScore;
     }
 }
@@ -55,7 +55,12 @@ namespace OFIQ_LIB::modules::measures
             return;
         }
 
-        double scalarScore = round(1.0/(rawScore+0.01));
+        SetQualityMeasure(session, qualityMeasure, rawScore, OFIQ::QualityMeasureReturnCode::Success);
+    }
+
+    double OverExposurePrevention::ConvertRawScore(OFIQ::QualityMeasure, double rawValue)
+    {
+        double scalarScore = round(1.0/(rawValue+0.01));
         if (scalarScore < 0)
         {
             scalarScore = 0;
@@ -64,7 +69,6 @@ namespace OFIQ_LIB::modules::measures
         {
             scalarScore = 100;
         }
-        session.assessment().qAssessments[qualityMeasure] = 
-            { rawScore, scalarScore, OFIQ::QualityMeasureReturnCode::Success };
+        return scalarScore;
     }
 }
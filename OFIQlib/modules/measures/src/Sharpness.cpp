@@ -67,6 +67,13 @@ namespace OFIQ_LIB::modules::measures
 
         m_numTrees = m_rtree->getTermCriteria().maxCount;
 
+        if (TreeEnsemble::IsSupported(*m_rtree))
+        {
+            m_treeEnsemble = std::make_unique<TreeEnsemble>(*m_rtree);
+            if (!m_treeEnsemble->MatchesModel(*m_rtree, cv::ml::StatModel::RAW_OUTPUT))
+                m_treeEnsemble.reset();
+        }
+
         SigmoidParameters defaultValues;
         defaultValues.h = 1;
         defaultValues.a = -14.0;
@@ -86,43 +93,294 @@ namespace OFIQ_LIB::modules::measures
         cv::Mat features = GetClassifierFocusFeatures(faceCrop, maskCrop, true);
         features.convertTo(features, CV_32F);
 
-        cv::Mat predResults;
-        m_rtree->predict(features, predResults, cv::ml::StatModel::RAW_OUTPUT);
+        float votes;
+        if (m_treeEnsemble)
+            votes = m_treeEnsemble->PredictSum(features.ptr<float>(0));
+        else
+        {
+            cv::Mat predResults;
+            m_rtree->predict(features, predResults, cv::ml::StatModel::RAW_OUTPUT);
+            votes = predResults.at<float>(0, 0);
+        }
 
-        double prediction = static_cast<float>(m_numTrees) - predResults.at<float>(0, 0);
+        double prediction = static_cast<float>(m_numTrees) - votes;
         SetQualityMeasure(session, qualityMeasure, prediction, OFIQ::QualityMeasureReturnCode::Success);
     }
 
     void Sharpness::GetCroppedImages(
-        const Session& session,
+        Session& session,
         cv::Mat& faceCrop,
         cv::Mat& maskCrop,
         bool useAligned,
         float faceRegionAlpha) const
     {
-        cv::Mat img;
-        cv::Mat faceMask;
         if (useAligned)
         {
-            img = session.getAlignedFace();
-            faceMask = session.getAlignedFaceLandmarkedRegion() * 255;
+            cv::Mat img = session.getAlignedFaceNative();
+            cv::Mat faceMask = session.getAlignedFaceLandmarkedRegion() * 255;
+            std::vector<std::vector<cv::Point>> contours;
+            cv::findContours(faceMask, contours, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE);
+            cv::Rect rect = cv::boundingRect(contours[0]);
+            faceCrop = img(rect);
+            maskCrop = faceMask(rect);
+            return;
         }
-        else
+
+        // The mask of the convex landmark hull is a single region, such that its contour is bounded
+        // by the rectangle of the non-zero mask pixels. Only the face region of the mask is computed
+        // and the crop is converted from the input image directly, the classifier uses gray values.
+        const OFIQ::Image& image = session.image();
+        cv::Rect faceRegion;
+        cv::Mat regionMask = landmarks::FaceMeasures::GetFaceMaskRegion(
+            session.getLandmarks(), image.height, image.width, faceRegion, faceRegionAlpha);
+        cv::Rect rect = cv::boundingRect(regionMask);
+        maskCrop = regionMask(rect) * 255;
+
+        rect += faceRegion.tl();
+        OFIQ::BoundingBox cropRegion(
+            static_cast<int16_t>(rect.x),
+            static_cast<int16_t>(rect.y),
+            static_cast<int16_t>(rect.width),
+            static_cast<int16_t>(rect.height),
+            OFIQ::FaceDetectorType::NotSet);
+        session.requireImageRegion(cropRegion);
+        faceCrop = copyRegionToCvImage(image, cropRegion, true);
+    }
+
+    namespace
+    {
+        /**
+         * @brief Integer kernels of a separable filter; the response is the correlation with kx
+         * along the rows and with ky along the columns.
+         */
+        struct SeparableKernel
+        {
+            std::vector<int> kx;
+            std::vector<int> ky;
+        };
+
+        /**
+         * @brief Edge filter of the focus features, the sum of the responses of its terms.
+         * @details A filter without terms is the absolute difference between the image and its box blur.
+         */
+        struct FocusFilter
+        {
+            std::vector<SeparableKernel> terms;
+            bool onBlurredImage = false;
+            int boxSize = 0;
+        };
+
+        /**
+         * @brief Masked sums of the absolute responses of a filter within a stripe.
+         */
+        struct FocusSums
+        {
+            int64_t sum = 0;
+            double sqSum = 0;
+        };
+
+        /**
+         * @brief Number of image rows processed by one task.
+         */
+        const int focusStripeRows = 32;
+
+        SeparableKernel GetDerivKernel(int dx, int dy, int ksize)
+        {
+            cv::Mat kx;
+            cv::Mat ky;
+            cv::getDerivKernels(kx, ky, dx, dy, ksize, false, CV_32F);
+            SeparableKernel kernel;
+            for (int i = 0; i < static_cast<int>(kx.total()); i++)
+                kernel.kx.push_back(cvRound(kx.at<float>(i)));
+            for (int i = 0; i < static_cast<int>(ky.total()); i++)
+                kernel.ky.push_back(cvRound(ky.at<float>(i)));
+            return kernel;
+        }
+
+        /**
+         * @brief The filters of the focus features in the order of the features: Laplacian
+         * of kernel sizes 1 to 9 on the blurred image, mean differences of box sizes 3 to 7 and
+         * Sobel d/dxdy of kernel sizes 1 to 9. The kernels are those of cv::Laplacian() and cv::Sobel().
+         */
+        const std::vector<FocusFilter>& GetFocusFilters()
         {
-            img = copyToCvImage(session.image());
-            auto faceLandmarks = session.getLandmarks();
-            faceMask = landmarks::FaceMeasures::GetFaceMask(faceLandmarks, img.rows, img.cols, faceRegionAlpha) * 255;
+            static const std::vector<FocusFilter> filters = []()
+                {
+                    std::vector<FocusFilter> result;
+                    for (int k : { 1, 3, 5, 7, 9 })
+                    {
+                        FocusFilter laplacian;
+                        laplacian.onBlurredImage = true;
+                        if (k == 1)
+                            laplacian.terms = { { { 1, -2, 1 }, { 0, 1, 0 } }, { { 0, 1, 0 }, { 1, -2, 1 } } };
+                        else
+                            laplacian.terms = { GetDerivKernel(2, 0, k), GetDerivKernel(0, 2, k) };
+                        result.push_back(laplacian);
+                    }
+                    for (int k : { 3, 5, 7 })
+                    {
+                        FocusFilter meanDiff;
+                        meanDiff.boxSize = k;
+                        result.push_back(meanDiff);
+                    }
+                    for (int k : { 1, 3, 5, 7, 9 })
+                    {
+                        FocusFilter sobel;
+                        sobel.terms = { GetDerivKernel(1, 1, k) };
+                        result.push_back(sobel);
+                    }
+                    return result;
+                }();
+            return filters;
+        }
+
+        /**
+         * @brief Computes the response of a filter for the rows [y0, y0 + numRows) of an 8 bit image
+         * with the border BORDER_REFLECT_101. The responses of 8 bit images are exact in 32 bit integers.
+         */
+        void FilterStripe(
+            const cv::Mat& image,
+            const FocusFilter& filter,
+            int y0,
+            int numRows,
+            std::vector<int>& padded,
+            std::vector<int>& horizontal,
+            std::vector<int>& response)
+        {
+            const int width = image.cols;
+            response.assign(static_cast<size_t>(numRows) * width, 0);
+            for (const auto& term : filter.terms)
+            {
+                const int rx = static_cast<int>(term.kx.size()) / 2;
+                const int ry = static_cast<int>(term.ky.size()) / 2;
+                const int numPaddedRows = numRows + 2 * ry;
+                padded.resize(static_cast<size_t>(width) + 2 * rx);
+                horizontal.assign(static_cast<size_t>(numPaddedRows) * width, 0);
+
+                for (int j = 0; j < numPaddedRows; j++)
+                {
+                    const uchar* src = image.ptr<uchar>(cv::borderInterpolate(y0 - ry + j, image.rows, cv::BORDER_REFLECT_101));
+                    for (int x = -rx; x < width + rx; x++)
+                        padded[x + rx] = src[cv::borderInterpolate(x, width, cv::BORDER_REFLECT_101)];
+
+                    int* dst = &horizontal[static_cast<size_t>(j) * width];
+                    for (size_t i = 0; i < term.kx.size(); i++)
+                    {
+                        const int k = term.kx[i];
+                        const int* p = &padded[i];
+                        if (k != 0)
+                            for (int x = 0; x < width; x++)
+                                dst[x] += k * p[x];
+                    }
+                }
+
+                for (int j = 0; j < numRows; j++)
+                {
+                    int* dst = &response[static_cast<size_t>(j) * width];
+                    for (size_t i = 0; i < term.ky.size(); i++)
+                    {
+                        const int k = term.ky[i];
+                        const int* src = &horizontal[(j + i) * static_cast<size_t>(width)];
+                        if (k != 0)
+                            for (int x = 0; x < width; x++)
+                                dst[x] += k * src[x];
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Computes the masked means and standard deviations of the absolute responses of all
+         * focus filters in a single pass over stripes of rows, which are processed in parallel.
+         * @details The result equals the one of cv::meanStdDev() applied to the absolute responses
+         * computed separately by cv::Laplacian(), cv::absdiff() and cv::Sobel() with CV_64F.
+         * The box blurs are given by filter index for the mean difference filters.
+         */
+        cv::Mat ComputeFocusFeatures(
+            const cv::Mat& grayImage,
+            const cv::Mat& grayBlur3,
+            const std::vector<cv::Mat>& boxBlurs,
+            const cv::Mat& mask)
+        {
+            const auto& filters = GetFocusFilters();
+            const int numStripes = (grayImage.rows + focusStripeRows - 1) / focusStripeRows;
+            std::vector<FocusSums> stripeSums(static_cast<size_t>(numStripes) * filters.size());
+
+            cv::parallel_for_(cv::Range(0, numStripes), [&](const cv::Range& range)
+                {
+                    std::vector<int> padded;
+                    std::vector<int> horizontal;
+                    std::vector<int> response;
+                    for (int stripe = range.start; stripe < range.end; stripe++)
+                    {
+                        const int y0 = stripe * focusStripeRows;
+                        const int numRows = std::min(focusStripeRows, grayImage.rows - y0);
+                        for (size_t f = 0; f < filters.size(); f++)
+                        {
+                            const auto& filter = filters[f];
+                            FocusSums& sums = stripeSums[stripe * filters.size() + f];
+                            if (filter.boxSize > 0)
+                            {
+                                const cv::Mat& boxBlur = boxBlurs[f];
+                                for (int j = 0; j < numRows; j++)
+                                {
+                                    const uchar* gray = grayImage.ptr<uchar>(y0 + j);
+                                    const uchar* box = boxBlur.ptr<uchar>(y0 + j);
+                                    const uchar* m = mask.ptr<uchar>(y0 + j);
+                                    for (int x = 0; x < grayImage.cols; x++)
+                                    {
+                                        if (m[x] == 0)
+                                            continue;
+                                        const int value = std::abs(gray[x] - box[x]);
+                                        sums.sum += value;
+                                        sums.sqSum += static_cast<double>(value) * value;
+                                    }
+                                }
+                                continue;
+                            }
+
+                            FilterStripe(filter.onBlurredImage ? grayBlur3 : grayImage, filter, y0, numRows,
+                                padded, horizontal, response);
+                            for (int j = 0; j < numRows; j++)
+                            {
+                                const int* values = &response[static_cast<size_t>(j) * grayImage.cols];
+                                const uchar* m = mask.ptr<uchar>(y0 + j);
+                                for (int x = 0; x < grayImage.cols; x++)
+                                {
+                                    if (m[x] == 0)
+                                        continue;
+                                    const int value = std::abs(values[x]);
+                                    sums.sum += value;
+                                    sums.sqSum += static_cast<double>(value) * value;
+                                }
+                            }
+                        }
+                    }
+                });
+
+            const double count = cv::countNonZero(mask);
+            cv::Mat features(1, static_cast<int>(2 * filters.size()), CV_64F, cv::Scalar(0));
+            if (count == 0)
+                return features;
+            for (size_t f = 0; f < filters.size(); f++)
+            {
+                int64_t sum = 0;
+                double sqSum = 0;
+                for (int stripe = 0; stripe < numStripes; stripe++)
+                {
+                    sum += stripeSums[stripe * filters.size() + f].sum;
+                    sqSum += stripeSums[stripe * filters.size() + f].sqSum;
+                }
+                const double mean = static_cast<double>(sum) / count;
+                features.at<double>(0, static_cast<int>(2 * f)) = mean;
+                features.at<double>(0, static_cast<int>(2 * f + 1)) = std::sqrt(std::max(sqSum / count - mean * mean, 0.0));
+            }
+            return features;
         }
-        std::vector<std::vector<cv::Point>> contours;
-        cv::findContours(faceMask, contours, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE);
-        cv::Rect rect = cv::boundingRect(contours[0]);
-        faceCrop = img(rect);
-        maskCrop = faceMask(rect);
     }
 
-    cv::Mat Sharpness::GetClassifierFocusFeatures(const cv::Mat& image, const cv::Mat& mask, bool applyBlur) const
+    cv::Mat Sharpness::GetClassifierFocusFeatures(const cv::Mat& image, const cv::Mat& mask, bool applyBlur)
     {
-        cv::Mat features;
         cv::Mat grayImage = image.clone();
         if (image.channels() == 3)
         {
@@ -133,46 +391,15 @@ namespace OFIQ_LIB::modules::measures
         {
             cv::GaussianBlur(grayBlur3, grayBlur3, cv::Size(3, 3), 0);
         }
-        // calculate Laplacian features
-        std::array<int, 5> kernelSizes { 1, 3, 5, 7, 9 };
-        for (const int& k : kernelSizes)
-        {
-            cv::Mat laplacian;
-            cv::Mat mean;
-            cv::Mat stddev;
-            cv::Laplacian(grayBlur3, laplacian, CV_64F, k);
-            cv::Mat abs = cv::abs(laplacian);
-            cv::meanStdDev(abs, mean, stddev, mask);
-            features.push_back(mean.reshape(1));
-            features.push_back(stddev.reshape(1));
-        }
-        // calculate Mean Diff features
-        std::array<int, 3> kernelSizesMeanDiff{ 3, 5, 7 };
-        for (const int& k : kernelSizesMeanDiff)
-        {
-            cv::Mat grayMeanBlur;
-            cv::Mat absdiff;
-            cv::Mat mean;
-            cv::Mat stddev;
-            cv::blur(grayImage, grayMeanBlur, cv::Size(k, k));
-            cv::absdiff(grayImage, grayMeanBlur, absdiff);
-            cv::meanStdDev(absdiff, mean, stddev, mask);
-            features.push_back(mean.reshape(1));
-            features.push_back(stddev.reshape(1));
-        }
-        // calculate Sobel features
-        for (const int& k : kernelSizes)
+        // box blurs of the mean difference features by filter index
+        const auto& filters = GetFocusFilters();
+        std::vector<cv::Mat> boxBlurs(filters.size());
+        for (size_t f = 0; f < filters.size(); f++)
         {
-            cv::Mat sobel;
-            cv::Mat mean;
-            cv::Mat stddev;
-            cv::Sobel(grayImage, sobel, CV_64F, 1, 1, k);
-            cv::Mat abs = cv::abs(sobel);
-            cv::meanStdDev(abs, mean, stddev, mask);
-            features.push_back(mean.reshape(1));
-            features.push_back(stddev.reshape(1));
+            if (filters[f].boxSize > 0)
+                cv::blur(grayImage, boxBlurs[f], cv::Size(filters[f].boxSize, filters[f].boxSize));
         }
-        cv::transpose(features, features);
-        return features;
+        // Laplacian, mean difference and Sobel features in the order of GetFocusFilters()
+        return ComputeFocusFeatures(grayImage, grayBlur3, boxBlurs, mask);
     }
-}
\ No newline at end of file
+}
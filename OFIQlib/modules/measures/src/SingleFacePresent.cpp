@@ -84,8 +84,13 @@ namespace OFIQ_LIB::modules::measures
             f = a2 / a1;
         }
 
+        SetQualityMeasure(session, qualityMeasure, static_cast<double>(f), OFIQ::QualityMeasureReturnCode::Success);
+    }
+
+    double SingleFacePresent::ConvertRawScore(OFIQ::QualityMeasure, double rawValue)
+    {
+        auto f = static_cast<float>(rawValue);
         float qc = round(100.0f * (1.0f - f));
-        session.assessment().qAssessments[qualityMeasure] = 
-            { static_cast<double>(f), static_cast<double>(qc), OFIQ::QualityMeasureReturnCode::Success };
+        return static_cast<double>(qc);
     }
 }
\ No newline at end of file
@@ -35,6 +35,7 @@ namespace OFIQ_LIB::modules::measures
 {
     static const auto qualityMeasure = OFIQ::QualityMeasure::UnifiedQualityScore;
     static const std::string paramModelpath = "params.measures.UnifiedQualityScore.model_path";
+    static const std::string paramExportEmbedding = "params.measures.UnifiedQualityScore.export_embedding";
     static const int imageSize = 112;
     static const int cropLeft = 40;
     static const int cropRight = 40;
@@ -46,6 +47,9 @@ namespace OFIQ_LIB::modules::measures
     UnifiedQualityScore::UnifiedQualityScore(const Configuration& configuration)
         : Measure{ configuration, qualityMeasure }
     {
+        if (!configuration.GetBool(paramExportEmbedding, m_exportEmbedding))
+            m_exportEmbedding = false;
+
         try
         {
             SigmoidParameters defaultValues;
@@ -62,7 +66,7 @@ namespace OFIQ_LIB::modules::measures
             std::vector<uint8_t> modelData(
                 (std::istreambuf_iterator<char>(instream)),
                 std::istreambuf_iterator<char>());
-            m_onnxRuntimeEnv.initialize(modelData, imageSize,imageSize); 
+            m_onnxRuntimeEnv.initialize(modelData, imageSize,imageSize, getOnnxRuntimeThreading(configuration)); 
         }
         catch (std::exception&)
         {
@@ -97,6 +101,23 @@ namespace OFIQ_LIB::modules::measures
         auto out = m_onnxRuntimeEnv.run(net_input);
         auto outPtr = out[0].GetTensorMutableData<float>();
         double rawScore = outPtr[0];
+
+        if (m_exportEmbedding)
+        {
+            // the score is the first value of the first output, the embedding is the first vector output
+            auto& embedding = session.assessment().embedding;
+            embedding.clear();
+            for (auto& output : out)
+            {
+                auto numElements = output.GetTensorTypeAndShapeInfo().GetElementCount();
+                if (numElements > 1)
+                {
+                    const float* data = output.GetTensorMutableData<float>();
+                    embedding.assign(data, data + numElements);
+                    break;
+                }
+            }
+        }
         SetQualityMeasure(session, qualityMeasure, rawScore, OFIQ::QualityMeasureReturnCode::Success);
     }
 }
\ No newline at end of file
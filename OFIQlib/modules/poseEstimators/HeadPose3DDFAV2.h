@@ -110,11 +110,12 @@ namespace OFIQ_LIB::modules::poseEstimators
 
         /**
          * @brief Crop face from image. Internally the passed bounding box will be transformed to a square region.
+         * Only the pixels of the square region are copied and converted to BGR.
          * 
          * @param image Input image.
          * @param biggestFace Input region to be cropped.
          * @return cv::Mat Cropped face region.
          */
-        cv::Mat CropImage(const cv::Mat& image, const OFIQ::BoundingBox& biggestFace) const;
+        cv::Mat CropImage(const OFIQ::Image& image, const OFIQ::BoundingBox& biggestFace) const;
     };
 }
\ No newline at end of file
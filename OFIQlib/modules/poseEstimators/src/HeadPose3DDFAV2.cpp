@@ -54,7 +54,8 @@ namespace OFIQ_LIB::modules::poseEstimators
                 (std::istreambuf_iterator<char>(instream)),
                 std::istreambuf_iterator<char>());
 
-            m_ortSession = std::make_unique<Ort::Session>(m_ortenv, modelData.data(), modelData.size(), Ort::SessionOptions{ nullptr });
+            m_ortSession = std::make_unique<Ort::Session>(m_ortenv, modelData.data(), modelData.size(),
+                CreateOnnxRuntimeSessionOptions(getOnnxRuntimeThreading(config)));
 
             auto type_info = m_ortSession->GetInputTypeInfo(0);
             auto tensor_info = type_info.GetTensorTypeAndShapeInfo();
@@ -77,10 +78,9 @@ namespace OFIQ_LIB::modules::poseEstimators
 
     void HeadPose3DDFAV2::updatePose(OFIQ_LIB::Session& session, EulerAngle& pose)
     {
-        const auto cvImageBGR = copyToCvImage(session.image());
         auto biggestFace = session.getDetectedFaces()[0];
 
-        cv::Mat croppedImageBGR = CropImage(cvImageBGR, biggestFace);
+        cv::Mat croppedImageBGR = CropImage(session.image(), biggestFace);
 
         cv::Mat resizedImage;
         cv::resize(croppedImageBGR, resizedImage, cv::Size(static_cast<int>(m_expectedImageWidth), static_cast<int>(m_expectedImageHeight)), 0, 0, cv::INTER_LINEAR);
@@ -187,7 +187,7 @@ namespace OFIQ_LIB::modules::poseEstimators
         pose[2] = angles[2]; // Roll
     }
 
-    cv::Mat HeadPose3DDFAV2::CropImage(const cv::Mat& image, const OFIQ::BoundingBox& detectedFace) const
+    cv::Mat HeadPose3DDFAV2::CropImage(const OFIQ::Image& image, const OFIQ::BoundingBox& detectedFace) const
     {
         double centerX = detectedFace.xleft + detectedFace.width / 2.0;
         double centerY = detectedFace.ytop + detectedFace.height / 2.0;
@@ -200,22 +200,9 @@ namespace OFIQ_LIB::modules::poseEstimators
         box.ytop = b;
         box.width = c - a;
         box.height = d - b;
-        cv::Mat paddedImage;
-        OFIQ::BoundingBox croppedBox;
-        Point2i translationVector;
-        OFIQ_LIB::makeSquareBoundingBoxWithPadding(box, image, paddedImage, croppedBox, translationVector);
-
-        // crop image
-        // Define the region of interest (ROI) for cropping
-        cv::Rect roi(
-            croppedBox.xleft,
-            croppedBox.ytop,
-            croppedBox.width,
-            croppedBox.height); // (x, y, width, height)
-
-        // Crop the image using the ROI
-        cv::Mat croppedImage = paddedImage(roi);
-        return croppedImage;
+
+        // copy only the square face region, parts outside the image are padded with black
+        return copyRegionToCvImage(image, OFIQ_LIB::makeSquareBoundingBox(box));
     }
 
 }
\ No newline at end of file
@@ -31,6 +31,8 @@
 #include <opencv2/opencv.hpp>
 #include <onnxruntime_cxx_api.h>
 
+#include "utils.h"
+
 /**
  * @brief Helper class to manage the ONNXRuntime session object.
  * @details Helper class to manage the ONNXRuntime session object. Details can be found on the ONNXRuntime documentation
@@ -70,8 +72,13 @@ private:
      * @param i_model_data Model data loaded from file.
      * @param i_imageWidth Width of the input image as expected by the model.
      * @param i_imageHeight Height of the input image as expected by the model.
+     * @param i_threading Threading of the session.
      */
-    void init_session(const std::vector<uint8_t>& i_model_data, int64_t i_imageWidth, int64_t i_imageHeight);
+    void init_session(
+        const std::vector<uint8_t>& i_model_data,
+        int64_t i_imageWidth,
+        int64_t i_imageHeight,
+        const OFIQ_LIB::OnnxRuntimeThreading& i_threading);
  
 
 public:
@@ -93,9 +100,14 @@ public:
      * @param i_modelData Model data loaded from file.
      * @param i_imageWidth Width of the input image as expected by the model.
      * @param i_imageHeight Height of the input image as expected by the model.
+     * @param i_threading Threading of the session, see
+     * \link OFIQ_LIB::getOnnxRuntimeThreading(const Configuration&) getOnnxRuntimeThreading()\endlink.
      */
     void initialize(
-        const std::vector<uint8_t>& i_modelData, int64_t i_imageWidth, int64_t i_imageHeight);
+        const std::vector<uint8_t>& i_modelData,
+        int64_t i_imageWidth,
+        int64_t i_imageHeight,
+        const OFIQ_LIB::OnnxRuntimeThreading& i_threading);
     
     /**
      * @brief Get the number of output nodes (results) based on the loaded model.
@@ -47,7 +47,7 @@ namespace OFIQ_LIB::modules::segmentations
             std::vector<uint8_t> modelData(
                 (std::istreambuf_iterator<char>(instream)),
                 std::istreambuf_iterator<char>());
-            m_onnxRuntimeEnv.initialize(modelData, m_imageSize, m_imageSize);
+            m_onnxRuntimeEnv.initialize(modelData, m_imageSize, m_imageSize, getOnnxRuntimeThreading(config));
         }
         catch (const std::exception& e)
         {
@@ -122,13 +122,9 @@ namespace OFIQ_LIB::modules::segmentations
             memcpy(maskImage.data.get(), m_segmentationImage->data, maskImage.size());
         }
         else {
-            if (auto channel = static_cast<uchar>(faceSegment); channel != 0)
-            {
-                cv::threshold(*m_segmentationImage, mask, channel, 255, cv::THRESH_TOZERO_INV);
-                cv::threshold(mask, mask, channel - 1, 255, cv::THRESH_BINARY);
-            }
-            else
-                cv::threshold(*m_segmentationImage, mask, channel, 255, cv::THRESH_BINARY_INV);
+            // 255 for the pixels of the class, 0 otherwise
+            auto channel = static_cast<uchar>(faceSegment);
+            cv::compare(*m_segmentationImage, channel, mask, cv::CMP_EQ);
 
             auto kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, {3, 3});
             cv::morphologyEx(mask, mask, cv::MORPH_OPEN, kernel);
@@ -26,14 +26,18 @@
 
 #include <ONNXRTSegmentation.h>
 #include "OFIQError.h"
+#include "utils.h"
 
 void ONNXRuntimeSegmentation::initialize(
-    const std::vector<uint8_t>& i_modelData, int64_t i_imageWidth, int64_t i_imageHeight)
+    const std::vector<uint8_t>& i_modelData,
+    int64_t i_imageWidth,
+    int64_t i_imageHeight,
+    const OFIQ_LIB::OnnxRuntimeThreading& i_threading)
 {
 
     try
     {
-        init_session(i_modelData, i_imageWidth, i_imageHeight);
+        init_session(i_modelData, i_imageWidth, i_imageHeight, i_threading);
     }
     catch (const std::exception&)
     {
@@ -91,14 +95,15 @@ std::vector<Ort::Value> ONNXRuntimeSegmentation::run( std::vector<float>& i_netI
 void ONNXRuntimeSegmentation::init_session(
     const std::vector<uint8_t>& i_model_data,
     int64_t i_imageWidth,
-    int64_t i_imageHeight)
+    int64_t i_imageHeight,
+    const OFIQ_LIB::OnnxRuntimeThreading& i_threading)
 {
     m_ortenv = Ort::Env(ORT_LOGGING_LEVEL_ERROR);
     m_ortSession = std::make_unique<Ort::Session>(
         m_ortenv,
         i_model_data.data(),
         i_model_data.size(),
-        Ort::SessionOptions{nullptr});
+        OFIQ_LIB::CreateOnnxRuntimeSessionOptions(i_threading));
 
 
     auto type_info = m_ortSession->GetInputTypeInfo(0);
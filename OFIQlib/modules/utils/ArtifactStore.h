@@ -0,0 +1,185 @@
+/**
+ * @file ArtifactStore.h
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief Provides a file format for storing the pre-processing results of many images.
+ * @author OFIQ development team
+ */
+#ifndef OFIQ_LIB_ARTIFACT_STORE_H
+#define OFIQ_LIB_ARTIFACT_STORE_H
+
+#include "ofiq_lib.h"
+#include "Session.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+ /**
+  * Namespace for OFIQ implementations.
+  */
+namespace OFIQ_LIB
+{
+    /**
+     * @brief Writes a store of binary records identified by a key, e.g. the serialized
+     * pre-processing results of many images identified by their file names, see
+     * \link OFIQ_LIB::Session::serialize() Session::serialize()\endlink.
+     * @details The records are written in the order they are added, each starting at an offset
+     * aligned to 64 bytes. When the writer is closed, an index of the keys is appended.
+     * The file is read by \link OFIQ_LIB::ArtifactStoreReader ArtifactStoreReader\endlink.
+     */
+    class OFIQ_EXPORT ArtifactStoreWriter
+    {
+    public:
+        /**
+         * @brief Constructor. An existing file is overwritten.
+         * 
+         * @param path Path of the store file.
+         * @throws OFIQError with ReturnCode::UnknownError if the file cannot be created.
+         */
+        explicit ArtifactStoreWriter(const std::string& path);
+
+        /**
+         * @brief Destructor. Closes the store if this has not been done.
+         */
+        ~ArtifactStoreWriter();
+
+        ArtifactStoreWriter(const ArtifactStoreWriter&) = delete;
+        ArtifactStoreWriter& operator=(const ArtifactStoreWriter&) = delete;
+
+        /**
+         * @brief Adds a record.
+         * 
+         * @param key Key of the record. If a key is added twice, the later record is found by the reader.
+         * @param data Record data.
+         * @throws OFIQError with ReturnCode::UnknownError if the data cannot be written.
+         */
+        void Add(const std::string& key, const std::vector<uint8_t>& data);
+
+        /**
+         * @brief Writes the index and closes the file.
+         * @throws OFIQError with ReturnCode::UnknownError if the index cannot be written.
+         */
+        void Close();
+
+    private:
+        /**
+         * @brief Output file stream.
+         */
+        std::ofstream m_stream;
+
+        /**
+         * @brief Current write position.
+         */
+        uint64_t m_offset = 0;
+
+        /**
+         * @brief Keys of the records with their offsets and sizes.
+         */
+        std::vector<std::pair<std::string, std::pair<uint64_t, uint64_t>>> m_index;
+    };
+
+    /**
+     * @brief Reads a store written by \link OFIQ_LIB::ArtifactStoreWriter ArtifactStoreWriter\endlink.
+     * @details The file is mapped into memory; records are accessed without copying.
+     */
+    class OFIQ_EXPORT ArtifactStoreReader
+    {
+    public:
+        /**
+         * @brief Constructor.
+         * 
+         * @param path Path of the store file.
+         * @throws OFIQError with ReturnCode::UnknownError if the file cannot be mapped or is no valid store.
+         */
+        explicit ArtifactStoreReader(const std::string& path);
+
+        /**
+         * @brief Destructor. Unmaps the file.
+         */
+        ~ArtifactStoreReader();
+
+        ArtifactStoreReader(const ArtifactStoreReader&) = delete;
+        ArtifactStoreReader& operator=(const ArtifactStoreReader&) = delete;
+
+        /**
+         * @brief Looks up a record.
+         * 
+         * @param[in] key Key of the record.
+         * @param[out] data Pointer to the record data within the mapped file. It is valid
+         * during the lifetime of the reader.
+         * @param[out] size Number of bytes of the record.
+         * @return true if the record has been found.
+         * @return false otherwise.
+         */
+        bool Find(const std::string& key, const uint8_t*& data, size_t& size) const;
+
+        /**
+         * @brief Returns the keys of all records.
+         * 
+         * @return std::vector<std::string> Keys in the order they have been added.
+         */
+        std::vector<std::string> GetKeys() const;
+
+    private:
+        /**
+         * @brief Maps the file into memory.
+         */
+        void Map(const std::string& path);
+
+        /**
+         * @brief Unmaps the file.
+         */
+        void Unmap();
+
+        /**
+         * @brief Start address of the mapped file.
+         */
+        const uint8_t* m_data = nullptr;
+
+        /**
+         * @brief Size of the mapped file.
+         */
+        size_t m_size = 0;
+
+        /**
+         * @brief Platform specific handles of the mapping.
+         */
+        void* m_fileHandle = nullptr;
+        void* m_mappingHandle = nullptr;
+
+        /**
+         * @brief Keys in the order they have been added.
+         */
+        std::vector<std::string> m_keys;
+
+        /**
+         * @brief Offsets and sizes of the records by key.
+         */
+        std::unordered_map<std::string, std::pair<uint64_t, uint64_t>> m_index;
+    };
+}
+
+#endif /* OFIQ_LIB_ARTIFACT_STORE_H */
@@ -0,0 +1,119 @@
+/**
+ * @file BitMask.h
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief Provides a bit-packed binary mask with population count statistics.
+ * @author OFIQ development team
+ */
+#ifndef OFIQ_LIB_BIT_MASK_H
+#define OFIQ_LIB_BIT_MASK_H
+
+#include "ofiq_lib.h"
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core.hpp>
+
+ /**
+  * Namespace for OFIQ implementations.
+  */
+namespace OFIQ_LIB
+{
+    /**
+     * @brief Binary mask storing one bit per pixel.
+     * @details The mask covers a region of an image, e.g. the bounding box of a polygon within the
+     * aligned face. The bits of each row are packed into 64 bit words aligned to the columns of the
+     * image, such that masks of different regions of the same image are combined word by word.
+     * Pixels are counted by population counts of the words.
+     */
+    class OFIQ_EXPORT BitMask
+    {
+    public:
+        /**
+         * @brief Constructor of an empty mask.
+         */
+        BitMask() = default;
+
+        /**
+         * @brief Constructor packing the non-zero pixels of a single channel 8 bit mask.
+         * 
+         * @param mask Mask of type CV_8UC1.
+         * @param origin Position of the mask within the image, i.e. of its top-left pixel.
+         */
+        explicit BitMask(const cv::Mat& mask, const cv::Point& origin = cv::Point(0, 0));
+
+        /**
+         * @brief Get the region of the image covered by this mask.
+         * 
+         * @return cv::Rect Region in image coordinates.
+         */
+        cv::Rect GetRegion() const { return m_region; }
+
+        /**
+         * @brief Counts the set pixels.
+         * 
+         * @return int64_t Number of set pixels.
+         */
+        int64_t CountNonZero() const;
+
+        /**
+         * @brief Counts the pixels set in this mask but not in another mask of the same image.
+         * @details Pixels outside the region of the other mask are not set in the other mask.
+         * 
+         * @param other Mask whose pixels are excluded.
+         * @return int64_t Number of pixels set in this mask only.
+         */
+        int64_t CountNonZeroWithout(const BitMask& other) const;
+
+        /**
+         * @brief Unpacks the pixels of a region of the image.
+         * 
+         * @param region Region in image coordinates, which may exceed the region of this mask.
+         * @return cv::Mat Mask of type CV_8UC1 and the size of the region, being 1 for set pixels and 0 otherwise.
+         */
+        cv::Mat Unpack(const cv::Rect& region) const;
+
+    private:
+        /**
+         * @brief Region of the image covered by the mask.
+         */
+        cv::Rect m_region;
+
+        /**
+         * @brief Index of the first word of each row, counted from the left border of the image.
+         */
+        int m_firstWord = 0;
+
+        /**
+         * @brief Number of words of each row.
+         */
+        int m_wordsPerRow = 0;
+
+        /**
+         * @brief Words of all rows; bit b of word w of a row is the pixel in column
+         * 64 * (m_firstWord + w) + b of the image.
+         */
+        std::vector<uint64_t> m_words;
+    };
+}
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * @file ClassHistogram.h
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief Provides pixel counts and masks of the classes of a label map.
+ * @author OFIQ development team
+ */
+#ifndef OFIQ_LIB_CLASS_HISTOGRAM_H
+#define OFIQ_LIB_CLASS_HISTOGRAM_H
+
+#include "ofiq_lib.h"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <opencv2/core.hpp>
+
+ /**
+  * Namespace for OFIQ implementations.
+  */
+namespace OFIQ_LIB
+{
+    /**
+     * @brief Counts the pixels of the classes of a label map, e.g. the face parsing image.
+     * @details The constructor computes the class histograms of all rows in a single pass over the
+     * label map and accumulates them along the rows, such that the number of pixels of a class within
+     * a range of rows is looked up in constant time. Counts within a range of rows and columns use an
+     * integral image of the class, which is computed on the first request for the class. Binary masks
+     * of the classes are computed on demand as well.
+     */
+    class OFIQ_EXPORT ClassHistogram
+    {
+    public:
+        /**
+         * @brief Constructor of an empty histogram.
+         */
+        ClassHistogram() = default;
+
+        /**
+         * @brief Constructor counting the classes of a label map.
+         * 
+         * @param labels Label map of type CV_8UC1. The pixels are not copied, i.e. the label map must
+         * not be modified while the histogram is used.
+         */
+        explicit ClassHistogram(const cv::Mat& labels);
+
+        /**
+         * @brief Get the size of the label map.
+         * 
+         * @return cv::Size Size of the label map.
+         */
+        cv::Size GetSize() const { return m_labels.size(); }
+
+        /**
+         * @brief Counts the pixels of a class within a range of rows.
+         * 
+         * @param label Class label.
+         * @param rows Range of rows; cv::Range::all() for the complete label map.
+         * @return int64_t Number of pixels with the label.
+         */
+        int64_t Count(uchar label, const cv::Range& rows = cv::Range::all()) const;
+
+        /**
+         * @brief Counts the pixels of a class within a range of rows and columns.
+         * 
+         * @param label Class label.
+         * @param rows Range of rows.
+         * @param cols Range of columns.
+         * @return int64_t Number of pixels with the label.
+         */
+        int64_t Count(uchar label, const cv::Range& rows, const cv::Range& cols) const;
+
+        /**
+         * @brief Get the binary mask of a class.
+         * @details The returned matrix is shared by all calls for the class and must not be modified.
+         * 
+         * @param label Class label.
+         * @return cv::Mat Mask of type CV_8UC1 being 255 for pixels with the label and 0 otherwise.
+         */
+        cv::Mat GetMask(uchar label) const;
+
+    private:
+        /**
+         * @brief Clips a range to the interval [0, size); cv::Range::all() is the complete interval.
+         */
+        static cv::Range Clip(const cv::Range& range, int size);
+
+        /**
+         * @brief Label map.
+         */
+        cv::Mat m_labels;
+
+        /**
+         * @brief Number of pixels of each class in the rows above each row; entry
+         * 256 * r + label for the rows 0 to r - 1.
+         */
+        std::vector<int32_t> m_rowPrefixCounts;
+
+        /**
+         * @brief Integral images of (rows + 1) x (cols + 1) pixel counts, by class.
+         */
+        mutable std::map<uchar, cv::Mat> m_integrals;
+
+        /**
+         * @brief Binary masks by class.
+         */
+        mutable std::map<uchar, cv::Mat> m_masks;
+    };
+}
+
+#endif
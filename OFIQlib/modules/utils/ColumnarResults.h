@@ -0,0 +1,177 @@
+/**
+ * @file ColumnarResults.h
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief Provides a columnar binary file format for the quality assessments of many images.
+ * @author OFIQ development team
+ */
+#ifndef OFIQ_LIB_COLUMNAR_RESULTS_H
+#define OFIQ_LIB_COLUMNAR_RESULTS_H
+
+#include "ofiq_lib.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+ /**
+  * Namespace for OFIQ implementations.
+  */
+namespace OFIQ_LIB
+{
+    /**
+     * @brief Writes the quality assessments of many images into a columnar binary file.
+     * @details The schema is fixed: every quality measure from UnifiedQualityScore to
+     * NoHeadCoverings has a column of raw scores, a column of scalar values and a column
+     * of return codes, independent of the measures configured. The file is laid out to be
+     * memory-mapped; all integers are little endian and all arrays start at offsets aligned
+     * to 64 bytes.
+     * 
+     * - File header of 64 bytes: magic number "OFIQCR01", number of measures M (uint32),
+     *   maximal number of rows per block (uint32), followed by M schema entries of 32 bytes
+     *   each: measure id (int32) and zero-terminated name (28 chars).
+     * - Blocks of at most that number of rows N. A block starts with the number of rows N
+     *   (uint64), the number of columns C = 3 + 3 * M (uint64) and the offsets of the columns
+     *   relative to the start of the block (C x uint64). The columns are the end offsets of the
+     *   image references within the reference column (N x uint64), the image references
+     *   (bytes, not terminated), the assessment times in milliseconds (N x int32) and, for each
+     *   measure in the order of the schema, the raw scores (N x float64), the scalar values
+     *   (N x float64) and the return codes (N x int8). Measures not assessed have NaN scores
+     *   and the return code -1.
+     * - Footer at an aligned offset: offsets of the blocks (uint64 each), total number of rows
+     *   (uint64), number of blocks (uint64), offset of the footer (uint64) and the magic number.
+     * 
+     * Rows are collected into blocks which are written by a background thread, such that
+     * adding a row does not wait for the file system.
+     */
+    class OFIQ_EXPORT ColumnarResultsWriter
+    {
+    public:
+        /**
+         * @brief Constructor. An existing file is overwritten.
+         * 
+         * @param path Path of the results file.
+         * @param rowsPerBlock Maximal number of rows per block.
+         * @throws OFIQError with ReturnCode::UnknownError if the file cannot be created.
+         */
+        explicit ColumnarResultsWriter(const std::string& path, uint32_t rowsPerBlock = 65536);
+
+        /**
+         * @brief Destructor. Closes the file if this has not been done.
+         */
+        ~ColumnarResultsWriter();
+
+        ColumnarResultsWriter(const ColumnarResultsWriter&) = delete;
+        ColumnarResultsWriter& operator=(const ColumnarResultsWriter&) = delete;
+
+        /**
+         * @brief Adds the row of one image.
+         * 
+         * @param imageReference Reference of the image, e.g. its file name.
+         * @param assessments Assessment of the image.
+         * @param elapsedMs Time taken by the assessment in milliseconds.
+         * @throws OFIQError with ReturnCode::UnknownError if writing a previous block failed.
+         */
+        void Add(
+            const std::string& imageReference,
+            const OFIQ::FaceImageQualityAssessment& assessments,
+            int32_t elapsedMs);
+
+        /**
+         * @brief Writes the pending rows and the footer and closes the file.
+         * @throws OFIQError with ReturnCode::UnknownError if the file cannot be written.
+         */
+        void Close();
+
+        /**
+         * @brief Returns the measures of the schema in the order of their columns.
+         */
+        static const std::vector<OFIQ::QualityMeasure>& GetMeasures();
+
+    private:
+        /**
+         * @brief Rows of one block, stored by column.
+         */
+        struct Block
+        {
+            std::vector<uint64_t> referenceEnds;
+            std::string references;
+            std::vector<int32_t> elapsedMs;
+            std::vector<std::vector<double>> rawScores;
+            std::vector<std::vector<double>> scalars;
+            std::vector<std::vector<int8_t>> codes;
+        };
+
+        /**
+         * @brief Creates an empty block with the columns of the schema.
+         */
+        static std::unique_ptr<Block> CreateBlock();
+
+        /**
+         * @brief Hands the current block over to the writer thread.
+         */
+        void Flush();
+
+        /**
+         * @brief Writes the blocks handed over until the writer is closed.
+         */
+        void WriteBlocks();
+
+        /**
+         * @brief Writes one block at the current position.
+         */
+        void WriteBlock(const Block& block);
+
+        /**
+         * @brief Writes zero bytes up to the next aligned offset.
+         */
+        void Pad();
+
+        /**
+         * @brief Throws the error of the writer thread, if any.
+         */
+        void CheckError();
+
+        std::ofstream m_stream;
+        uint64_t m_offset = 0;
+        uint32_t m_rowsPerBlock;
+        uint64_t m_numRows = 0;
+        std::vector<uint64_t> m_blockOffsets;
+
+        std::unique_ptr<Block> m_block;
+        std::deque<std::unique_ptr<Block>> m_pending;
+        bool m_closing = false;
+        std::exception_ptr m_error;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::thread m_thread;
+    };
+}
+
+#endif /* OFIQ_LIB_COLUMNAR_RESULTS_H */
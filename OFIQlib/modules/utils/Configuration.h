@@ -142,6 +142,15 @@ namespace OFIQ_LIB
          */
         void SetDataDir(std::string_view dataDir);
 
+        /**
+         * @brief Canonical string representation of all configurations.
+         * @details The keys are listed in lexicographical order together with their
+         * JSON encoded values. Two configurations with equal entries yield the same string,
+         * regardless of the formatting of the configuration files.
+         * @return String representation of the configurations.
+         */
+        std::string ToString() const;
+
     private:
         /**
          * @brief Map holding all configuration that can be accessed using a string key. 
@@ -0,0 +1,124 @@
+/**
+ * @file EncodedImage.h
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief Provides access to encoded images which are decoded on demand.
+ * @author OFIQ development team
+ */
+#ifndef OFIQ_LIB_ENCODED_IMAGE_H
+#define OFIQ_LIB_ENCODED_IMAGE_H
+
+#include "ofiq_lib.h"
+
+#include <vector>
+
+ /**
+  * Namespace for OFIQ implementations.
+  */
+namespace OFIQ_LIB
+{
+    /**
+     * @brief Image given as JPEG or PNG encoded byte array which is decoded on demand.
+     * @details Baseline and progressive JPEG images with YCbCr or gray scale data are
+     * not decoded completely. Instead, a down-scaled version of the image can be decoded
+     * in the DCT domain, and regions of the full resolution image are decoded when they
+     * are requested by \link OFIQ_LIB::EncodedImage::DecodeRegion() DecodeRegion()\endlink.
+     * Pixels outside the decoded regions are black. Gray scale JPEG images are decoded
+     * to 24 bit RGB, as \link OFIQ_LIB::readImage() readImage()\endlink does, such that
+     * both entry points yield the same image type. All other images (PNG, CMYK JPEG,
+     * JPEG images with an EXIF orientation) are decoded completely on construction,
+     * identical to \link OFIQ_LIB::readImageFromByteArray() readImageFromByteArray()\endlink.
+     */
+    class EncodedImage
+    {
+    public:
+        /**
+         * @brief Constructor
+         * 
+         * @param buffer Encoded image data. The data are copied.
+         * @throws OFIQError with ReturnCode::ImageReadingError if the data cannot be decoded.
+         */
+        explicit EncodedImage(const std::vector<unsigned char>& buffer);
+
+        /**
+         * @brief Returns true if regions of the image are decoded on demand.
+         * 
+         * @return true The image is decoded on demand.
+         * @return false The image has been decoded completely.
+         */
+        bool SupportsRegionDecoding() const { return m_regionDecoding; }
+
+        /**
+         * @brief Access the full resolution image.
+         * @details If region decoding is supported, only the pixels of the regions decoded so far are valid.
+         * 
+         * @return const OFIQ::Image& Full resolution image.
+         */
+        const OFIQ::Image& image() const { return m_image; }
+
+        /**
+         * @brief Decodes a down-scaled version of the image using DCT domain scaling.
+         * @details The largest scaling denominator out of 8, 4 and 2 is used for which the
+         * shorter side of the down-scaled image is not smaller than minimalSize. Each pixel of
+         * the down-scaled image corresponds to scaleDenominator x scaleDenominator pixels of the
+         * full resolution image. If region decoding is not supported, the full resolution image
+         * is returned with a scaling denominator of 1.
+         * 
+         * @param minimalSize Minimal length of the shorter side of the down-scaled image.
+         * @param scaleDenominator Scaling denominator used.
+         * @return OFIQ::Image Down-scaled image.
+         */
+        OFIQ::Image DecodeThumbnail(int minimalSize, int& scaleDenominator) const;
+
+        /**
+         * @brief Decodes a region of the full resolution image into \link OFIQ_LIB::EncodedImage::image() image()\endlink.
+         * @details The region is clipped to the image. Regions which have already been decoded are not decoded again.
+         * If region decoding is not supported, nothing is done.
+         * 
+         * @param region Region to be decoded.
+         */
+        void DecodeRegion(const OFIQ::BoundingBox& region);
+
+    private:
+        /**
+         * @brief Copy of the encoded data.
+         */
+        std::vector<unsigned char> m_buffer;
+
+        /**
+         * @brief Flag indicating if regions are decoded on demand.
+         */
+        bool m_regionDecoding = false;
+
+        /**
+         * @brief Full resolution image, see \link OFIQ_LIB::EncodedImage::image() image()\endlink.
+         */
+        OFIQ::Image m_image;
+
+        /**
+         * @brief Regions which have been decoded so far, stored as (xleft, ytop, width, height).
+         */
+        std::vector<OFIQ::BoundingBox> m_decodedRegions;
+    };
+}
+
+#endif /* OFIQ_LIB_ENCODED_IMAGE_H */
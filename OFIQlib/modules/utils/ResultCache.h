@@ -0,0 +1,174 @@
+/**
+ * @file ResultCache.h
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief Provides a cache of quality assessments keyed by a hash of the image content.
+ * @author OFIQ development team
+ */
+#ifndef OFIQ_LIB_RESULT_CACHE_H
+#define OFIQ_LIB_RESULT_CACHE_H
+
+#include "ofiq_lib.h"
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+ /**
+  * Namespace for OFIQ implementations.
+  */
+namespace OFIQ_LIB
+{
+    /**
+     * @brief Bounded cache of quality assessments.
+     * @details Assessments are stored under a 64 bit key computed by
+     * \link OFIQ_LIB::ResultCache::HashImage() HashImage()\endlink or
+     * \link OFIQ_LIB::ResultCache::HashBytes() HashBytes()\endlink, seeded with a
+     * fingerprint of the configuration. If the capacity is exceeded, the least recently
+     * used assessment is removed. All methods are thread-safe. If a persistence file is
+     * given, the cache is loaded from it on construction and written back on destruction;
+     * a file written for another configuration fingerprint is ignored. Several caches, also
+     * of different processes, may share a persistence file: writing it is serialized by a lock
+     * file next to it and merges the entries of the file with the entries of the cache.
+     */
+    class ResultCache
+    {
+    public:
+        /**
+         * @brief Constructor
+         * 
+         * @param capacity Maximal number of cached assessments.
+         * @param configFingerprint Fingerprint of the configuration the assessments are computed with.
+         * @param persistencePath Path of the file the cache is persisted to. An empty path disables the persistence.
+         */
+        ResultCache(size_t capacity, uint64_t configFingerprint, const std::string& persistencePath = "");
+
+        /**
+         * @brief Destructor. Writes the cache to the persistence file, if any.
+         * 
+         */
+        ~ResultCache();
+
+        ResultCache(const ResultCache&) = delete;
+        ResultCache& operator=(const ResultCache&) = delete;
+
+        /**
+         * @brief Computes the 64 bit xxHash (XXH64) of a byte array.
+         * 
+         * @param data Pointer to the data.
+         * @param length Number of bytes.
+         * @param seed Seed of the hash.
+         * @return uint64_t Hash value.
+         */
+        static uint64_t HashBytes(const void* data, size_t length, uint64_t seed = 0);
+
+        /**
+         * @brief Computes the 64 bit xxHash (XXH64) of the image dimensions, the pixel format and the pixels.
+         * @details Only the pixels of each row are hashed, i.e. the padding bytes of images
+         * with a row stride are ignored.
+         * 
+         * @param image Image to be hashed.
+         * @param seed Seed of the hash.
+         * @return uint64_t Hash value.
+         */
+        static uint64_t HashImage(const OFIQ::Image& image, uint64_t seed = 0);
+
+        /**
+         * @brief Fingerprint of the configuration the cache has been created for.
+         * 
+         * @return uint64_t Fingerprint.
+         */
+        uint64_t GetConfigFingerprint() const { return m_configFingerprint; }
+
+        /**
+         * @brief Looks up an assessment and marks it as most recently used.
+         * 
+         * @param[in] key Key of the assessment.
+         * @param[out] assessment Cached assessment, unchanged if the key is not found.
+         * @return true if the key has been found.
+         * @return false otherwise.
+         */
+        bool Lookup(uint64_t key, OFIQ::FaceImageQualityAssessment& assessment);
+
+        /**
+         * @brief Inserts or replaces an assessment.
+         * 
+         * @param key Key of the assessment.
+         * @param assessment Assessment to be cached.
+         */
+        void Insert(uint64_t key, const OFIQ::FaceImageQualityAssessment& assessment);
+
+        /**
+         * @brief Writes the cache to the persistence file. Nothing is done if the persistence is disabled.
+         * @details Entries of the file which are not in this cache, e.g. written by another cache,
+         * are kept as less recently used, up to the capacity of this cache.
+         * @throws OFIQError with ReturnCode::UnknownError if the file cannot be written.
+         */
+        void Save() const;
+
+    private:
+        /**
+         * @brief Reads the cache from the persistence file if it exists and matches the configuration fingerprint.
+         */
+        void Load();
+
+        /**
+         * @brief Type of the list of key/assessment pairs ordered from most to least recently used.
+         */
+        using EntryList = std::list<std::pair<uint64_t, OFIQ::FaceImageQualityAssessment>>;
+
+        /**
+         * @brief Maximal number of cached assessments.
+         */
+        size_t m_capacity;
+
+        /**
+         * @brief Fingerprint of the configuration.
+         */
+        uint64_t m_configFingerprint;
+
+        /**
+         * @brief Path of the persistence file, empty if the persistence is disabled.
+         */
+        std::string m_persistencePath;
+
+        /**
+         * @brief Cached assessments ordered from most to least recently used.
+         */
+        EntryList m_entries;
+
+        /**
+         * @brief Index of the cached assessments.
+         */
+        std::unordered_map<uint64_t, EntryList::iterator> m_index;
+
+        /**
+         * @brief Mutex guarding the entries.
+         */
+        mutable std::mutex m_mutex;
+    };
+}
+
+#endif /* OFIQ_LIB_RESULT_CACHE_H */
@@ -28,6 +28,11 @@
 #pragma once
 
 #include "ofiq_lib.h"
+#include "BitMask.h"
+#include "ClassHistogram.h"
+#include <cstdint>
+#include <functional>
+#include <optional>
 #include <opencv2/opencv.hpp>
 
 /**
@@ -161,6 +166,8 @@ namespace OFIQ_LIB
         
         /**
          * @brief Set the Aligned Face 
+         * @details The aligned face is either a BGR image or, for gray scale input processed
+         * on the gray scale fast path, a single channel image.
          * 
          * @param i_alignedFace 
          */
@@ -168,11 +175,45 @@ namespace OFIQ_LIB
         
         /**
          * @brief Get the Aligned Face object
+         * @details Always a BGR image. A single channel aligned face is replicated to three channels.
          * 
          * @return cv::Mat 
          */
         cv::Mat getAlignedFace() const;
 
+        /**
+         * @brief Get the Aligned Face object with the channels it has been stored with,
+         * i.e. a single channel image if \link OFIQ_LIB::Session::isGrayScale() isGrayScale()\endlink
+         * returns true and a BGR image otherwise.
+         * 
+         * @return cv::Mat 
+         */
+        cv::Mat getAlignedFaceNative() const;
+
+        /**
+         * @brief Get a region of the Aligned Face object with the channels it has been stored with,
+         * without copying the remaining pixels.
+         * 
+         * @param i_region Region of the aligned face; must be inside the aligned face.
+         * @return cv::Mat Copy of the pixels of the region.
+         */
+        cv::Mat getAlignedFaceRegion(const cv::Rect& i_region) const;
+
+        /**
+         * @brief Get the size of the Aligned Face object.
+         * 
+         * @return cv::Size Size of the aligned face.
+         */
+        cv::Size getAlignedFaceSize() const;
+
+        /**
+         * @brief Checks whether the aligned face is kept as single channel gray scale image.
+         * 
+         * @return true if the aligned face is a single channel image.
+         * @return false otherwise.
+         */
+        bool isGrayScale() const;
+
         /**
          * @brief Set the Aligned Face Landmarked Region
          * 
@@ -187,6 +228,14 @@ namespace OFIQ_LIB
          */
         cv::Mat getAlignedFaceLandmarkedRegion() const;
 
+        /**
+         * @brief Get the Aligned Face Landmarked Region as bit mask.
+         * @details The bit mask is packed on the first call after the region has been set.
+         * 
+         * @return const BitMask& Pixels of the landmarked region.
+         */
+        const BitMask& getAlignedFaceLandmarkedRegionBitMask() const;
+
         /**
          * @brief Set the Face Parsing Image, see \link OFIQ_LIB::modules::segmentations::FaceParsing \endlink).
          * 
@@ -201,6 +250,14 @@ namespace OFIQ_LIB
          */
         cv::Mat getFaceParsingImage() const;
 
+        /**
+         * @brief Get the pixel counts and masks of the classes of the Face Parsing Image.
+         * @details The histogram is computed on the first call after the face parsing image has been set.
+         * 
+         * @return const ClassHistogram& Class histogram of the face parsing image.
+         */
+        const ClassHistogram& getFaceParsingClassHistogram() const;
+
         /**
          * @brief Set the Face Occlusion Segmentation Image, see \link OFIQ_LIB::modules::segmentations::FaceOcclusionSegmentation \endlink)
          * 
@@ -215,7 +272,146 @@ namespace OFIQ_LIB
          */
         cv::Mat getFaceOcclusionSegmentationImage() const;
 
+        /**
+         * @brief Get the Face Occlusion Segmentation Image as bit mask, see \link OFIQ_LIB::modules::segmentations::FaceOcclusionSegmentation \endlink)
+         * @details The bit mask is packed on the first call after the segmentation image has been set.
+         * 
+         * @return const BitMask& Pixels of the face which are not occluded.
+         */
+        const BitMask& getFaceOcclusionSegmentationBitMask() const;
+
+        /**
+         * @brief Set a down-scaled version of the input image used for the face detection.
+         * @details Each pixel of the detection image corresponds to scaleDenominator x scaleDenominator
+         * pixels of the input image.
+         * 
+         * @param i_detectionImage Down-scaled input image.
+         * @param i_scaleDenominator Scaling denominator of the detection image.
+         */
+        void setDetectionImage(const OFIQ::Image& i_detectionImage, int i_scaleDenominator);
+
+        /**
+         * @brief Check if a detection image has been set, see \link OFIQ_LIB::Session::setDetectionImage() setDetectionImage()\endlink.
+         * 
+         * @return true if a detection image is available.
+         */
+        bool hasDetectionImage() const;
+
+        /**
+         * @brief Get the detection image, see \link OFIQ_LIB::Session::setDetectionImage() setDetectionImage()\endlink.
+         * 
+         * @return const OFIQ::Image& Down-scaled input image.
+         */
+        const OFIQ::Image& getDetectionImage() const;
+
+        /**
+         * @brief Get the scaling denominator of the detection image.
+         * 
+         * @return int Scaling denominator.
+         */
+        int getDetectionImageScaleDenominator() const;
+
+        /**
+         * @brief Set the function loading regions of the input image.
+         * @details If the input image is decoded on demand, the loader is called by \link
+         * OFIQ_LIB::Session::requireImageRegion() requireImageRegion()\endlink.
+         * 
+         * @param i_regionLoader Function decoding the passed region of the input image.
+         */
+        void setImageRegionLoader(const std::function<void(const OFIQ::BoundingBox&)>& i_regionLoader);
+
+        /**
+         * @brief Ensure that the pixels of a region of the input image are available.
+         * @details Nothing is done if the input image has been decoded completely.
+         * 
+         * @param i_region Region of the input image which is accessed subsequently.
+         */
+        void requireImageRegion(const OFIQ::BoundingBox& i_region);
+
+        /**
+         * @brief Serialize the pre-processing results of this session.
+         * @details The serialized data comprise the detected faces, the pose, the landmarks, the aligned
+         * face landmarks, the alignment transformation matrix, the face parsing image, the face occlusion
+         * segmentation image, the aligned face landmarked region and a reference to the input image,
+         * e.g. its path. The input image itself is not serialized.
+         * 
+         * The data start with a header and a table of sections. Each section starts at an offset aligned
+         * to 64 bytes and the pixels of each matrix start 64 bytes after its section, such that the
+         * matrices can be used in place by \link OFIQ_LIB::Session::deserialize() deserialize()\endlink,
+         * e.g. from a memory mapped file or a receive buffer.
+         * 
+         * @param i_imageReference Reference to the input image stored along the results.
+         * @param i_includeAlignedFace If true, the aligned face is serialized as well. Otherwise it has to be
+         * recomputed from the input image and the transformation matrix after deserialization.
+         * @return std::vector<uint8_t> Serialized pre-processing results.
+         */
+        std::vector<uint8_t> serialize(const std::string& i_imageReference = "", bool i_includeAlignedFace = false) const;
+
+        /**
+         * @brief Restore the pre-processing results serialized by \link OFIQ_LIB::Session::serialize() serialize()\endlink.
+         * @details The bounding box of the assessment is set to the first detected face.
+         * 
+         * @param i_data Pointer to the serialized data.
+         * @param i_size Number of bytes of the serialized data.
+         * @param i_copyData If false, the matrices of the session refer to the serialized data, which must
+         * then outlive the session.
+         * @throws OFIQError with ReturnCode::UnknownError if the data are invalid, e.g. truncated or holding
+         * matrices of unexpected types or sizes, or have been computed for an input image of a different size.
+         */
+        void deserialize(const uint8_t* i_data, size_t i_size, bool i_copyData = true);
+
+        /**
+         * @brief Read the reference to the input image from serialized pre-processing results
+         * without restoring them, e.g. to load the input image before creating the session.
+         * 
+         * @param i_data Pointer to the serialized data.
+         * @param i_size Number of bytes of the serialized data.
+         * @return std::string Reference passed to \link OFIQ_LIB::Session::serialize() serialize()\endlink.
+         * @throws OFIQError with ReturnCode::UnknownError if the data are invalid.
+         */
+        static std::string readImageReference(const uint8_t* i_data, size_t i_size);
+
+        /**
+         * @brief Check if the aligned face has been set.
+         * 
+         * @return true if an aligned face is available.
+         */
+        bool hasAlignedFace() const;
+
+        /**
+         * @brief Get a face mask of this session, computing it only if it has not been requested before.
+         * @details The masks are memoized by the landmarks, the forehead extension alpha and the size of
+         * the mask, such that the measures and the pre-processing share the masks computed for the same
+         * arguments. The returned matrix shares its pixels with the memoized mask and must not be modified.
+         * 
+         * @param i_landmarks Landmarks the mask is computed from.
+         * @param i_height Number of rows of the mask.
+         * @param i_width Number of columns of the mask.
+         * @param i_alpha Extension of the face region at the forehead.
+         * @param i_createMask Function computing the mask if no memoized mask matches the arguments.
+         * @return cv::Mat Face mask.
+         */
+        cv::Mat getFaceMask(
+            const OFIQ::FaceLandmarks& i_landmarks,
+            int i_height,
+            int i_width,
+            float i_alpha,
+            const std::function<cv::Mat()>& i_createMask) const;
+
     private:
+        /**
+         * @brief Memoized face mask and the arguments it has been computed for.
+         * 
+         */
+        struct FaceMaskEntry
+        {
+            OFIQ::FaceLandmarks landmarks;
+            int height;
+            int width;
+            float alpha;
+            cv::Mat mask;
+        };
+
         /**
          * @brief Reference to the input image, connected to this session.
          * 
@@ -275,12 +471,44 @@ namespace OFIQ_LIB
          */
         cv::Mat m_faceParsingImage;
 
+        /**
+         * @brief Class histogram of the face parsing image, computed on demand.
+         * 
+         */
+        mutable std::optional<ClassHistogram> m_faceParsingClassHistogram;
+
         /**
          * @brief Container for storing the result of the face occlusion segmented image.
          * 
          */
         cv::Mat m_faceOcclusionSegmentationImage;
 
+        /**
+         * @brief Bit masks packed from the aligned face landmarked region and the face occlusion
+         * segmentation image on demand.
+         * 
+         */
+        mutable std::optional<BitMask> m_alignedFaceLandmarkedRegionBitMask;
+        mutable std::optional<BitMask> m_faceOcclusionSegmentationBitMask;
+
+        /**
+         * @brief Container for storing the down-scaled image used for the face detection.
+         * 
+         */
+        OFIQ::Image m_detectionImage;
+
+        /**
+         * @brief Scaling denominator of the detection image.
+         * 
+         */
+        int m_detectionImageScaleDenominator = 1;
+
+        /**
+         * @brief Function loading regions of the input image if it is decoded on demand.
+         * 
+         */
+        std::function<void(const OFIQ::BoundingBox&)> m_imageRegionLoader;
+
         /**
          * @brief Method for generating uuid's for the session.
          * 
@@ -293,5 +521,11 @@ namespace OFIQ_LIB
          * 
          */
         std::string m_id;
+
+        /**
+         * @brief Face masks computed by \link OFIQ_LIB::Session::getFaceMask() getFaceMask()\endlink.
+         * 
+         */
+        mutable std::vector<FaceMaskEntry> m_faceMasks;
     };
 }
\ No newline at end of file
@@ -0,0 +1,246 @@
+/**
+ * @file SharedMemoryRing.h
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief Provides a ring of image slots in shared memory for co-located capture applications.
+ * @author OFIQ development team
+ */
+#ifndef OFIQ_LIB_SHARED_MEMORY_RING_H
+#define OFIQ_LIB_SHARED_MEMORY_RING_H
+
+#include "ofiq_lib.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+ /**
+  * Namespace for OFIQ implementations.
+  */
+namespace OFIQ_LIB
+{
+    /**
+     * @brief Header of a frame slot of a \link OFIQ_LIB::SharedMemoryRing SharedMemoryRing\endlink.
+     * @details The pixels follow at offset \link OFIQ_LIB::SharedMemoryFrame::pixelOffset pixelOffset\endlink
+     * of the slot, see \link OFIQ::Image::borrow() Image::borrow()\endlink for the pixel layout.
+     */
+    struct SharedMemoryFrame
+    {
+        /**
+         * @brief Offset of the pixels within a slot.
+         */
+        static constexpr size_t pixelOffset = 64;
+
+        /**
+         * @brief Number chosen by the producer to match the result to the frame.
+         */
+        uint64_t sequence;
+
+        /**
+         * @brief Width and height of the image in pixels.
+         */
+        uint16_t width;
+        uint16_t height;
+
+        /**
+         * @brief Pixel format, value of \link OFIQ::PixelFormat PixelFormat\endlink.
+         */
+        uint32_t pixelFormat;
+
+        /**
+         * @brief Number of bytes between the beginnings of two consecutive rows, 0 for tightly packed rows.
+         */
+        uint64_t stride;
+    };
+
+    /**
+     * @brief Score of a single measure within a \link OFIQ_LIB::SharedMemoryResult SharedMemoryResult\endlink.
+     */
+    struct SharedMemoryMeasureResult
+    {
+        int32_t measure;
+        int32_t code;
+        double rawScore;
+        double scalar;
+    };
+
+    /**
+     * @brief Layout of a result slot of a \link OFIQ_LIB::SharedMemoryRing SharedMemoryRing\endlink.
+     */
+    struct SharedMemoryResult
+    {
+        /**
+         * @brief Maximal number of measure results per slot.
+         */
+        static constexpr uint32_t maxMeasures = 64;
+
+        /**
+         * @brief Sequence number of the assessed frame.
+         */
+        uint64_t sequence;
+
+        /**
+         * @brief Value of \link OFIQ::ReturnCode ReturnCode\endlink of the assessment.
+         */
+        int32_t returnCode;
+
+        /**
+         * @brief Number of valid entries of \link OFIQ_LIB::SharedMemoryResult::measures measures\endlink.
+         */
+        uint32_t numMeasures;
+
+        SharedMemoryMeasureResult measures[maxMeasures];
+    };
+
+    /**
+     * @brief Ring of fixed size slots in POSIX shared memory with a single producer and a single consumer.
+     * @details The producer and the consumer index are atomic counters in the shared memory segment,
+     * thus no lock is taken and the slots are accessed in place. The producer fills the slot returned
+     * by \link OFIQ_LIB::SharedMemoryRing::TryAcquireWrite() TryAcquireWrite()\endlink and publishes it with
+     * \link OFIQ_LIB::SharedMemoryRing::CommitWrite() CommitWrite()\endlink; the consumer reads the slot
+     * returned by \link OFIQ_LIB::SharedMemoryRing::TryAcquireRead() TryAcquireRead()\endlink and returns
+     * it with \link OFIQ_LIB::SharedMemoryRing::ReleaseRead() ReleaseRead()\endlink.
+     * Slots start at offsets aligned to 64 bytes. Not available on Windows.
+     */
+    class OFIQ_EXPORT SharedMemoryRing
+    {
+    public:
+        /**
+         * @brief Creates a new shared memory segment. An existing segment of the same name is replaced.
+         * 
+         * @param name Name of the segment, e.g. "/ofiq_frames".
+         * @param slotCount Number of slots.
+         * @param slotSize Number of bytes of each slot; rounded up to a multiple of 64.
+         * @return std::unique_ptr<SharedMemoryRing> Ring owning the segment; it is removed by the destructor.
+         * @throws OFIQError with ReturnCode::UnknownError if the segment cannot be created.
+         */
+        static std::unique_ptr<SharedMemoryRing> Create(const std::string& name, uint32_t slotCount, uint64_t slotSize);
+
+        /**
+         * @brief Opens a segment created by \link OFIQ_LIB::SharedMemoryRing::Create() Create()\endlink.
+         * 
+         * @param name Name of the segment.
+         * @return std::unique_ptr<SharedMemoryRing> Ring referring to the segment.
+         * @throws OFIQError with ReturnCode::UnknownError if the segment does not exist or is invalid.
+         */
+        static std::unique_ptr<SharedMemoryRing> Open(const std::string& name);
+
+        /**
+         * @brief Destructor. Unmaps the segment and removes it if it has been created by this instance.
+         */
+        ~SharedMemoryRing();
+
+        SharedMemoryRing(const SharedMemoryRing&) = delete;
+        SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+        /**
+         * @brief Returns the number of slots.
+         */
+        uint32_t GetSlotCount() const;
+
+        /**
+         * @brief Returns the number of bytes of a slot.
+         */
+        uint64_t GetSlotSize() const;
+
+        /**
+         * @brief Producer: returns the next free slot.
+         * 
+         * @return uint8_t* Slot to be filled, nullptr if the ring is full.
+         */
+        uint8_t* TryAcquireWrite();
+
+        /**
+         * @brief Producer: publishes the slot returned by the last call of
+         * \link OFIQ_LIB::SharedMemoryRing::TryAcquireWrite() TryAcquireWrite()\endlink.
+         */
+        void CommitWrite();
+
+        /**
+         * @brief Consumer: returns the oldest published slot.
+         * 
+         * @return const uint8_t* Published slot, nullptr if the ring is empty.
+         */
+        const uint8_t* TryAcquireRead();
+
+        /**
+         * @brief Consumer: returns the slot returned by the last call of
+         * \link OFIQ_LIB::SharedMemoryRing::TryAcquireRead() TryAcquireRead()\endlink to the producer.
+         */
+        void ReleaseRead();
+
+        /**
+         * @brief Producer: marks that no further slots will be published.
+         */
+        void Close();
+
+        /**
+         * @brief Checks if the producer has closed the ring.
+         */
+        bool IsClosed() const;
+
+    private:
+        /**
+         * @brief Header at the beginning of the segment.
+         */
+        struct Header;
+
+        SharedMemoryRing(const std::string& name, uint8_t* segment, size_t segmentSize, bool isOwner);
+
+        uint8_t* Slot(uint64_t index) const;
+
+        std::string m_name;
+        uint8_t* m_segment;
+        size_t m_segmentSize;
+        bool m_isOwner;
+        Header* m_header;
+    };
+
+    /**
+     * @brief Wraps the frame of a slot as image without copying the pixels.
+     * 
+     * @param slot Slot of a frame ring.
+     * @param slotSize Number of bytes of the slot.
+     * @param sequence Sequence number of the frame.
+     * @return OFIQ::Image Image referring to the pixels within the slot.
+     * @throws OFIQError with ReturnCode::ImageReadingError if the frame does not fit into the slot.
+     */
+    OFIQ_EXPORT OFIQ::Image wrapSharedMemoryFrame(const uint8_t* slot, uint64_t slotSize, uint64_t& sequence);
+
+    /**
+     * @brief Writes the assessment of a frame into a slot of a result ring.
+     * @details Measures beyond \link OFIQ_LIB::SharedMemoryResult::maxMeasures maxMeasures\endlink are omitted.
+     * 
+     * @param slot Slot of a result ring with at least sizeof(SharedMemoryResult) bytes.
+     * @param sequence Sequence number of the assessed frame.
+     * @param status Return status of the assessment.
+     * @param assessments Assessment of the frame.
+     */
+    OFIQ_EXPORT void writeSharedMemoryResult(
+        uint8_t* slot,
+        uint64_t sequence,
+        const OFIQ::ReturnStatus& status,
+        const OFIQ::FaceImageQualityAssessment& assessments);
+}
+
+#endif /* OFIQ_LIB_SHARED_MEMORY_RING_H */
@@ -0,0 +1,134 @@
+/**
+ * @file TreeEnsemble.h
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @brief Provides a flattened evaluator for the tree ensembles of OpenCV.
+ * @author OFIQ development team
+ */
+#ifndef OFIQ_LIB_TREE_ENSEMBLE_H
+#define OFIQ_LIB_TREE_ENSEMBLE_H
+
+#include "ofiq_lib.h"
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/ml.hpp>
+
+ /**
+  * Namespace for OFIQ implementations.
+  */
+namespace OFIQ_LIB
+{
+    /**
+     * @brief Evaluates the trees of a cv::ml::DTrees model, e.g. cv::ml::RTrees or cv::ml::Boost,
+     * from a flattened node layout.
+     * @details The internal nodes of all trees are stored as arrays of variable indices, thresholds
+     * and child pairs; leaves are referenced by negative indices into an array of leaf values.
+     * A sample descends a tree without calling into OpenCV and without allocations.
+     * The result equals cv::ml::DTrees::predict() with cv::ml::DTrees::PREDICT_SUM, i.e. the sum of the
+     * leaf values reached in all trees. Inversed splits are supported, categorical splits are not;
+     * use IsSupported() before and MatchesModel() after flattening a model and fall back to
+     * cv::ml::DTrees::predict() otherwise.
+     */
+    class OFIQ_EXPORT TreeEnsemble
+    {
+    public:
+        /**
+         * @brief Constructor flattening the trees of a trained model.
+         * 
+         * @param model Trained model.
+         * @throws OFIQError if the model has categorical splits.
+         */
+        explicit TreeEnsemble(const cv::ml::DTrees& model);
+
+        /**
+         * @brief Checks whether a model can be flattened, i.e. has no categorical splits.
+         * 
+         * @param model Trained model.
+         * @return true if the model only splits on ordered variables.
+         */
+        static bool IsSupported(const cv::ml::DTrees& model);
+
+        /**
+         * @brief Computes the sum of the leaf values of all trees.
+         * 
+         * @param sample Features of the sample, GetVarCount() values. Missing values
+         * (cv::ml::TrainData::missingValue()) are not supported.
+         * @return float Sum accumulated in double precision and rounded to float as by OpenCV.
+         */
+        float PredictSum(const float* sample) const;
+
+        /**
+         * @brief Compares PredictSum() with the prediction of the model on samples whose features
+         * are drawn from the thresholds of the model and their neighbours.
+         * 
+         * @param model Model this ensemble has been created from.
+         * @param flags Flags passed to cv::ml::StatModel::predict(), such that the prediction is a sum.
+         * @param numSamples Number of samples compared.
+         * @return true if all predictions are identical.
+         */
+        bool MatchesModel(const cv::ml::DTrees& model, int flags, int numSamples = 64) const;
+
+        /**
+         * @brief Returns the number of trees.
+         */
+        size_t GetNumTrees() const { return m_roots.size(); }
+
+        /**
+         * @brief Returns the number of features of a sample.
+         */
+        int GetVarCount() const { return m_varCount; }
+
+    private:
+        /**
+         * @brief Flattened node index of each root; negative for a tree that is a single leaf.
+         */
+        std::vector<int32_t> m_roots;
+
+        /**
+         * @brief Variable index of each internal node.
+         */
+        std::vector<int32_t> m_varIdx;
+
+        /**
+         * @brief Threshold of each internal node; a sample descends left if its value is less or equal.
+         */
+        std::vector<float> m_thresholds;
+
+        /**
+         * @brief Left and right child of each internal node, leaves as ~(index of the leaf value).
+         */
+        std::vector<int32_t> m_children;
+
+        /**
+         * @brief Value of each leaf.
+         */
+        std::vector<double> m_leafValues;
+
+        /**
+         * @brief Number of features of a sample.
+         */
+        int m_varCount = 0;
+    };
+}
+
+#endif /* OFIQ_LIB_TREE_ENSEMBLE_H */
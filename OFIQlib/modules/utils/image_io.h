@@ -37,6 +37,8 @@ namespace OFIQ_LIB {
 	/**
 	 * @brief Read image from disk.
 	 * 
+	 * @details The image references the decoded pixel data in BGR order without copying them.
+	 * 
 	 * @param[in] filename Path and file name of the image being read from disk.
 	 * @param[out] image Reference to the image object where the data is loaded to.
 	 * @return OFIQ::ReturnStatus
@@ -46,6 +48,7 @@ namespace OFIQ_LIB {
 
     /**
 	 * @brief Read image from byte array.
+	 * @details The image references the decoded pixel data in BGR order without copying them.
 	 *
 	 * @param[in] buffer Data as byte array of the image being read.
 	 * @param[out] image Reference to the image object where the data is loaded to.
@@ -64,6 +64,17 @@ namespace OFIQ_LIB {
 	 */
 	OFIQ_EXPORT void ConvertBGRToCIELAB(const cv::Mat& bgrImage, double& a, double& b);
 
+	/**
+	 * @brief Computes CIELAB values \f$a^*\f$ and \f$b^*\f$ from the mean BGR values of an image,
+	 * as \link OFIQ_LIB::ConvertBGRToCIELAB() ConvertBGRToCIELAB()\endlink does for the means of its channels.
+	 * @param[in] meanB Mean of the blue channel, between 0 and 255
+	 * @param[in] meanG Mean of the green channel, between 0 and 255
+	 * @param[in] meanR Mean of the red channel, between 0 and 255
+	 * @param[out] a CIELAB value \f$a^*\f$
+	 * @param[out] b CIELAB value \f$b^*\f$
+	 */
+	OFIQ_EXPORT void ConvertMeanBGRToCIELAB(double meanB, double meanG, double meanR, double& a, double& b);
+
 	/**
 	 * @brief Converts a BGR image to the luminance image.
 	 * @details The conversion is specified in the ISO/IEC 29794-5 standard
@@ -73,6 +84,16 @@ namespace OFIQ_LIB {
 	 */
 	OFIQ_EXPORT cv::Mat GetLuminanceImageFromBGR(const cv::Mat& bgrImage );
 
+	/**
+	 * @brief Converts a BGR or a single channel gray scale image to the luminance image.
+	 * @details BGR images are converted with \link OFIQ_LIB::GetLuminanceImageFromBGR()
+	 * GetLuminanceImageFromBGR() \endlink. A gray value v is treated as the BGR pixel (v,v,v),
+	 * such that the luminance is read from a table of 256 precomputed values.
+	 * @param image BGR image or gray scale image
+	 * @return Luminance image.
+	 */
+	OFIQ_EXPORT cv::Mat GetLuminanceImage(const cv::Mat& image);
+
 	/**
 	 * @brief Computes the left eye center, the right eye center, the (planar) inter-eye-distance
 	 * and the eye to mouth distance from facial landmarks.
@@ -0,0 +1,252 @@
+/**
+ * @file ArtifactStore.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "ArtifactStore.h"
+#include "OFIQError.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#    define WIN32_LEAN_AND_MEAN
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+using namespace OFIQ;
+
+namespace OFIQ_LIB
+{
+    namespace
+    {
+        /**
+         * @brief Magic number and version at the beginning and the end of a store file.
+         */
+        const char storeMagic[8] = { 'O', 'F', 'I', 'Q', 'A', 'S', '0', '1' };
+
+        /**
+         * @brief Alignment of the records within a store file.
+         */
+        const uint64_t recordAlignment = 64;
+    }
+
+    ArtifactStoreWriter::ArtifactStoreWriter(const std::string& path)
+        : m_stream(path, std::ios::binary | std::ios::trunc)
+    {
+        if (!m_stream)
+            throw OFIQError(ReturnCode::UnknownError, "Cannot create artifact store " + path);
+        m_stream.write(storeMagic, sizeof(storeMagic));
+        m_offset = sizeof(storeMagic);
+    }
+
+    ArtifactStoreWriter::~ArtifactStoreWriter()
+    {
+        try
+        {
+            Close();
+        }
+        catch (const OFIQError&)
+        {
+            // destructors must not throw, call Close() explicitly to handle errors
+        }
+    }
+
+    void ArtifactStoreWriter::Add(const std::string& key, const std::vector<uint8_t>& data)
+    {
+        if (!m_stream.is_open())
+            throw OFIQError(ReturnCode::UnknownError, "Artifact store has been closed");
+
+        static const char padding[recordAlignment] = {};
+        uint64_t alignedOffset = (m_offset + recordAlignment - 1) & ~(recordAlignment - 1);
+        m_stream.write(padding, static_cast<std::streamsize>(alignedOffset - m_offset));
+        m_stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!m_stream)
+            throw OFIQError(ReturnCode::UnknownError, "Cannot write artifact store");
+
+        m_index.emplace_back(key, std::make_pair(alignedOffset, static_cast<uint64_t>(data.size())));
+        m_offset = alignedOffset + data.size();
+    }
+
+    void ArtifactStoreWriter::Close()
+    {
+        if (!m_stream.is_open())
+            return;
+
+        // index: (offset, size, key length, key) per record, followed by the index offset, the number of records and the magic number
+        uint64_t indexOffset = m_offset;
+        for (const auto& [key, record] : m_index)
+        {
+            auto keyLength = static_cast<uint64_t>(key.size());
+            m_stream.write(reinterpret_cast<const char*>(&record.first), sizeof(uint64_t));
+            m_stream.write(reinterpret_cast<const char*>(&record.second), sizeof(uint64_t));
+            m_stream.write(reinterpret_cast<const char*>(&keyLength), sizeof(uint64_t));
+            m_stream.write(key.data(), static_cast<std::streamsize>(key.size()));
+        }
+        auto numRecords = static_cast<uint64_t>(m_index.size());
+        m_stream.write(reinterpret_cast<const char*>(&indexOffset), sizeof(uint64_t));
+        m_stream.write(reinterpret_cast<const char*>(&numRecords), sizeof(uint64_t));
+        m_stream.write(storeMagic, sizeof(storeMagic));
+        m_stream.close();
+        if (!m_stream)
+            throw OFIQError(ReturnCode::UnknownError, "Cannot write artifact store");
+    }
+
+    ArtifactStoreReader::ArtifactStoreReader(const std::string& path)
+    {
+        Map(path);
+
+        auto invalid = [this, &path]()
+        {
+            Unmap();
+            return OFIQError(ReturnCode::UnknownError, "Invalid artifact store " + path);
+        };
+
+        const size_t footerSize = 2 * sizeof(uint64_t) + sizeof(storeMagic);
+        if (m_size < sizeof(storeMagic) + footerSize ||
+            std::memcmp(m_data, storeMagic, sizeof(storeMagic)) != 0 ||
+            std::memcmp(m_data + m_size - sizeof(storeMagic), storeMagic, sizeof(storeMagic)) != 0)
+            throw invalid();
+
+        uint64_t indexOffset;
+        uint64_t numRecords;
+        std::memcpy(&indexOffset, m_data + m_size - footerSize, sizeof(uint64_t));
+        std::memcpy(&numRecords, m_data + m_size - footerSize + sizeof(uint64_t), sizeof(uint64_t));
+
+        uint64_t indexEnd = m_size - footerSize;
+        uint64_t position = indexOffset;
+        for (uint64_t i = 0; i < numRecords; i++)
+        {
+            if (position > indexEnd || indexEnd - position < 3 * sizeof(uint64_t))
+                throw invalid();
+            uint64_t fields[3];
+            std::memcpy(fields, m_data + position, sizeof(fields));
+            position += sizeof(fields);
+            auto [offset, size, keyLength] = fields;
+            if (indexEnd - position < keyLength || offset > indexOffset || indexOffset - offset < size)
+                throw invalid();
+
+            std::string key(reinterpret_cast<const char*>(m_data + position), keyLength);
+            position += keyLength;
+            if (m_index.find(key) == m_index.end())
+                m_keys.push_back(key);
+            m_index[key] = { offset, size };
+        }
+    }
+
+    ArtifactStoreReader::~ArtifactStoreReader()
+    {
+        Unmap();
+    }
+
+    bool ArtifactStoreReader::Find(const std::string& key, const uint8_t*& data, size_t& size) const
+    {
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+            return false;
+        data = m_data + it->second.first;
+        size = static_cast<size_t>(it->second.second);
+        return true;
+    }
+
+    std::vector<std::string> ArtifactStoreReader::GetKeys() const
+    {
+        return m_keys;
+    }
+
+#ifdef _WIN32
+    void ArtifactStoreReader::Map(const std::string& path)
+    {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw OFIQError(ReturnCode::UnknownError, "Cannot open artifact store " + path);
+
+        LARGE_INTEGER fileSize;
+        HANDLE mapping = nullptr;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 ||
+            (mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) == nullptr)
+        {
+            CloseHandle(file);
+            throw OFIQError(ReturnCode::UnknownError, "Cannot map artifact store " + path);
+        }
+
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (m_data == nullptr)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            throw OFIQError(ReturnCode::UnknownError, "Cannot map artifact store " + path);
+        }
+        m_size = static_cast<size_t>(fileSize.QuadPart);
+        m_fileHandle = file;
+        m_mappingHandle = mapping;
+    }
+
+    void ArtifactStoreReader::Unmap()
+    {
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mappingHandle)
+            CloseHandle(m_mappingHandle);
+        if (m_fileHandle)
+            CloseHandle(m_fileHandle);
+        m_data = nullptr;
+        m_mappingHandle = nullptr;
+        m_fileHandle = nullptr;
+        m_size = 0;
+    }
+#else
+    void ArtifactStoreReader::Map(const std::string& path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw OFIQError(ReturnCode::UnknownError, "Cannot open artifact store " + path);
+
+        struct stat fileStat;
+        void* mapping = MAP_FAILED;
+        if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+            mapping = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        // the mapping stays valid after closing the file descriptor
+        close(fd);
+        if (mapping == MAP_FAILED)
+            throw OFIQError(ReturnCode::UnknownError, "Cannot map artifact store " + path);
+
+        m_data = static_cast<const uint8_t*>(mapping);
+        m_size = static_cast<size_t>(fileStat.st_size);
+    }
+
+    void ArtifactStoreReader::Unmap()
+    {
+        if (m_data)
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+#endif
+}
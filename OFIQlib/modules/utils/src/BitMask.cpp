@@ -0,0 +1,134 @@
+/**
+ * @file BitMask.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "BitMask.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace OFIQ_LIB
+{
+    namespace
+    {
+        /**
+         * @brief Number of set bits of a word, using the population count instruction if available.
+         */
+        inline int PopCount(uint64_t word)
+        {
+#if defined(_MSC_VER) && defined(_M_X64)
+            return static_cast<int>(__popcnt64(word));
+#elif defined(__GNUC__) || defined(__clang__)
+            return __builtin_popcountll(word);
+#else
+            word = word - ((word >> 1) & 0x5555555555555555ULL);
+            word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+            word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+            return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+#endif
+        }
+
+        /**
+         * @brief Index of the word containing the pixel in column x of the image.
+         */
+        inline int WordIndex(int x)
+        {
+            return x >= 0 ? x / 64 : -((63 - x) / 64);
+        }
+    }
+
+    BitMask::BitMask(const cv::Mat& mask, const cv::Point& origin)
+        : m_region(origin, mask.size())
+    {
+        if (m_region.empty())
+            return;
+        CV_Assert(mask.type() == CV_8UC1);
+
+        m_firstWord = WordIndex(m_region.x);
+        m_wordsPerRow = WordIndex(m_region.x + m_region.width - 1) - m_firstWord + 1;
+        m_words.assign(static_cast<size_t>(m_wordsPerRow) * m_region.height, 0);
+
+        const int firstBit = m_region.x - 64 * m_firstWord;
+        for (int y = 0; y < mask.rows; y++)
+        {
+            const uchar* src = mask.ptr<uchar>(y);
+            uint64_t* words = m_words.data() + static_cast<size_t>(y) * m_wordsPerRow;
+            for (int x = 0; x < mask.cols; x++)
+            {
+                const int bit = firstBit + x;
+                words[bit >> 6] |= static_cast<uint64_t>(src[x] != 0) << (bit & 63);
+            }
+        }
+    }
+
+    int64_t BitMask::CountNonZero() const
+    {
+        int64_t count = 0;
+        for (auto word : m_words)
+            count += PopCount(word);
+        return count;
+    }
+
+    cv::Mat BitMask::Unpack(const cv::Rect& region) const
+    {
+        cv::Mat mask = cv::Mat::zeros(region.size(), CV_8UC1);
+        cv::Rect inside = region & m_region;
+        for (int y = inside.y; y < inside.y + inside.height; y++)
+        {
+            const uint64_t* words = m_words.data() + static_cast<size_t>(y - m_region.y) * m_wordsPerRow;
+            uchar* dst = mask.ptr<uchar>(y - region.y);
+            for (int x = inside.x; x < inside.x + inside.width; x++)
+            {
+                const int bit = x - 64 * m_firstWord;
+                dst[x - region.x] = static_cast<uchar>((words[bit >> 6] >> (bit & 63)) & 1);
+            }
+        }
+        return mask;
+    }
+
+    int64_t BitMask::CountNonZeroWithout(const BitMask& other) const
+    {
+        int64_t count = 0;
+        for (int y = 0; y < m_region.height; y++)
+        {
+            const uint64_t* words = m_words.data() + static_cast<size_t>(y) * m_wordsPerRow;
+            const int otherY = m_region.y + y - other.m_region.y;
+            const uint64_t* otherWords = nullptr;
+            if (otherY >= 0 && otherY < other.m_region.height)
+                otherWords = other.m_words.data() + static_cast<size_t>(otherY) * other.m_wordsPerRow;
+
+            for (int w = 0; w < m_wordsPerRow; w++)
+            {
+                uint64_t word = words[w];
+                const int otherW = m_firstWord + w - other.m_firstWord;
+                if (otherWords && otherW >= 0 && otherW < other.m_wordsPerRow)
+                    word &= ~otherWords[otherW];
+                count += PopCount(word);
+            }
+        }
+        return count;
+    }
+}
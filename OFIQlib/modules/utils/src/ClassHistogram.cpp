@@ -0,0 +1,119 @@
+/**
+ * @file ClassHistogram.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "ClassHistogram.h"
+
+#include <algorithm>
+
+namespace OFIQ_LIB
+{
+    static const int numLabels = 256;
+
+    ClassHistogram::ClassHistogram(const cv::Mat& labels)
+        : m_labels(labels)
+    {
+        if (labels.empty())
+            return;
+        CV_Assert(labels.type() == CV_8UC1);
+
+        m_rowPrefixCounts.assign(static_cast<size_t>(labels.rows + 1) * numLabels, 0);
+        for (int r = 0; r < labels.rows; r++)
+        {
+            const uchar* row = labels.ptr<uchar>(r);
+            const int32_t* previous = m_rowPrefixCounts.data() + static_cast<size_t>(r) * numLabels;
+            int32_t* counts = m_rowPrefixCounts.data() + static_cast<size_t>(r + 1) * numLabels;
+            for (int c = 0; c < labels.cols; c++)
+                counts[row[c]]++;
+            for (int label = 0; label < numLabels; label++)
+                counts[label] += previous[label];
+        }
+    }
+
+    cv::Range ClassHistogram::Clip(const cv::Range& range, int size)
+    {
+        if (range == cv::Range::all())
+            return cv::Range(0, size);
+        return cv::Range(std::clamp(range.start, 0, size), std::clamp(range.end, 0, size));
+    }
+
+    int64_t ClassHistogram::Count(uchar label, const cv::Range& rows) const
+    {
+        if (m_labels.empty())
+            return 0;
+        cv::Range clipped = Clip(rows, m_labels.rows);
+        if (clipped.start >= clipped.end)
+            return 0;
+        return static_cast<int64_t>(m_rowPrefixCounts[static_cast<size_t>(clipped.end) * numLabels + label]) -
+            m_rowPrefixCounts[static_cast<size_t>(clipped.start) * numLabels + label];
+    }
+
+    int64_t ClassHistogram::Count(uchar label, const cv::Range& rows, const cv::Range& cols) const
+    {
+        if (m_labels.empty())
+            return 0;
+        cv::Range clippedCols = Clip(cols, m_labels.cols);
+        if (clippedCols.start == 0 && clippedCols.end == m_labels.cols)
+            return Count(label, rows);
+        cv::Range clippedRows = Clip(rows, m_labels.rows);
+        if (clippedRows.start >= clippedRows.end || clippedCols.start >= clippedCols.end)
+            return 0;
+
+        auto& integral = m_integrals[label];
+        if (integral.empty())
+        {
+            integral = cv::Mat::zeros(m_labels.rows + 1, m_labels.cols + 1, CV_32S);
+            for (int r = 0; r < m_labels.rows; r++)
+            {
+                const uchar* row = m_labels.ptr<uchar>(r);
+                const int32_t* above = integral.ptr<int32_t>(r);
+                int32_t* sums = integral.ptr<int32_t>(r + 1);
+                int32_t rowSum = 0;
+                for (int c = 0; c < m_labels.cols; c++)
+                {
+                    rowSum += row[c] == label;
+                    sums[c + 1] = above[c + 1] + rowSum;
+                }
+            }
+        }
+
+        const int32_t* top = integral.ptr<int32_t>(clippedRows.start);
+        const int32_t* bottom = integral.ptr<int32_t>(clippedRows.end);
+        return static_cast<int64_t>(bottom[clippedCols.end]) - bottom[clippedCols.start] -
+            top[clippedCols.end] + top[clippedCols.start];
+    }
+
+    cv::Mat ClassHistogram::GetMask(uchar label) const
+    {
+        auto& mask = m_masks[label];
+        if (mask.empty() && !m_labels.empty())
+        {
+            cv::Mat lookUpTable = cv::Mat::zeros(1, numLabels, CV_8U);
+            lookUpTable.at<uchar>(label) = 255;
+            cv::LUT(m_labels, lookUpTable, mask);
+        }
+        return mask;
+    }
+}
@@ -0,0 +1,297 @@
+/**
+ * @file ColumnarResults.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "ColumnarResults.h"
+#include "OFIQError.h"
+
+#include <cstring>
+#include <limits>
+#include <magic_enum.hpp>
+
+using namespace OFIQ;
+
+namespace OFIQ_LIB
+{
+    namespace
+    {
+        /**
+         * @brief Magic number and version at the beginning and the end of a results file.
+         */
+        const char resultsMagic[8] = { 'O', 'F', 'I', 'Q', 'C', 'R', '0', '1' };
+
+        /**
+         * @brief Alignment of the headers and the columns within a results file.
+         */
+        const uint64_t columnAlignment = 64;
+
+        /**
+         * @brief Size of the name of a measure in the schema including its termination.
+         */
+        const size_t schemaNameSize = 28;
+
+        /**
+         * @brief Number of completed blocks waiting for the writer thread before adding a row blocks.
+         */
+        const size_t maxPendingBlocks = 2;
+
+        /**
+         * @brief Return code of a measure not contained in an assessment.
+         */
+        const int8_t codeNotAssessed = -1;
+    }
+
+    const std::vector<QualityMeasure>& ColumnarResultsWriter::GetMeasures()
+    {
+        static const std::vector<QualityMeasure> measures = []()
+            {
+                std::vector<QualityMeasure> result;
+                for (int id = static_cast<int>(QualityMeasure::UnifiedQualityScore);
+                    id <= static_cast<int>(QualityMeasure::NoHeadCoverings); id++)
+                    result.push_back(static_cast<QualityMeasure>(id));
+                return result;
+            }();
+        return measures;
+    }
+
+    ColumnarResultsWriter::ColumnarResultsWriter(const std::string& path, uint32_t rowsPerBlock)
+        : m_stream(path, std::ios::binary | std::ios::trunc),
+        m_rowsPerBlock(rowsPerBlock > 0 ? rowsPerBlock : 1),
+        m_block(CreateBlock())
+    {
+        if (!m_stream)
+            throw OFIQError(ReturnCode::UnknownError, "Cannot create results file " + path);
+
+        const auto& measures = GetMeasures();
+        auto numMeasures = static_cast<uint32_t>(measures.size());
+        char header[columnAlignment] = {};
+        std::memcpy(header, resultsMagic, sizeof(resultsMagic));
+        std::memcpy(header + 8, &numMeasures, sizeof(numMeasures));
+        std::memcpy(header + 12, &m_rowsPerBlock, sizeof(m_rowsPerBlock));
+        m_stream.write(header, sizeof(header));
+        for (auto measure : measures)
+        {
+            char entry[4 + schemaNameSize] = {};
+            auto id = static_cast<int32_t>(measure);
+            auto name = magic_enum::enum_name(measure);
+            std::memcpy(entry, &id, sizeof(id));
+            std::memcpy(entry + 4, name.data(), std::min(name.size(), schemaNameSize - 1));
+            m_stream.write(entry, sizeof(entry));
+        }
+        m_offset = sizeof(header) + measures.size() * (4 + schemaNameSize);
+
+        m_thread = std::thread(&ColumnarResultsWriter::WriteBlocks, this);
+    }
+
+    ColumnarResultsWriter::~ColumnarResultsWriter()
+    {
+        try
+        {
+            Close();
+        }
+        catch (const OFIQError&)
+        {
+            // destructors must not throw, call Close() explicitly to handle errors
+        }
+    }
+
+    void ColumnarResultsWriter::Add(
+        const std::string& imageReference,
+        const FaceImageQualityAssessment& assessments,
+        int32_t elapsedMs)
+    {
+        if (!m_block)
+            throw OFIQError(ReturnCode::UnknownError, "Results file has been closed");
+        CheckError();
+
+        Block& block = *m_block;
+        block.references += imageReference;
+        block.referenceEnds.push_back(block.references.size());
+        block.elapsedMs.push_back(elapsedMs);
+        const auto& measures = GetMeasures();
+        for (size_t m = 0; m < measures.size(); m++)
+        {
+            auto it = assessments.qAssessments.find(measures[m]);
+            if (it == assessments.qAssessments.end())
+            {
+                block.rawScores[m].push_back(std::numeric_limits<double>::quiet_NaN());
+                block.scalars[m].push_back(std::numeric_limits<double>::quiet_NaN());
+                block.codes[m].push_back(codeNotAssessed);
+            }
+            else
+            {
+                block.rawScores[m].push_back(it->second.rawScore);
+                block.scalars[m].push_back(it->second.scalar);
+                block.codes[m].push_back(static_cast<int8_t>(it->second.code));
+            }
+        }
+
+        if (block.elapsedMs.size() >= m_rowsPerBlock)
+            Flush();
+    }
+
+    void ColumnarResultsWriter::Close()
+    {
+        if (!m_block)
+            return;
+
+        if (!m_block->elapsedMs.empty())
+            Flush();
+        m_block.reset();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closing = true;
+        }
+        m_condition.notify_all();
+        m_thread.join();
+        CheckError();
+
+        // footer: block offsets, number of rows, number of blocks, footer offset and magic number
+        Pad();
+        uint64_t footerOffset = m_offset;
+        auto numBlocks = static_cast<uint64_t>(m_blockOffsets.size());
+        m_stream.write(reinterpret_cast<const char*>(m_blockOffsets.data()),
+            static_cast<std::streamsize>(m_blockOffsets.size() * sizeof(uint64_t)));
+        m_stream.write(reinterpret_cast<const char*>(&m_numRows), sizeof(uint64_t));
+        m_stream.write(reinterpret_cast<const char*>(&numBlocks), sizeof(uint64_t));
+        m_stream.write(reinterpret_cast<const char*>(&footerOffset), sizeof(uint64_t));
+        m_stream.write(resultsMagic, sizeof(resultsMagic));
+        m_stream.close();
+        if (!m_stream)
+            throw OFIQError(ReturnCode::UnknownError, "Cannot write results file");
+    }
+
+    void ColumnarResultsWriter::Flush()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_pending.size() < maxPendingBlocks; });
+            m_pending.push_back(std::move(m_block));
+        }
+        m_condition.notify_all();
+        m_block = CreateBlock();
+    }
+
+    std::unique_ptr<ColumnarResultsWriter::Block> ColumnarResultsWriter::CreateBlock()
+    {
+        auto block = std::make_unique<Block>();
+        const size_t numMeasures = GetMeasures().size();
+        block->rawScores.resize(numMeasures);
+        block->scalars.resize(numMeasures);
+        block->codes.resize(numMeasures);
+        return block;
+    }
+
+    void ColumnarResultsWriter::WriteBlocks()
+    {
+        while (true)
+        {
+            std::unique_ptr<Block> block;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this] { return m_closing || !m_pending.empty(); });
+                if (m_pending.empty())
+                    return;
+                block = std::move(m_pending.front());
+                m_pending.pop_front();
+            }
+            m_condition.notify_all();
+
+            try
+            {
+                // the blocks after a failed one are discarded
+                if (!m_error)
+                    WriteBlock(*block);
+            }
+            catch (const std::exception&)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_error = std::current_exception();
+            }
+        }
+    }
+
+    void ColumnarResultsWriter::WriteBlock(const Block& block)
+    {
+        const uint64_t numRows = block.elapsedMs.size();
+        const size_t numMeasures = GetMeasures().size();
+
+        // column contents in the order of the block header
+        std::vector<std::pair<const char*, uint64_t>> columns;
+        columns.emplace_back(reinterpret_cast<const char*>(block.referenceEnds.data()), numRows * sizeof(uint64_t));
+        columns.emplace_back(block.references.data(), block.references.size());
+        columns.emplace_back(reinterpret_cast<const char*>(block.elapsedMs.data()), numRows * sizeof(int32_t));
+
+        for (size_t m = 0; m < numMeasures; m++)
+        {
+            columns.emplace_back(reinterpret_cast<const char*>(block.rawScores[m].data()), numRows * sizeof(double));
+            columns.emplace_back(reinterpret_cast<const char*>(block.scalars[m].data()), numRows * sizeof(double));
+            columns.emplace_back(reinterpret_cast<const char*>(block.codes[m].data()), numRows * sizeof(int8_t));
+        }
+
+        auto align = [](uint64_t offset) { return (offset + columnAlignment - 1) & ~(columnAlignment - 1); };
+
+        Pad();
+        const uint64_t blockOffset = m_offset;
+        const uint64_t numColumns = columns.size();
+        std::vector<uint64_t> blockHeader = { numRows, numColumns };
+        uint64_t columnOffset = align((2 + numColumns) * sizeof(uint64_t));
+        for (const auto& column : columns)
+        {
+            blockHeader.push_back(columnOffset);
+            columnOffset = align(columnOffset + column.second);
+        }
+
+        m_stream.write(reinterpret_cast<const char*>(blockHeader.data()),
+            static_cast<std::streamsize>(blockHeader.size() * sizeof(uint64_t)));
+        m_offset += blockHeader.size() * sizeof(uint64_t);
+        for (const auto& column : columns)
+        {
+            Pad();
+            m_stream.write(column.first, static_cast<std::streamsize>(column.second));
+            m_offset += column.second;
+        }
+        if (!m_stream)
+            throw OFIQError(ReturnCode::UnknownError, "Cannot write results file");
+
+        m_blockOffsets.push_back(blockOffset);
+        m_numRows += numRows;
+    }
+
+    void ColumnarResultsWriter::Pad()
+    {
+        static const char padding[columnAlignment] = {};
+        uint64_t alignedOffset = (m_offset + columnAlignment - 1) & ~(columnAlignment - 1);
+        m_stream.write(padding, static_cast<std::streamsize>(alignedOffset - m_offset));
+        m_offset = alignedOffset;
+    }
+
+    void ColumnarResultsWriter::CheckError()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_error)
+            std::rethrow_exception(m_error);
+    }
+}
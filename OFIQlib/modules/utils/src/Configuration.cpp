@@ -91,6 +91,19 @@ namespace OFIQ_LIB
         m_dataDir = dataDir;
     }
 
+    std::string Configuration::ToString() const
+    {
+        std::string result;
+        for (const auto& [key, value] : parameters)
+        {
+            result += key;
+            result += '=';
+            result += tao::json::to_string(value);
+            result += '\n';
+        }
+        return result;
+    }
+
     bool Configuration::GetBool(const std::string& key, bool& value) const
     {
         std::map<std::string, tao::json::value, std::less<>>::const_iterator citModel = parameters.find(key);
@@ -0,0 +1,341 @@
+/**
+ * @file EncodedImage.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "EncodedImage.h"
+#include "OFIQError.h"
+#include "image_io.h"
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <jpeglib.h>
+
+using namespace OFIQ;
+
+namespace OFIQ_LIB
+{
+    namespace
+    {
+        /**
+         * @brief Margin in pixels around a requested region which is decoded in addition.
+         * @details Pixels at the borders of a cropped decoding may be affected by the
+         * chroma upsampling, thus only the inner part of the decoded area is used.
+         */
+        const int regionDecodingMargin = 16;
+
+        /**
+         * @brief Error manager of libjpeg returning the control via longjmp instead of terminating the process.
+         */
+        struct JpegErrorManager
+        {
+            jpeg_error_mgr base;
+            std::jmp_buf jumpBuffer;
+            char message[JMSG_LENGTH_MAX];
+        };
+
+        void exitOnJpegError(j_common_ptr cinfo)
+        {
+            auto* errorManager = reinterpret_cast<JpegErrorManager*>(cinfo->err);
+            (*cinfo->err->format_message)(cinfo, errorManager->message);
+            std::longjmp(errorManager->jumpBuffer, 1);
+        }
+
+        void ignoreJpegMessage(j_common_ptr)
+        {
+            // warnings of corrupt data are tolerated as done by OpenCV
+        }
+
+        void setupErrorManager(jpeg_decompress_struct& cinfo, JpegErrorManager& errorManager)
+        {
+            cinfo.err = jpeg_std_error(&errorManager.base);
+            errorManager.base.error_exit = exitOnJpegError;
+            errorManager.base.output_message = ignoreJpegMessage;
+            errorManager.message[0] = '\0';
+        }
+
+        /**
+         * @brief Properties of a JPEG image read from its header.
+         */
+        struct JpegHeader
+        {
+            int width = 0;
+            int height = 0;
+            int numberOfComponents = 0;
+            J_COLOR_SPACE colorSpace = JCS_UNKNOWN;
+            int orientation = 1;
+        };
+
+        bool isJpeg(const std::vector<unsigned char>& buffer)
+        {
+            return buffer.size() > 3 && buffer[0] == 0xFF && buffer[1] == 0xD8 && buffer[2] == 0xFF;
+        }
+
+        int readExifOrientation(const JOCTET* data, size_t length)
+        {
+            static const unsigned char exifIdentifier[6] = { 'E', 'x', 'i', 'f', 0, 0 };
+            if (length < 14 || std::memcmp(data, exifIdentifier, sizeof(exifIdentifier)) != 0)
+                return 1;
+
+            const JOCTET* tiff = data + sizeof(exifIdentifier);
+            const size_t tiffLength = length - sizeof(exifIdentifier);
+            bool littleEndian = tiff[0] == 'I' && tiff[1] == 'I';
+            if (!littleEndian && !(tiff[0] == 'M' && tiff[1] == 'M'))
+                return 1;
+
+            auto read16 = [tiff, littleEndian](size_t offset) -> size_t
+            {
+                return littleEndian ? tiff[offset] | (tiff[offset + 1] << 8) : (tiff[offset] << 8) | tiff[offset + 1];
+            };
+            auto read32 = [&read16, littleEndian](size_t offset) -> size_t
+            {
+                return littleEndian ? read16(offset) | (read16(offset + 2) << 16) : (read16(offset) << 16) | read16(offset + 2);
+            };
+
+            const size_t ifdOffset = read32(4);
+            if (ifdOffset + 2 > tiffLength)
+                return 1;
+
+            const size_t numberOfEntries = read16(ifdOffset);
+            for (size_t i = 0; i < numberOfEntries; i++)
+            {
+                const size_t entry = ifdOffset + 2 + 12 * i;
+                if (entry + 12 > tiffLength)
+                    break;
+                static const size_t orientationTag = 0x0112;
+                if (read16(entry) == orientationTag)
+                    return static_cast<int>(read16(entry + 8));
+            }
+            return 1;
+        }
+
+        bool readJpegHeader(const std::vector<unsigned char>& buffer, JpegHeader& header)
+        {
+            jpeg_decompress_struct cinfo{};
+            JpegErrorManager errorManager;
+            setupErrorManager(cinfo, errorManager);
+            if (setjmp(errorManager.jumpBuffer))
+            {
+                jpeg_destroy_decompress(&cinfo);
+                return false;
+            }
+
+            jpeg_create_decompress(&cinfo);
+            jpeg_mem_src(&cinfo, buffer.data(), static_cast<unsigned long>(buffer.size()));
+            jpeg_save_markers(&cinfo, JPEG_APP0 + 1, 0xFFFF);
+            jpeg_read_header(&cinfo, TRUE);
+
+            header.width = static_cast<int>(cinfo.image_width);
+            header.height = static_cast<int>(cinfo.image_height);
+            header.numberOfComponents = cinfo.num_components;
+            header.colorSpace = cinfo.jpeg_color_space;
+            for (auto marker = cinfo.marker_list; marker != nullptr; marker = marker->next)
+            {
+                if (marker->marker == JPEG_APP0 + 1 &&
+                    (header.orientation = readExifOrientation(marker->data, marker->data_length)) != 1)
+                    break;
+            }
+
+            jpeg_destroy_decompress(&cinfo);
+            return true;
+        }
+
+        /**
+         * @brief Decodes the image scaled by 1/scaleDenominator and copies the region
+         * [left, right) x [top, bottom) of the scaled image into the target image which must
+         * have the size of the scaled image. Only the rows and columns needed for the region
+         * (plus the margin) are decoded.
+         */
+        bool decodeJpegRegion(
+            const std::vector<unsigned char>& buffer,
+            int scaleDenominator,
+            int left, int top, int right, int bottom,
+            int margin,
+            OFIQ::Image& target,
+            std::string& errorMessage)
+        {
+            jpeg_decompress_struct cinfo{};
+            JpegErrorManager errorManager;
+            setupErrorManager(cinfo, errorManager);
+            if (setjmp(errorManager.jumpBuffer))
+            {
+                errorMessage = errorManager.message;
+                jpeg_destroy_decompress(&cinfo);
+                return false;
+            }
+
+            jpeg_create_decompress(&cinfo);
+            jpeg_mem_src(&cinfo, buffer.data(), static_cast<unsigned long>(buffer.size()));
+            jpeg_read_header(&cinfo, TRUE);
+
+            const int channels = target.depth / 8;
+            cinfo.out_color_space = channels == 3 ? JCS_RGB : JCS_GRAYSCALE;
+            cinfo.scale_num = 1;
+            cinfo.scale_denom = static_cast<unsigned int>(scaleDenominator);
+            jpeg_start_decompress(&cinfo);
+
+            if (cinfo.output_width != target.width ||
+                cinfo.output_height != target.height ||
+                cinfo.output_components != channels)
+            {
+                errorMessage = "unexpected size of decoded image";
+                jpeg_destroy_decompress(&cinfo);
+                return false;
+            }
+
+            auto cropLeft = static_cast<JDIMENSION>(std::max(0, left - margin));
+            auto cropRight = static_cast<JDIMENSION>(std::min<int>(target.width, right + margin));
+            auto cropWidth = cropRight - cropLeft;
+            auto firstRow = static_cast<JDIMENSION>(std::max(0, top - margin));
+            if (cropWidth < cinfo.output_width)
+                // the crop is widened to iMCU boundaries by libjpeg
+                jpeg_crop_scanline(&cinfo, &cropLeft, &cropWidth);
+            if (firstRow > 0)
+                jpeg_skip_scanlines(&cinfo, firstRow);
+
+            JSAMPARRAY row = (*cinfo.mem->alloc_sarray)(
+                reinterpret_cast<j_common_ptr>(&cinfo), JPOOL_IMAGE, cropWidth * channels, 1);
+            const size_t stride = static_cast<size_t>(target.width) * channels;
+            while (cinfo.output_scanline < static_cast<JDIMENSION>(bottom))
+            {
+                const size_t y = cinfo.output_scanline;
+                jpeg_read_scanlines(&cinfo, row, 1);
+                if (y >= static_cast<size_t>(top))
+                    std::memcpy(
+                        target.data.get() + y * stride + static_cast<size_t>(left) * channels,
+                        row[0] + (left - cropLeft) * channels,
+                        static_cast<size_t>(right - left) * channels);
+            }
+
+            jpeg_destroy_decompress(&cinfo);
+            return true;
+        }
+
+        OFIQ::Image allocateBlackImage(int width, int height, uint8_t depth)
+        {
+            OFIQ::Image image;
+            image.width = static_cast<uint16_t>(width);
+            image.height = static_cast<uint16_t>(height);
+            image.depth = depth;
+            // calloc allows the system to provide zeroed pages lazily,
+            // so memory of regions which are never decoded is not touched
+            image.data = std::shared_ptr<uint8_t>(static_cast<uint8_t*>(std::calloc(image.size(), 1)), std::free);
+            if (!image.data)
+                throw OFIQError(ReturnCode::ImageReadingError, "failed to allocate memory for image");
+            return image;
+        }
+    }
+
+    EncodedImage::EncodedImage(const std::vector<unsigned char>& buffer)
+        : m_buffer{buffer}
+    {
+        JpegHeader header;
+        if (isJpeg(m_buffer) && readJpegHeader(m_buffer, header) &&
+            header.orientation == 1 &&
+            header.width > 0 && header.width <= UINT16_MAX &&
+            header.height > 0 && header.height <= UINT16_MAX &&
+            ((header.numberOfComponents == 3 && (header.colorSpace == JCS_YCbCr || header.colorSpace == JCS_RGB)) ||
+             (header.numberOfComponents == 1 && header.colorSpace == JCS_GRAYSCALE)))
+        {
+            m_regionDecoding = true;
+            // gray scale images are decoded to RGB like OpenCV's IMREAD_COLOR does
+            m_image = allocateBlackImage(header.width, header.height, 24);
+            return;
+        }
+
+        // everything else is decoded completely by OpenCV
+        if (auto status = readImageFromByteArray(m_buffer, m_image);
+            status.code != ReturnCode::Success)
+            throw OFIQError(status.code, status.info);
+    }
+
+    OFIQ::Image EncodedImage::DecodeThumbnail(int minimalSize, int& scaleDenominator) const
+    {
+        if (!m_regionDecoding)
+        {
+            scaleDenominator = 1;
+            return m_image;
+        }
+
+        const int shorterSide = std::min(m_image.width, m_image.height);
+        scaleDenominator = 1;
+        for (int denominator : { 8, 4, 2 })
+        {
+            if ((shorterSide + denominator - 1) / denominator >= minimalSize)
+            {
+                scaleDenominator = denominator;
+                break;
+            }
+        }
+
+        const int thumbnailWidth = (m_image.width + scaleDenominator - 1) / scaleDenominator;
+        const int thumbnailHeight = (m_image.height + scaleDenominator - 1) / scaleDenominator;
+        OFIQ::Image thumbnail = allocateBlackImage(thumbnailWidth, thumbnailHeight, m_image.depth);
+
+        if (std::string errorMessage; !decodeJpegRegion(
+            m_buffer, scaleDenominator,
+            0, 0, thumbnailWidth, thumbnailHeight, 0,
+            thumbnail, errorMessage))
+            throw OFIQError(ReturnCode::ImageReadingError, "failed to decode down-scaled image: " + errorMessage);
+
+        return thumbnail;
+    }
+
+    void EncodedImage::DecodeRegion(const OFIQ::BoundingBox& region)
+    {
+        if (!m_regionDecoding)
+            return;
+
+        const int left = std::max<int>(0, region.xleft);
+        const int top = std::max<int>(0, region.ytop);
+        const int right = std::min<int>(m_image.width, region.xleft + region.width);
+        const int bottom = std::min<int>(m_image.height, region.ytop + region.height);
+        if (left >= right || top >= bottom)
+            return;
+
+        for (const auto& decoded : m_decodedRegions)
+        {
+            if (decoded.xleft <= left && decoded.ytop <= top &&
+                decoded.xleft + decoded.width >= right && decoded.ytop + decoded.height >= bottom)
+                return;
+        }
+
+        if (std::string errorMessage; !decodeJpegRegion(
+            m_buffer, 1,
+            left, top, right, bottom, regionDecodingMargin,
+            m_image, errorMessage))
+            throw OFIQError(ReturnCode::ImageReadingError, "failed to decode image region: " + errorMessage);
+
+        m_decodedRegions.emplace_back(
+            static_cast<int16_t>(left),
+            static_cast<int16_t>(top),
+            static_cast<int16_t>(right - left),
+            static_cast<int16_t>(bottom - top),
+            FaceDetectorType::NotSet);
+    }
+}
@@ -0,0 +1,522 @@
+/**
+ * @file ResultCache.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "ResultCache.h"
+#include "OFIQError.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+#    define WIN32_LEAN_AND_MEAN
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/file.h>
+#    include <unistd.h>
+#endif
+
+using namespace OFIQ;
+
+namespace OFIQ_LIB
+{
+    namespace
+    {
+        const uint64_t prime1 = 11400714785074694791ULL;
+        const uint64_t prime2 = 14029467366897019727ULL;
+        const uint64_t prime3 = 1609587929392839161ULL;
+        const uint64_t prime4 = 9650029242287828579ULL;
+        const uint64_t prime5 = 2870177450012600261ULL;
+
+        /**
+         * @brief Magic number and format version at the beginning of a persistence file.
+         */
+        const char persistenceMagic[8] = { 'O', 'F', 'I', 'Q', 'R', 'C', '0', '2' };
+
+        /**
+         * @brief Upper bound of the embedding size read from a persistence file, such that a corrupt
+         * size does not allocate arbitrary memory.
+         */
+        const uint32_t maxEmbeddingSize = 1 << 16;
+
+        uint64_t RotateLeft(uint64_t value, int bits)
+        {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        uint64_t Read64(const unsigned char* p)
+        {
+            uint64_t value = 0;
+            for (int i = 7; i >= 0; i--)
+                value = (value << 8) | p[i];
+            return value;
+        }
+
+        uint32_t Read32(const unsigned char* p)
+        {
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+
+        uint64_t Round(uint64_t accumulator, uint64_t input)
+        {
+            accumulator += input * prime2;
+            accumulator = RotateLeft(accumulator, 31);
+            return accumulator * prime1;
+        }
+
+        uint64_t MergeRound(uint64_t accumulator, uint64_t value)
+        {
+            accumulator ^= Round(0, value);
+            return accumulator * prime1 + prime4;
+        }
+
+        /**
+         * @brief Incremental computation of the XXH64 hash.
+         */
+        class Xxh64
+        {
+        public:
+            explicit Xxh64(uint64_t seed)
+                : m_seed(seed),
+                  m_v{ seed + prime1 + prime2, seed + prime2, seed, seed - prime1 }
+            {
+            }
+
+            void Update(const void* data, size_t length)
+            {
+                auto p = static_cast<const unsigned char*>(data);
+                m_totalLength += length;
+
+                if (m_bufferSize + length < sizeof(m_buffer))
+                {
+                    std::memcpy(m_buffer + m_bufferSize, p, length);
+                    m_bufferSize += length;
+                    return;
+                }
+
+                if (m_bufferSize > 0)
+                {
+                    size_t fill = sizeof(m_buffer) - m_bufferSize;
+                    std::memcpy(m_buffer + m_bufferSize, p, fill);
+                    ProcessStripe(m_buffer);
+                    p += fill;
+                    length -= fill;
+                    m_bufferSize = 0;
+                }
+
+                for (; length >= sizeof(m_buffer); p += sizeof(m_buffer), length -= sizeof(m_buffer))
+                    ProcessStripe(p);
+
+                std::memcpy(m_buffer, p, length);
+                m_bufferSize = length;
+            }
+
+            uint64_t Digest() const
+            {
+                uint64_t h;
+                if (m_totalLength >= sizeof(m_buffer))
+                {
+                    h = RotateLeft(m_v[0], 1) + RotateLeft(m_v[1], 7) +
+                        RotateLeft(m_v[2], 12) + RotateLeft(m_v[3], 18);
+                    for (auto v : m_v)
+                        h = MergeRound(h, v);
+                }
+                else
+                {
+                    h = m_seed + prime5;
+                }
+                h += m_totalLength;
+
+                const unsigned char* p = m_buffer;
+                size_t length = m_bufferSize;
+                for (; length >= 8; p += 8, length -= 8)
+                {
+                    h ^= Round(0, Read64(p));
+                    h = RotateLeft(h, 27) * prime1 + prime4;
+                }
+                if (length >= 4)
+                {
+                    h ^= static_cast<uint64_t>(Read32(p)) * prime1;
+                    h = RotateLeft(h, 23) * prime2 + prime3;
+                    p += 4;
+                    length -= 4;
+                }
+                for (; length > 0; p++, length--)
+                {
+                    h ^= (*p) * prime5;
+                    h = RotateLeft(h, 11) * prime1;
+                }
+
+                h ^= h >> 33;
+                h *= prime2;
+                h ^= h >> 29;
+                h *= prime3;
+                h ^= h >> 32;
+                return h;
+            }
+
+        private:
+            void ProcessStripe(const unsigned char* p)
+            {
+                for (int i = 0; i < 4; i++)
+                    m_v[i] = Round(m_v[i], Read64(p + 8 * i));
+            }
+
+            uint64_t m_seed;
+            uint64_t m_v[4];
+            unsigned char m_buffer[32];
+            size_t m_bufferSize = 0;
+            uint64_t m_totalLength = 0;
+        };
+
+        template<typename T>
+        void WriteValue(std::ostream& stream, const T& value)
+        {
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        bool ReadValue(std::istream& stream, T& value)
+        {
+            return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+        }
+
+        using Entry = std::pair<uint64_t, FaceImageQualityAssessment>;
+
+        void WriteEntry(std::ostream& stream, const Entry& entry)
+        {
+            const auto& [key, assessment] = entry;
+            WriteValue(stream, key);
+            WriteValue(stream, assessment.boundingBox.xleft);
+            WriteValue(stream, assessment.boundingBox.ytop);
+            WriteValue(stream, assessment.boundingBox.width);
+            WriteValue(stream, assessment.boundingBox.height);
+            WriteValue(stream, static_cast<int32_t>(assessment.boundingBox.faceDetector));
+            WriteValue(stream, static_cast<uint32_t>(assessment.qAssessments.size()));
+            for (const auto& [measure, result] : assessment.qAssessments)
+            {
+                WriteValue(stream, static_cast<int32_t>(measure));
+                WriteValue(stream, result.rawScore);
+                WriteValue(stream, result.scalar);
+                WriteValue(stream, static_cast<int32_t>(result.code));
+            }
+            WriteValue(stream, static_cast<uint32_t>(assessment.embedding.size()));
+            for (auto value : assessment.embedding)
+                WriteValue(stream, value);
+        }
+
+        bool ReadEntry(std::istream& stream, Entry& entry)
+        {
+            auto& [key, assessment] = entry;
+            int32_t faceDetector;
+            uint32_t numResults;
+            if (!ReadValue(stream, key) ||
+                !ReadValue(stream, assessment.boundingBox.xleft) ||
+                !ReadValue(stream, assessment.boundingBox.ytop) ||
+                !ReadValue(stream, assessment.boundingBox.width) ||
+                !ReadValue(stream, assessment.boundingBox.height) ||
+                !ReadValue(stream, faceDetector) ||
+                !ReadValue(stream, numResults))
+                return false;
+            assessment.boundingBox.faceDetector = static_cast<FaceDetectorType>(faceDetector);
+
+            for (uint32_t j = 0; j < numResults; j++)
+            {
+                int32_t measure;
+                QualityMeasureResult result;
+                int32_t code;
+                if (!ReadValue(stream, measure) ||
+                    !ReadValue(stream, result.rawScore) ||
+                    !ReadValue(stream, result.scalar) ||
+                    !ReadValue(stream, code))
+                    return false;
+                result.code = static_cast<QualityMeasureReturnCode>(code);
+                assessment.qAssessments[static_cast<QualityMeasure>(measure)] = result;
+            }
+
+            uint32_t embeddingSize;
+            if (!ReadValue(stream, embeddingSize) || embeddingSize > maxEmbeddingSize)
+                return false;
+            assessment.embedding.resize(embeddingSize);
+            for (auto& value : assessment.embedding)
+            {
+                if (!ReadValue(stream, value))
+                    return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Reads the entries of a persistence file from least to most recently used.
+         * @details Nothing is read if the file does not exist or has been written for another
+         * configuration fingerprint; a truncated or corrupt file is read up to the first invalid entry.
+         */
+        std::vector<Entry> ReadPersistenceFile(const std::string& path, uint64_t configFingerprint)
+        {
+            std::vector<Entry> entries;
+            std::ifstream stream(path, std::ios::binary);
+            if (!stream)
+                return entries;
+
+            char magic[sizeof(persistenceMagic)];
+            uint64_t fingerprint = 0;
+            uint64_t numEntries = 0;
+            if (!stream.read(magic, sizeof(magic)) ||
+                std::memcmp(magic, persistenceMagic, sizeof(magic)) != 0 ||
+                !ReadValue(stream, fingerprint) || fingerprint != configFingerprint ||
+                !ReadValue(stream, numEntries))
+                return entries;
+
+            for (uint64_t i = 0; i < numEntries; i++)
+            {
+                Entry entry;
+                if (!ReadEntry(stream, entry))
+                    break;
+                entries.push_back(std::move(entry));
+            }
+            return entries;
+        }
+
+        /**
+         * @brief Exclusive advisory lock of a file, held from construction to destruction. The file
+         * is created if it does not exist and is not removed, such that all processes lock the same file.
+         */
+        class FileLock
+        {
+        public:
+            explicit FileLock(const std::string& path)
+            {
+#ifdef _WIN32
+                m_handle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                    OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+                OVERLAPPED overlapped = {};
+                if (m_handle == INVALID_HANDLE_VALUE ||
+                    !LockFileEx(m_handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped))
+                {
+                    if (m_handle != INVALID_HANDLE_VALUE)
+                        CloseHandle(m_handle);
+                    throw OFIQError(ReturnCode::UnknownError, "Cannot lock " + path);
+                }
+#else
+                m_fd = open(path.c_str(), O_RDWR | O_CREAT, 0666);
+                if (m_fd < 0 || flock(m_fd, LOCK_EX) != 0)
+                {
+                    if (m_fd >= 0)
+                        close(m_fd);
+                    throw OFIQError(ReturnCode::UnknownError, "Cannot lock " + path);
+                }
+#endif
+            }
+
+            ~FileLock()
+            {
+                // closing the file releases the lock
+#ifdef _WIN32
+                CloseHandle(m_handle);
+#else
+                close(m_fd);
+#endif
+            }
+
+            FileLock(const FileLock&) = delete;
+            FileLock& operator=(const FileLock&) = delete;
+
+        private:
+#ifdef _WIN32
+            HANDLE m_handle;
+#else
+            int m_fd;
+#endif
+        };
+
+        /**
+         * @brief Path of a temporary file next to the persistence file, unique for the process and the cache.
+         */
+        std::string TemporaryPath(const std::string& path, const void* cache)
+        {
+            std::ostringstream temporaryPath;
+#ifdef _WIN32
+            temporaryPath << path << '.' << GetCurrentProcessId();
+#else
+            temporaryPath << path << '.' << getpid();
+#endif
+            temporaryPath << '.' << std::hex << reinterpret_cast<uintptr_t>(cache) << ".tmp";
+            return temporaryPath.str();
+        }
+    }
+
+    ResultCache::ResultCache(size_t capacity, uint64_t configFingerprint, const std::string& persistencePath)
+        : m_capacity(capacity),
+          m_configFingerprint(configFingerprint),
+          m_persistencePath(persistencePath)
+    {
+        if (!m_persistencePath.empty())
+            Load();
+    }
+
+    ResultCache::~ResultCache()
+    {
+        try
+        {
+            Save();
+        }
+        catch (const OFIQError&)
+        {
+            // the cache is an optimization only, a failed write must not terminate the process
+        }
+    }
+
+    uint64_t ResultCache::HashBytes(const void* data, size_t length, uint64_t seed)
+    {
+        Xxh64 hash(seed);
+        hash.Update(data, length);
+        return hash.Digest();
+    }
+
+    uint64_t ResultCache::HashImage(const OFIQ::Image& image, uint64_t seed)
+    {
+        Xxh64 hash(seed);
+        uint16_t header[4] = {
+            image.width, image.height, image.depth,
+            static_cast<uint16_t>(image.depth == 8 ? PixelFormat::GRAY : image.pixelFormat) };
+        hash.Update(header, sizeof(header));
+
+        if (image.data)
+        {
+            size_t rowLength = static_cast<size_t>(image.width) * (image.depth / 8);
+            const uint8_t* row = image.data.get();
+            for (int y = 0; y < image.height; y++, row += image.rowStride())
+                hash.Update(row, rowLength);
+        }
+        return hash.Digest();
+    }
+
+    bool ResultCache::Lookup(uint64_t key, OFIQ::FaceImageQualityAssessment& assessment)
+    {
+        std::scoped_lock lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+            return false;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        assessment = it->second->second;
+        return true;
+    }
+
+    void ResultCache::Insert(uint64_t key, const OFIQ::FaceImageQualityAssessment& assessment)
+    {
+        std::scoped_lock lock(m_mutex);
+        if (m_capacity == 0)
+            return;
+
+        if (auto it = m_index.find(key); it != m_index.end())
+        {
+            it->second->second = assessment;
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            return;
+        }
+
+        m_entries.emplace_front(key, assessment);
+        m_index[key] = m_entries.begin();
+        while (m_entries.size() > m_capacity)
+        {
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+    }
+
+    void ResultCache::Save() const
+    {
+        if (m_persistencePath.empty())
+            return;
+
+        std::scoped_lock lock(m_mutex);
+
+        // Several caches, e.g. of the instances of a process or of concurrent processes, may share
+        // the persistence file. The file is locked and its entries not cached here are kept as less
+        // recently used than the entries of this cache.
+        FileLock fileLock(m_persistencePath + ".lock");
+        std::vector<Entry> entries;
+        for (auto& entry : ReadPersistenceFile(m_persistencePath, m_configFingerprint))
+        {
+            if (m_index.find(entry.first) == m_index.end())
+                entries.push_back(std::move(entry));
+        }
+        // the file may hold duplicate keys of several caches, the most recently used one is kept
+        std::unordered_set<uint64_t> keys;
+        std::vector<const Entry*> merged;
+        for (auto it = m_entries.begin(); it != m_entries.end() && merged.size() < m_capacity; ++it)
+        {
+            keys.insert(it->first);
+            merged.push_back(&*it);
+        }
+        for (auto it = entries.rbegin(); it != entries.rend() && merged.size() < m_capacity; ++it)
+        {
+            if (keys.insert(it->first).second)
+                merged.push_back(&*it);
+        }
+
+        // write to a temporary file first such that a concurrent reader never sees a partial cache
+        std::string temporaryPath = TemporaryPath(m_persistencePath, this);
+        {
+            std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!stream)
+                throw OFIQError(ReturnCode::UnknownError, "Cannot write result cache " + temporaryPath);
+
+            stream.write(persistenceMagic, sizeof(persistenceMagic));
+            WriteValue(stream, m_configFingerprint);
+            WriteValue(stream, static_cast<uint64_t>(merged.size()));
+            // least recently used first, such that loading restores the order
+            for (auto it = merged.rbegin(); it != merged.rend(); ++it)
+                WriteEntry(stream, **it);
+            if (!stream)
+            {
+                stream.close();
+                std::filesystem::remove(temporaryPath);
+                throw OFIQError(ReturnCode::UnknownError, "Cannot write result cache " + temporaryPath);
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, m_persistencePath, error);
+        if (error)
+        {
+            std::filesystem::remove(temporaryPath, error);
+            throw OFIQError(ReturnCode::UnknownError, "Cannot write result cache " + m_persistencePath);
+        }
+    }
+
+    void ResultCache::Load()
+    {
+        for (const auto& [key, assessment] : ReadPersistenceFile(m_persistencePath, m_configFingerprint))
+            Insert(key, assessment);
+    }
+}
@@ -25,9 +25,316 @@
  */
 
 #include "Session.h"
+#include "OFIQError.h"
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+
+using namespace OFIQ;
 
 namespace OFIQ_LIB
 {
+    namespace
+    {
+        /**
+         * @brief Magic number and version of serialized sessions.
+         */
+        const uint32_t serializationMagic = 0x5353464F; // "OFSS"
+        const uint32_t serializationVersion = 1;
+
+        /**
+         * @brief Alignment of the header, the sections and the matrix data.
+         */
+        const size_t serializationAlignment = 64;
+
+        /**
+         * @brief Identifiers of the sections of a serialized session.
+         */
+        enum class SectionId : uint32_t
+        {
+            ImageReference = 1,
+            DetectedFaces,
+            Pose,
+            Landmarks,
+            AlignedFaceLandmarks,
+            AlignedFaceTransformationMatrix,
+            FaceParsingImage,
+            FaceOcclusionSegmentationImage,
+            AlignedFaceLandmarkedRegion,
+            AlignedFace
+        };
+
+        /**
+         * @brief Entry of the section table.
+         */
+        struct SectionEntry
+        {
+            uint32_t id;
+            uint32_t reserved;
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        /**
+         * @brief Fixed size header of a serialized session.
+         */
+        struct SerializationHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t numSections;
+            uint32_t imageWidth;
+            uint32_t imageHeight;
+            uint32_t imageDepth;
+            uint8_t reserved[40];
+        };
+        static_assert(sizeof(SerializationHeader) == serializationAlignment, "unexpected header size");
+        static_assert(sizeof(SectionEntry) == 24, "unexpected section entry size");
+
+        size_t AlignSize(size_t size)
+        {
+            return (size + serializationAlignment - 1) & ~(serializationAlignment - 1);
+        }
+
+        [[noreturn]] void FailInvalid()
+        {
+            throw OFIQError(ReturnCode::UnknownError, "Invalid serialized session");
+        }
+
+        /**
+         * @brief Collects the sections of a serialized session.
+         */
+        class SectionWriter
+        {
+        public:
+            void Begin(SectionId id)
+            {
+                m_payload.resize(AlignSize(m_payload.size()), 0);
+                m_sections.push_back({ static_cast<uint32_t>(id), 0, m_payload.size(), 0 });
+            }
+
+            void End()
+            {
+                m_sections.back().size = m_payload.size() - m_sections.back().offset;
+            }
+
+            template<typename T>
+            void Write(const T& value)
+            {
+                WriteBytes(&value, sizeof(T));
+            }
+
+            void WriteBytes(const void* data, size_t size)
+            {
+                auto p = static_cast<const uint8_t*>(data);
+                m_payload.insert(m_payload.end(), p, p + size);
+            }
+
+            void WriteLandmarks(SectionId id, const FaceLandmarks& landmarks)
+            {
+                Begin(id);
+                Write(static_cast<int32_t>(landmarks.type));
+                Write(static_cast<uint32_t>(landmarks.landmarks.size()));
+                for (const auto& landmark : landmarks.landmarks)
+                {
+                    Write(landmark.x);
+                    Write(landmark.y);
+                }
+                End();
+            }
+
+            void WriteMat(SectionId id, const cv::Mat& mat)
+            {
+                if (mat.empty())
+                    return;
+                Begin(id);
+                Write(static_cast<int32_t>(mat.rows));
+                Write(static_cast<int32_t>(mat.cols));
+                Write(static_cast<int32_t>(mat.type()));
+                Write(static_cast<int32_t>(0));
+                auto rowSize = mat.cols * mat.elemSize();
+                Write(static_cast<uint64_t>(rowSize));
+                m_payload.resize(m_sections.back().offset + serializationAlignment, 0);
+                for (int row = 0; row < mat.rows; row++)
+                    WriteBytes(mat.ptr(row), rowSize);
+                End();
+            }
+
+            std::vector<uint8_t> Finish(const OFIQ::Image& image) const
+            {
+                size_t prefixSize = AlignSize(sizeof(SerializationHeader) + m_sections.size() * sizeof(SectionEntry));
+                std::vector<uint8_t> buffer(prefixSize, 0);
+
+                SerializationHeader header{};
+                header.magic = serializationMagic;
+                header.version = serializationVersion;
+                header.numSections = static_cast<uint32_t>(m_sections.size());
+                header.imageWidth = image.width;
+                header.imageHeight = image.height;
+                header.imageDepth = image.depth;
+                std::memcpy(buffer.data(), &header, sizeof(header));
+
+                auto entry = buffer.data() + sizeof(header);
+                for (auto section : m_sections)
+                {
+                    section.offset += prefixSize;
+                    std::memcpy(entry, &section, sizeof(section));
+                    entry += sizeof(section);
+                }
+
+                buffer.insert(buffer.end(), m_payload.begin(), m_payload.end());
+                return buffer;
+            }
+
+        private:
+            std::vector<SectionEntry> m_sections;
+            std::vector<uint8_t> m_payload;
+        };
+
+        /**
+         * @brief Reads values of a section with bounds checking.
+         */
+        class SectionReader
+        {
+        public:
+            SectionReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+            template<typename T>
+            T Read()
+            {
+                T value;
+                std::memcpy(&value, Consume(sizeof(T)), sizeof(T));
+                return value;
+            }
+
+            const uint8_t* Consume(size_t size)
+            {
+                if (size > m_size - m_position)
+                    FailInvalid();
+                const uint8_t* p = m_data + m_position;
+                m_position += size;
+                return p;
+            }
+
+            size_t Remaining() const
+            {
+                return m_size - m_position;
+            }
+
+        private:
+            const uint8_t* m_data;
+            size_t m_size;
+            size_t m_position = 0;
+        };
+
+        /**
+         * @brief Validates the header and the section table of a serialized session.
+         */
+        class SerializedSession
+        {
+        public:
+            SerializedSession(const uint8_t* data, size_t size) : m_data(data)
+            {
+                if (data == nullptr || size < sizeof(SerializationHeader))
+                    FailInvalid();
+                std::memcpy(&m_header, data, sizeof(m_header));
+                if (m_header.magic != serializationMagic || m_header.version != serializationVersion)
+                    FailInvalid();
+                if (m_header.numSections > (size - sizeof(m_header)) / sizeof(SectionEntry))
+                    FailInvalid();
+
+                m_sections.resize(m_header.numSections);
+                std::memcpy(m_sections.data(), data + sizeof(m_header), m_sections.size() * sizeof(SectionEntry));
+                for (const auto& section : m_sections)
+                {
+                    if (section.offset > size || section.size > size - section.offset ||
+                        section.offset % serializationAlignment != 0)
+                        FailInvalid();
+                }
+            }
+
+            const SerializationHeader& Header() const { return m_header; }
+
+            bool Has(SectionId id) const
+            {
+                return Find(id) != nullptr;
+            }
+
+            SectionReader Section(SectionId id) const
+            {
+                auto section = Find(id);
+                if (section == nullptr)
+                    return SectionReader(nullptr, 0);
+                return SectionReader(m_data + section->offset, section->size);
+            }
+
+            FaceLandmarks ReadLandmarks(SectionId id) const
+            {
+                FaceLandmarks landmarks;
+                if (!Has(id))
+                    return landmarks;
+                auto reader = Section(id);
+                landmarks.type = static_cast<LandmarkType>(reader.Read<int32_t>());
+                auto numLandmarks = reader.Read<uint32_t>();
+                // each landmark has two int16 coordinates
+                if (numLandmarks > reader.Remaining() / 4)
+                    FailInvalid();
+                landmarks.landmarks.reserve(numLandmarks);
+                for (uint32_t i = 0; i < numLandmarks; i++)
+                {
+                    LandmarkPoint landmark;
+                    landmark.x = reader.Read<int16_t>();
+                    landmark.y = reader.Read<int16_t>();
+                    landmarks.landmarks.push_back(landmark);
+                }
+                return landmarks;
+            }
+
+            /**
+             * @brief Reads a matrix, which must have one of the expected types and, if given, the expected size.
+             */
+            cv::Mat ReadMat(
+                SectionId id, bool copyData, std::initializer_list<int> types, const cv::Size& size = cv::Size()) const
+            {
+                if (!Has(id))
+                    return cv::Mat();
+                auto reader = Section(id);
+                auto rows = reader.Read<int32_t>();
+                auto cols = reader.Read<int32_t>();
+                auto type = reader.Read<int32_t>();
+                reader.Read<int32_t>();
+                auto rowSize = reader.Read<uint64_t>();
+                reader.Consume(serializationAlignment - 24);
+                if (std::find(types.begin(), types.end(), type) == types.end() ||
+                    (!size.empty() && (rows != size.height || cols != size.width)))
+                    FailInvalid();
+                if (rows <= 0 || cols <= 0 || rowSize != static_cast<uint64_t>(cols) * CV_ELEM_SIZE(type))
+                    FailInvalid();
+                // checked before multiplying, such that a corrupt size cannot wrap around
+                if (static_cast<uint64_t>(rows) > reader.Remaining() / rowSize)
+                    FailInvalid();
+                auto pixels = reader.Consume(static_cast<size_t>(rows) * rowSize);
+                cv::Mat mat(rows, cols, type, const_cast<uint8_t*>(pixels));
+                return copyData ? mat.clone() : mat;
+            }
+
+        private:
+            const SectionEntry* Find(SectionId id) const
+            {
+                for (const auto& section : m_sections)
+                {
+                    if (section.id == static_cast<uint32_t>(id))
+                        return &section;
+                }
+                return nullptr;
+            }
+
+            const uint8_t* m_data;
+            SerializationHeader m_header;
+            std::vector<SectionEntry> m_sections;
+        };
+    }
     
     std::string Session::GenerateId() const
     {
@@ -86,12 +393,39 @@ namespace OFIQ_LIB
     }
 
     cv::Mat Session::getAlignedFace() const
+    {
+        if (isGrayScale())
+        {
+            cv::Mat bgrAlignedFace;
+            cv::cvtColor(m_alignedFace, bgrAlignedFace, cv::COLOR_GRAY2BGR);
+            return bgrAlignedFace;
+        }
+        return m_alignedFace.clone();
+    }
+
+    cv::Mat Session::getAlignedFaceNative() const
     {
         return m_alignedFace.clone();
     }
 
+    cv::Mat Session::getAlignedFaceRegion(const cv::Rect& i_region) const
+    {
+        return m_alignedFace(i_region).clone();
+    }
+
+    cv::Size Session::getAlignedFaceSize() const
+    {
+        return m_alignedFace.size();
+    }
+
+    bool Session::isGrayScale() const
+    {
+        return m_alignedFace.channels() == 1;
+    }
+
     void Session::setAlignedFaceLandmarkedRegion(const cv::Mat& i_alignedFaceRegion) {
         m_alignedFacelandmarkedRegion = i_alignedFaceRegion.clone();
+        m_alignedFaceLandmarkedRegionBitMask.reset();
     }
 
     cv::Mat Session::getAlignedFaceLandmarkedRegion() const
@@ -99,9 +433,17 @@ namespace OFIQ_LIB
         return m_alignedFacelandmarkedRegion.clone();
     }
 
+    const BitMask& Session::getAlignedFaceLandmarkedRegionBitMask() const
+    {
+        if (!m_alignedFaceLandmarkedRegionBitMask)
+            m_alignedFaceLandmarkedRegionBitMask.emplace(m_alignedFacelandmarkedRegion);
+        return *m_alignedFaceLandmarkedRegionBitMask;
+    }
+
     void Session::setFaceParsingImage(const cv::Mat& i_parsingImage)
     {
         m_faceParsingImage = i_parsingImage.clone();
+        m_faceParsingClassHistogram.reset();
     }
 
     cv::Mat Session::getFaceParsingImage() const
@@ -109,9 +451,17 @@ namespace OFIQ_LIB
         return m_faceParsingImage.clone();
     }
 
+    const ClassHistogram& Session::getFaceParsingClassHistogram() const
+    {
+        if (!m_faceParsingClassHistogram)
+            m_faceParsingClassHistogram.emplace(m_faceParsingImage);
+        return *m_faceParsingClassHistogram;
+    }
+
     void Session::setFaceOcclusionSegmentationImage(const cv::Mat& i_segmentationImage)
     {
         m_faceOcclusionSegmentationImage = i_segmentationImage.clone();
+        m_faceOcclusionSegmentationBitMask.reset();
     }
 
     cv::Mat Session::getFaceOcclusionSegmentationImage() const
@@ -119,4 +469,190 @@ namespace OFIQ_LIB
         return m_faceOcclusionSegmentationImage.clone();
     }
 
-}
\ No newline at end of file
+    const BitMask& Session::getFaceOcclusionSegmentationBitMask() const
+    {
+        if (!m_faceOcclusionSegmentationBitMask)
+            m_faceOcclusionSegmentationBitMask.emplace(m_faceOcclusionSegmentationImage);
+        return *m_faceOcclusionSegmentationBitMask;
+    }
+
+    void Session::setDetectionImage(const OFIQ::Image& i_detectionImage, int i_scaleDenominator)
+    {
+        m_detectionImage = i_detectionImage;
+        m_detectionImageScaleDenominator = i_scaleDenominator;
+    }
+
+    bool Session::hasDetectionImage() const
+    {
+        return m_detectionImage.data != nullptr;
+    }
+
+    const OFIQ::Image& Session::getDetectionImage() const
+    {
+        return m_detectionImage;
+    }
+
+    int Session::getDetectionImageScaleDenominator() const
+    {
+        return m_detectionImageScaleDenominator;
+    }
+
+    void Session::setImageRegionLoader(const std::function<void(const OFIQ::BoundingBox&)>& i_regionLoader)
+    {
+        m_imageRegionLoader = i_regionLoader;
+    }
+
+    void Session::requireImageRegion(const OFIQ::BoundingBox& i_region)
+    {
+        if (m_imageRegionLoader)
+            m_imageRegionLoader(i_region);
+    }
+
+    std::vector<uint8_t> Session::serialize(const std::string& i_imageReference, bool i_includeAlignedFace) const
+    {
+        SectionWriter writer;
+        writer.Begin(SectionId::ImageReference);
+        writer.WriteBytes(i_imageReference.data(), i_imageReference.size());
+        writer.End();
+
+        writer.Begin(SectionId::DetectedFaces);
+        writer.Write(static_cast<uint32_t>(m_detectedFaces.size()));
+        writer.Write(static_cast<uint32_t>(0));
+        for (const auto& face : m_detectedFaces)
+        {
+            writer.Write(face.xleft);
+            writer.Write(face.ytop);
+            writer.Write(face.width);
+            writer.Write(face.height);
+            writer.Write(static_cast<int32_t>(face.faceDetector));
+            writer.Write(static_cast<int32_t>(0));
+        }
+        writer.End();
+
+        writer.Begin(SectionId::Pose);
+        for (double angle : m_pose)
+            writer.Write(angle);
+        writer.End();
+
+        writer.WriteLandmarks(SectionId::Landmarks, m_landmarks);
+        writer.WriteLandmarks(SectionId::AlignedFaceLandmarks, m_alignedFaceLandmarks);
+        writer.WriteMat(SectionId::AlignedFaceTransformationMatrix, m_alignedFaceTransformationMatrix);
+        writer.WriteMat(SectionId::FaceParsingImage, m_faceParsingImage);
+        writer.WriteMat(SectionId::FaceOcclusionSegmentationImage, m_faceOcclusionSegmentationImage);
+        writer.WriteMat(SectionId::AlignedFaceLandmarkedRegion, m_alignedFacelandmarkedRegion);
+        if (i_includeAlignedFace)
+            writer.WriteMat(SectionId::AlignedFace, m_alignedFace);
+        return writer.Finish(m_image);
+    }
+
+    void Session::deserialize(const uint8_t* i_data, size_t i_size, bool i_copyData)
+    {
+        SerializedSession serialized(i_data, i_size);
+        const auto& header = serialized.Header();
+        if (m_image.width != 0 &&
+            (header.imageWidth != m_image.width || header.imageHeight != m_image.height))
+            throw OFIQError(ReturnCode::UnknownError, "Serialized session does not match the image size");
+
+        std::vector<BoundingBox> faces;
+        if (serialized.Has(SectionId::DetectedFaces))
+        {
+            auto reader = serialized.Section(SectionId::DetectedFaces);
+            auto numFaces = reader.Read<uint32_t>();
+            reader.Read<uint32_t>();
+            if (numFaces > reader.Remaining() / 16)
+                FailInvalid();
+            faces.reserve(numFaces);
+            for (uint32_t i = 0; i < numFaces; i++)
+            {
+                BoundingBox face;
+                face.xleft = reader.Read<int16_t>();
+                face.ytop = reader.Read<int16_t>();
+                face.width = reader.Read<int16_t>();
+                face.height = reader.Read<int16_t>();
+                face.faceDetector = static_cast<FaceDetectorType>(reader.Read<int32_t>());
+                reader.Read<int32_t>();
+                faces.push_back(face);
+            }
+        }
+
+        EulerAngle pose{};
+        if (serialized.Has(SectionId::Pose))
+        {
+            auto reader = serialized.Section(SectionId::Pose);
+            for (auto& angle : pose)
+                angle = reader.Read<double>();
+        }
+
+        // read everything before modifying the session, such that invalid data leave it unchanged
+        auto landmarks = serialized.ReadLandmarks(SectionId::Landmarks);
+        auto alignedFaceLandmarks = serialized.ReadLandmarks(SectionId::AlignedFaceLandmarks);
+        auto transformationMatrix = serialized.ReadMat(
+            SectionId::AlignedFaceTransformationMatrix, i_copyData, { CV_64F }, cv::Size(3, 2));
+        auto faceParsingImage = serialized.ReadMat(SectionId::FaceParsingImage, i_copyData, { CV_8UC1 });
+        auto faceOcclusionSegmentationImage = serialized.ReadMat(
+            SectionId::FaceOcclusionSegmentationImage, i_copyData, { CV_8UC1 });
+        auto alignedFaceLandmarkedRegion = serialized.ReadMat(
+            SectionId::AlignedFaceLandmarkedRegion, i_copyData, { CV_8UC1 });
+        auto alignedFace = serialized.ReadMat(SectionId::AlignedFace, i_copyData, { CV_8UC3, CV_8UC1 });
+
+        m_detectedFaces = std::move(faces);
+        if (!m_detectedFaces.empty())
+            m_assessment.boundingBox = m_detectedFaces[0];
+        m_pose = pose;
+        m_landmarks = std::move(landmarks);
+        m_alignedFaceLandmarks = std::move(alignedFaceLandmarks);
+        m_alignedFaceTransformationMatrix = transformationMatrix;
+        m_faceParsingImage = faceParsingImage;
+        m_faceOcclusionSegmentationImage = faceOcclusionSegmentationImage;
+        m_alignedFacelandmarkedRegion = alignedFaceLandmarkedRegion;
+        m_alignedFaceLandmarkedRegionBitMask.reset();
+        m_faceOcclusionSegmentationBitMask.reset();
+        m_faceParsingClassHistogram.reset();
+        m_alignedFace = alignedFace;
+    }
+
+    std::string Session::readImageReference(const uint8_t* i_data, size_t i_size)
+    {
+        SerializedSession serialized(i_data, i_size);
+        if (!serialized.Has(SectionId::ImageReference))
+            return std::string();
+        auto reader = serialized.Section(SectionId::ImageReference);
+        auto size = reader.Remaining();
+        std::string reference(reinterpret_cast<const char*>(reader.Consume(size)), size);
+        return reference;
+    }
+
+    bool Session::hasAlignedFace() const
+    {
+        return !m_alignedFace.empty();
+    }
+
+    cv::Mat Session::getFaceMask(
+        const OFIQ::FaceLandmarks& i_landmarks,
+        int i_height,
+        int i_width,
+        float i_alpha,
+        const std::function<cv::Mat()>& i_createMask) const
+    {
+        auto samePoints = [](const OFIQ::LandmarkPoint& a, const OFIQ::LandmarkPoint& b)
+        {
+            return a.x == b.x && a.y == b.y;
+        };
+        for (const auto& entry : m_faceMasks)
+        {
+            if (entry.height == i_height && entry.width == i_width && entry.alpha == i_alpha &&
+                entry.landmarks.type == i_landmarks.type &&
+                entry.landmarks.landmarks.size() == i_landmarks.landmarks.size() &&
+                std::equal(
+                    entry.landmarks.landmarks.begin(), entry.landmarks.landmarks.end(),
+                    i_landmarks.landmarks.begin(), samePoints))
+            {
+                return entry.mask;
+            }
+        }
+
+        cv::Mat mask = i_createMask();
+        m_faceMasks.push_back({ i_landmarks, i_height, i_width, i_alpha, mask });
+        return mask;
+    }
+}
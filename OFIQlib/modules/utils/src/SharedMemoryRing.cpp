@@ -0,0 +1,266 @@
+/**
+ * @file SharedMemoryRing.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "SharedMemoryRing.h"
+#include "OFIQError.h"
+
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+using namespace OFIQ;
+
+namespace OFIQ_LIB
+{
+    namespace
+    {
+        /**
+         * @brief Magic number and version at the beginning of a segment.
+         */
+        const char ringMagic[8] = { 'O', 'F', 'I', 'Q', 'S', 'M', 'R', '1' };
+
+        /**
+         * @brief Alignment of the slots.
+         */
+        const uint64_t slotAlignment = 64;
+
+        uint64_t AlignSlot(uint64_t size)
+        {
+            return (size + slotAlignment - 1) & ~(slotAlignment - 1);
+        }
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free,
+            "the ring indices have to be lock free to be shared between processes");
+    }
+
+    struct SharedMemoryRing::Header
+    {
+        char magic[8];
+        uint32_t slotCount;
+        uint32_t reserved;
+        uint64_t slotSize;
+
+        // the indices are written by different processes, keep them on separate cache lines
+        alignas(64) std::atomic<uint64_t> writeIndex;
+        alignas(64) std::atomic<uint64_t> readIndex;
+        alignas(64) std::atomic<uint32_t> closed;
+    };
+
+    SharedMemoryRing::SharedMemoryRing(const std::string& name, uint8_t* segment, size_t segmentSize, bool isOwner)
+        : m_name(name), m_segment(segment), m_segmentSize(segmentSize), m_isOwner(isOwner),
+          m_header(reinterpret_cast<Header*>(segment))
+    {
+    }
+
+#ifndef _WIN32
+    std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Create(const std::string& name, uint32_t slotCount, uint64_t slotSize)
+    {
+        if (slotCount == 0 || slotSize == 0)
+            throw OFIQError(ReturnCode::UnknownError, "Invalid shared memory ring size");
+        slotSize = AlignSlot(slotSize);
+        size_t segmentSize = AlignSlot(sizeof(Header)) + slotCount * slotSize;
+
+        shm_unlink(name.c_str());
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0)
+            throw OFIQError(ReturnCode::UnknownError, "Cannot create shared memory " + name);
+        void* segment = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(segmentSize)) == 0)
+            segment = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (segment == MAP_FAILED)
+        {
+            shm_unlink(name.c_str());
+            throw OFIQError(ReturnCode::UnknownError, "Cannot map shared memory " + name);
+        }
+
+        auto header = new (segment) Header();
+        header->slotCount = slotCount;
+        header->slotSize = slotSize;
+        header->writeIndex.store(0);
+        header->readIndex.store(0);
+        header->closed.store(0);
+        // the magic is written last, an opening process sees either no or a complete header
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic, ringMagic, sizeof(ringMagic));
+
+        return std::unique_ptr<SharedMemoryRing>(
+            new SharedMemoryRing(name, static_cast<uint8_t*>(segment), segmentSize, true));
+    }
+
+    std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Open(const std::string& name)
+    {
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0)
+            throw OFIQError(ReturnCode::UnknownError, "Cannot open shared memory " + name);
+        struct stat status;
+        void* segment = MAP_FAILED;
+        size_t segmentSize = 0;
+        if (fstat(fd, &status) == 0 && static_cast<size_t>(status.st_size) >= sizeof(Header))
+        {
+            segmentSize = static_cast<size_t>(status.st_size);
+            segment = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (segment == MAP_FAILED)
+            throw OFIQError(ReturnCode::UnknownError, "Cannot map shared memory " + name);
+
+        std::unique_ptr<SharedMemoryRing> ring(
+            new SharedMemoryRing(name, static_cast<uint8_t*>(segment), segmentSize, false));
+        const auto* header = ring->m_header;
+        if (std::memcmp(header->magic, ringMagic, sizeof(ringMagic)) != 0 ||
+            header->slotCount == 0 || header->slotSize % slotAlignment != 0 ||
+            AlignSlot(sizeof(Header)) + header->slotCount * header->slotSize > segmentSize)
+            throw OFIQError(ReturnCode::UnknownError, "Invalid shared memory ring " + name);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return ring;
+    }
+
+    SharedMemoryRing::~SharedMemoryRing()
+    {
+        munmap(m_segment, m_segmentSize);
+        if (m_isOwner)
+            shm_unlink(m_name.c_str());
+    }
+#else
+    std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Create(const std::string&, uint32_t, uint64_t)
+    {
+        throw OFIQError(ReturnCode::NotImplemented, "Shared memory rings are not supported on Windows");
+    }
+
+    std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Open(const std::string&)
+    {
+        throw OFIQError(ReturnCode::NotImplemented, "Shared memory rings are not supported on Windows");
+    }
+
+    SharedMemoryRing::~SharedMemoryRing() = default;
+#endif
+
+    uint32_t SharedMemoryRing::GetSlotCount() const
+    {
+        return m_header->slotCount;
+    }
+
+    uint64_t SharedMemoryRing::GetSlotSize() const
+    {
+        return m_header->slotSize;
+    }
+
+    uint8_t* SharedMemoryRing::Slot(uint64_t index) const
+    {
+        return m_segment + AlignSlot(sizeof(Header)) + (index % m_header->slotCount) * m_header->slotSize;
+    }
+
+    uint8_t* SharedMemoryRing::TryAcquireWrite()
+    {
+        // only the producer modifies the write index
+        auto writeIndex = m_header->writeIndex.load(std::memory_order_relaxed);
+        if (writeIndex - m_header->readIndex.load(std::memory_order_acquire) >= m_header->slotCount)
+            return nullptr;
+        return Slot(writeIndex);
+    }
+
+    void SharedMemoryRing::CommitWrite()
+    {
+        auto writeIndex = m_header->writeIndex.load(std::memory_order_relaxed);
+        m_header->writeIndex.store(writeIndex + 1, std::memory_order_release);
+    }
+
+    const uint8_t* SharedMemoryRing::TryAcquireRead()
+    {
+        // only the consumer modifies the read index
+        auto readIndex = m_header->readIndex.load(std::memory_order_relaxed);
+        if (readIndex == m_header->writeIndex.load(std::memory_order_acquire))
+            return nullptr;
+        return Slot(readIndex);
+    }
+
+    void SharedMemoryRing::ReleaseRead()
+    {
+        auto readIndex = m_header->readIndex.load(std::memory_order_relaxed);
+        m_header->readIndex.store(readIndex + 1, std::memory_order_release);
+    }
+
+    void SharedMemoryRing::Close()
+    {
+        m_header->closed.store(1, std::memory_order_release);
+    }
+
+    bool SharedMemoryRing::IsClosed() const
+    {
+        return m_header->closed.load(std::memory_order_acquire) != 0;
+    }
+
+    Image wrapSharedMemoryFrame(const uint8_t* slot, uint64_t slotSize, uint64_t& sequence)
+    {
+        SharedMemoryFrame frame;
+        std::memcpy(&frame, slot, sizeof(frame));
+        sequence = frame.sequence;
+
+        auto pixelFormat = static_cast<PixelFormat>(frame.pixelFormat);
+        if (frame.width == 0 || frame.height == 0 || frame.pixelFormat > static_cast<uint32_t>(PixelFormat::GRAY))
+            throw OFIQError(ReturnCode::ImageReadingError, "Invalid shared memory frame");
+        uint64_t bytesPerRow = static_cast<uint64_t>(frame.width) * (pixelFormat == PixelFormat::GRAY ? 1 : 3);
+        uint64_t rowStride = frame.stride != 0 ? frame.stride : bytesPerRow;
+        if (rowStride < bytesPerRow ||
+            SharedMemoryFrame::pixelOffset + (frame.height - 1) * rowStride + bytesPerRow > slotSize)
+            throw OFIQError(ReturnCode::ImageReadingError, "Shared memory frame exceeds its slot");
+
+        // the pixels are only read, the slot is released after the assessment
+        return Image::borrow(
+            frame.width, frame.height, pixelFormat,
+            const_cast<uint8_t*>(slot + SharedMemoryFrame::pixelOffset), static_cast<size_t>(frame.stride));
+    }
+
+    void writeSharedMemoryResult(
+        uint8_t* slot,
+        uint64_t sequence,
+        const ReturnStatus& status,
+        const FaceImageQualityAssessment& assessments)
+    {
+        auto result = reinterpret_cast<SharedMemoryResult*>(slot);
+        result->sequence = sequence;
+        result->returnCode = static_cast<int32_t>(status.code);
+        uint32_t numMeasures = 0;
+        for (const auto& [measure, measureResult] : assessments.qAssessments)
+        {
+            if (numMeasures == SharedMemoryResult::maxMeasures)
+                break;
+            auto& entry = result->measures[numMeasures++];
+            entry.measure = static_cast<int32_t>(measure);
+            entry.code = static_cast<int32_t>(measureResult.code);
+            entry.rawScore = measureResult.rawScore;
+            entry.scalar = measureResult.scalar;
+        }
+        result->numMeasures = numMeasures;
+    }
+}
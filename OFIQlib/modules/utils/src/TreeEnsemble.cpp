@@ -0,0 +1,163 @@
+/**
+ * @file TreeEnsemble.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "TreeEnsemble.h"
+#include "OFIQError.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+
+namespace OFIQ_LIB
+{
+    TreeEnsemble::TreeEnsemble(const cv::ml::DTrees& model)
+        : m_varCount(model.getVarCount())
+    {
+        const auto& nodes = model.getNodes();
+        const auto& splits = model.getSplits();
+
+        // maps a node of the model to its flattened index, appending it with its subtree
+        std::vector<int32_t> stack;
+        auto flatten = [&](int modelRoot)
+            {
+                auto add = [&](int modelNode)
+                    {
+                        const auto& node = nodes[modelNode];
+                        if (node.split < 0)
+                        {
+                            m_leafValues.push_back(node.value);
+                            return ~static_cast<int32_t>(m_leafValues.size() - 1);
+                        }
+                        const auto& split = splits[node.split];
+                        if (split.subsetOfs >= 0)
+                            throw OFIQError(OFIQ::ReturnCode::UnknownError,
+                                "Tree ensembles with categorical splits are not supported");
+                        m_varIdx.push_back(split.varIdx);
+                        m_thresholds.push_back(split.c);
+                        // an inversed split sends the values less or equal to the threshold to the right
+                        m_children.push_back(split.inversed ? node.right : node.left);
+                        m_children.push_back(split.inversed ? node.left : node.right);
+                        stack.push_back(static_cast<int32_t>(m_varIdx.size() - 1));
+                        return static_cast<int32_t>(m_varIdx.size() - 1);
+                    };
+
+                int32_t root = add(modelRoot);
+                // the children of the internal nodes are replaced by their flattened indices
+                // in breadth first order, such that the upper levels of a tree are close together
+                for (size_t i = 0; i < stack.size(); i++)
+                {
+                    const int32_t n = stack[i];
+                    const int32_t left = add(m_children[2 * n]);
+                    const int32_t right = add(m_children[2 * n + 1]);
+                    m_children[2 * n] = left;
+                    m_children[2 * n + 1] = right;
+                }
+                stack.clear();
+                return root;
+            };
+
+        for (int root : model.getRoots())
+            m_roots.push_back(flatten(root));
+    }
+
+    float TreeEnsemble::PredictSum(const float* sample) const
+    {
+        const int32_t* varIdx = m_varIdx.data();
+        const float* thresholds = m_thresholds.data();
+        const int32_t* children = m_children.data();
+
+        // several trees descend interleaved, such that their memory accesses overlap
+        constexpr size_t interleave = 8;
+        double sum = 0;
+        for (size_t first = 0; first < m_roots.size(); first += interleave)
+        {
+            const size_t count = std::min(interleave, m_roots.size() - first);
+            int32_t nodes[interleave];
+            std::copy_n(m_roots.begin() + first, count, nodes);
+            for (bool descending = true; descending;)
+            {
+                descending = false;
+                for (size_t t = 0; t < count; t++)
+                {
+                    const int32_t node = nodes[t];
+                    if (node < 0)
+                        continue;
+                    // NaN descends to the right as in OpenCV
+                    nodes[t] = children[2 * node + !(sample[varIdx[node]] <= thresholds[node])];
+                    descending = true;
+                }
+            }
+            // the leaf values are added in the order of the trees as in OpenCV
+            for (size_t t = 0; t < count; t++)
+                sum += m_leafValues[~nodes[t]];
+        }
+        return static_cast<float>(sum);
+    }
+
+    bool TreeEnsemble::IsSupported(const cv::ml::DTrees& model)
+    {
+        const auto& splits = model.getSplits();
+        return std::none_of(splits.begin(), splits.end(),
+            [](const cv::ml::DTrees::Split& split) { return split.subsetOfs >= 0; });
+    }
+
+    bool TreeEnsemble::MatchesModel(const cv::ml::DTrees& model, int flags, int numSamples) const
+    {
+        if (model.getVarCount() != m_varCount)
+            return false;
+
+        // candidate values per feature: the thresholds and their neighbours
+        std::vector<std::vector<float>> candidates(static_cast<size_t>(m_varCount));
+        for (size_t n = 0; n < m_varIdx.size(); n++)
+        {
+            if (m_varIdx[n] < 0 || m_varIdx[n] >= m_varCount)
+                return false;
+            auto& values = candidates[m_varIdx[n]];
+            values.push_back(m_thresholds[n]);
+            values.push_back(std::nextafter(m_thresholds[n], -FLT_MAX));
+            values.push_back(std::nextafter(m_thresholds[n], FLT_MAX));
+        }
+
+        std::mt19937 generator(29794);
+        std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+        cv::Mat sample(1, m_varCount, CV_32F);
+        cv::Mat result;
+        for (int i = 0; i < numSamples; i++)
+        {
+            for (int v = 0; v < m_varCount; v++)
+            {
+                const auto& values = candidates[v];
+                sample.at<float>(0, v) = values.empty() ? uniform(generator) :
+                    values[std::uniform_int_distribution<size_t>(0, values.size() - 1)(generator)];
+            }
+            model.predict(sample, result, flags);
+            if (result.at<float>(0, 0) != PredictSum(sample.ptr<float>(0)))
+                return false;
+        }
+        return true;
+    }
+}
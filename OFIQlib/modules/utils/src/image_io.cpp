@@ -49,13 +49,15 @@ namespace OFIQ_LIB
             return ReturnStatus(retCode, retStatusInfo);
         }
 
-        cv::cvtColor(cvImage, cvImage, cv::COLOR_BGR2RGB);
+        // The decoded pixels are used as they are, i.e. in BGR order. The image
+        // shares the ownership of the OpenCV matrix holding the pixel data.
+        auto pixels = std::make_shared<cv::Mat>(cvImage);
         image.width = static_cast<uint16_t>(cvImage.cols);
         image.height = static_cast<uint16_t>(cvImage.rows);
         image.depth = 24;
-
-        image.data = std::shared_ptr<uint8_t>(new uint8_t[image.size()], std::default_delete<uint8_t[]>());
-        memcpy(image.data.get(), cvImage.data, image.size());
+        image.pixelFormat = PixelFormat::BGR;
+        image.stride = cvImage.step;
+        image.data = std::shared_ptr<uint8_t>(pixels, pixels->data);
 
         return ReturnStatus(retCode, retStatusInfo);
     }
@@ -57,15 +57,20 @@ namespace OFIQ_LIB
     }
 
     void ConvertBGRToCIELAB(const cv::Mat& rgbImage, double& a, double& b)
+    {
+        std::vector<cv::Mat> channels;
+        cv::split(rgbImage, channels);
+        ConvertMeanBGRToCIELAB(mean(channels[0])[0], mean(channels[1])[0], mean(channels[2])[0], a, b);
+    }
+
+    void ConvertMeanBGRToCIELAB(double meanB, double meanG, double meanR, double& a, double& b)
     {
         double k = 24289 / 27.0;
         double eps = 216 / 24389.0;
 
-        std::vector<cv::Mat> channels;
-        cv::split(rgbImage, channels);
-        double R = mean(channels[2])[0] / 255.0;
-        double G = mean(channels[1])[0] / 255.0;
-        double B = mean(channels[0])[0] / 255.0;
+        double R = meanR / 255.0;
+        double G = meanG / 255.0;
+        double B = meanB / 255.0;
 
         double R_L = ColorConvert(R);
         double G_L = ColorConvert(G);
@@ -113,6 +118,24 @@ namespace OFIQ_LIB
         return L;
 	}
 
+	cv::Mat GetLuminanceImage(const cv::Mat& image)
+	{
+        if (image.channels() != 1)
+            return GetLuminanceImageFromBGR(image);
+
+        static const cv::Mat lookUpTable = []()
+        {
+            cv::Mat grayValues(1, 256, CV_8UC3);
+            for (int v = 0; v < 256; v++)
+                grayValues.at<cv::Vec3b>(0, v) = cv::Vec3b((uchar)v, (uchar)v, (uchar)v);
+            return GetLuminanceImageFromBGR(grayValues);
+        }();
+
+        cv::Mat L;
+        cv::LUT(image, lookUpTable, L);
+        return L;
+	}
+
     void CalculateReferencePoints(const OFIQ::FaceLandmarks& landmarks, OFIQ::LandmarkPoint& leftEyeCenter, OFIQ::LandmarkPoint& rightEyeCenter,
         double& interEyeDistance, double& eyeMouthDistance)
     {
@@ -161,12 +184,12 @@ namespace OFIQ_LIB
 
         cv::Mat faceOcclusionMask = session.getFaceOcclusionSegmentationImage();
         cv::Mat faceMask = session.getAlignedFaceLandmarkedRegion();
-        auto alignedImage = session.getAlignedFace();
+        auto alignedImage = session.getAlignedFaceNative();
 
         cv::Mat maskedImage;
         cv::bitwise_and(faceMask, faceOcclusionMask, maskedImage);
 
-        auto luminanceImage = GetLuminanceImageFromBGR(alignedImage);
+        auto luminanceImage = GetLuminanceImage(alignedImage);
 
         quality = ComputeBrightnessAspect(
             luminanceImage, maskedImage, exposureRange
@@ -26,18 +26,21 @@
 
 
 #include "utils.h"
+#include "Configuration.h"
 #include "FaceParts.h"
 #include "OFIQError.h"
 #include "PartExtractor.h"
 
 #include <algorithm>
 #include <cmath>
+#include <mutex>
 
 #include <opencv2/opencv.hpp>
 #include <opencv2/calib3d.hpp>
 #include <opencv2/core.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
+#include <onnxruntime_cxx_api.h>
 
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -192,49 +195,92 @@ namespace OFIQ_LIB
         return {width, height, 8, data};
     }
 
+    namespace
+    {
+        /**
+         * @brief Converts pixels given in the pixel format of sourceImage to BGR or to gray scale.
+         * If target has the expected size and type, the pixels are written into its memory.
+         */
+        void convertPixels(
+            const cv::Mat& source,
+            cv::Mat& target,
+            const OFIQ::Image& sourceImage,
+            bool asGrayImage)
+        {
+            if (sourceImage.depth != 24)
+            {
+                if (asGrayImage)
+                    source.copyTo(target);
+                else
+                    cv::cvtColor(source, target, cv::COLOR_GRAY2BGR);
+            }
+            else if (sourceImage.pixelFormat == OFIQ::PixelFormat::BGR)
+            {
+                if (asGrayImage)
+                    cv::cvtColor(source, target, cv::COLOR_BGR2GRAY);
+                else
+                    source.copyTo(target);
+            }
+            else
+            {
+                if (asGrayImage)
+                    cv::cvtColor(source, target, cv::COLOR_RGB2GRAY);
+                else
+                    cv::cvtColor(source, target, cv::COLOR_RGB2BGR);
+            }
+        }
+    }
+
     OFIQ_EXPORT cv::Mat copyToCvImage(const OFIQ::Image& sourceImage, bool asGrayImage)
     {
-        bool isRGB = sourceImage.depth == 24;
+        cv::Mat cvImage;
+        convertPixels(wrapToCvImage(sourceImage), cvImage, sourceImage, asGrayImage);
+        return cvImage;
+    }
 
-        cv::Mat cvImage(sourceImage.height, sourceImage.width, isRGB ? CV_8UC3 : CV_8UC1);
+    OFIQ_EXPORT cv::Mat wrapToCvImage(const OFIQ::Image& sourceImage)
+    {
+        bool isColor = sourceImage.depth == 24;
+        return cv::Mat(
+            sourceImage.height,
+            sourceImage.width,
+            isColor ? CV_8UC3 : CV_8UC1,
+            sourceImage.data.get(),
+            sourceImage.rowStride());
+    }
 
-        memcpy(cvImage.data, (char*)sourceImage.data.get(), sourceImage.size());
+    OFIQ_EXPORT cv::Mat copyRegionToCvImage(
+        const OFIQ::Image& sourceImage,
+        const OFIQ::BoundingBox& region,
+        bool asGrayImage)
+    {
+        cv::Mat sourceView = wrapToCvImage(sourceImage);
 
-        if (!isRGB && !asGrayImage)
-            cv::cvtColor(cvImage, cvImage, cv::COLOR_GRAY2BGR);
-        else if (isRGB && !asGrayImage)
-            cv::cvtColor(cvImage, cvImage, cv::COLOR_RGB2BGR);
-        else if (isRGB && asGrayImage)
-            cv::cvtColor(cvImage, cvImage, cv::COLOR_RGB2GRAY);
-        else if (!isRGB && asGrayImage)
-        {
-            // Then no work is necessary
-        }
+        cv::Rect regionRect(region.xleft, region.ytop, region.width, region.height);
+        cv::Rect insideRect = regionRect & cv::Rect(0, 0, sourceView.cols, sourceView.rows);
+
+        cv::Mat cvImage = cv::Mat::zeros(regionRect.size(), asGrayImage ? CV_8UC1 : CV_8UC3);
+        if (insideRect.empty())
+            return cvImage;
+
+        // only the part of the region which is covered by the image is copied and converted
+        cv::Mat targetRegion = cvImage(insideRect - regionRect.tl());
+        convertPixels(sourceView(insideRect), targetRegion, sourceImage, asGrayImage);
 
         return cvImage;
     }
 
-    OFIQ_EXPORT cv::Mat alignImage(
-        const OFIQ::Image& faceImage,
-        const OFIQ::FaceLandmarks& faceLandmarks,
-        OFIQ::FaceLandmarks& alignedFaceLandmarks,
-        cv::Mat& transformationMatrix)
+    OFIQ_EXPORT cv::Mat calculateAlignmentTransformation(const OFIQ::FaceLandmarks& faceLandmarks)
     {
-        cv::Mat bgrCvImage = copyToCvImage(faceImage);
         int nose;
         int leftMouth;
         int rightMouth;
-        std::vector<cv::Point2f> landmarks;
-        std::vector<cv::Point2f> alignedLandmarks;
 
         if (faceLandmarks.type == OFIQ::LandmarkType::LM_98)
         {
             nose = 54;
             leftMouth = 82;
             rightMouth = 76;
-            int num_landmarks = 98;
-            landmarks.reserve(num_landmarks);
-            alignedLandmarks.reserve(num_landmarks);
         }
         else
             throw std::invalid_argument("Unknown LandmarkType");
@@ -260,10 +306,42 @@ namespace OFIQ_LIB
         // define reference points
         std::array<float, 10> refData = {251, 272, 364, 272, 308, 336, 262, 402, 355, 402};
         auto refPoints = cv::Mat(5, 2, CV_32F, refData.data());
-        // calculate transformation matrix and warp image
-        transformationMatrix = cv::estimateAffinePartial2D(srcPoints, refPoints, {}, cv::LMEDS);
+        // calculate transformation matrix
+        return cv::estimateAffinePartial2D(srcPoints, refPoints, {}, cv::LMEDS);
+    }
+
+    OFIQ_EXPORT cv::Mat warpToAlignedImage(
+        const OFIQ::Image& faceImage,
+        const cv::Mat& transformationMatrix,
+        bool keepGrayScale)
+    {
+        // warp the source pixels directly and convert only the aligned image to BGR
+        cv::Mat alignedImage;
+        cv::warpAffine(wrapToCvImage(faceImage), alignedImage, transformationMatrix, cv::Size(616, 616));
+        if ((faceImage.depth == 24 && faceImage.pixelFormat == OFIQ::PixelFormat::BGR) ||
+            (faceImage.depth == 8 && keepGrayScale))
+            return alignedImage;
+
         cv::Mat bgrAlignedImage;
-        cv::warpAffine(bgrCvImage, bgrAlignedImage, transformationMatrix, cv::Size(616, 616));
+        convertPixels(alignedImage, bgrAlignedImage, faceImage, false);
+        return bgrAlignedImage;
+    }
+
+    OFIQ_EXPORT cv::Mat alignImage(
+        const OFIQ::Image& faceImage,
+        const OFIQ::FaceLandmarks& faceLandmarks,
+        OFIQ::FaceLandmarks& alignedFaceLandmarks,
+        cv::Mat& transformationMatrix,
+        bool keepGrayScale)
+    {
+        std::vector<cv::Point2f> landmarks;
+        std::vector<cv::Point2f> alignedLandmarks;
+        landmarks.reserve(faceLandmarks.landmarks.size());
+        alignedLandmarks.reserve(faceLandmarks.landmarks.size());
+
+        transformationMatrix = calculateAlignmentTransformation(faceLandmarks);
+        cv::Mat alignedImage = warpToAlignedImage(faceImage, transformationMatrix, keepGrayScale);
+
         for (auto landmark : faceLandmarks.landmarks)
         {
             landmarks.push_back({ static_cast<float>(landmark.x), static_cast<float>(landmark.y) });
@@ -276,7 +354,7 @@ namespace OFIQ_LIB
             landmark.y = static_cast<uint16_t>(round(p.y));
             alignedFaceLandmarks.landmarks.push_back(landmark);
         }
-        return bgrAlignedImage;
+        return alignedImage;
     }
 
     OFIQ_EXPORT void calculateEyeCenter(
@@ -304,4 +382,56 @@ namespace OFIQ_LIB
 
         return static_cast<float>(cv::norm(chin - eyeMidpoint));
     }
+
+    namespace
+    {
+        std::mutex onnxRuntimeThreadingMutex;
+        OnnxRuntimeThreading onnxRuntimeThreading;
+    }
+
+    void setOnnxRuntimeThreading(const OnnxRuntimeThreading& threading)
+    {
+        std::lock_guard<std::mutex> lock(onnxRuntimeThreadingMutex);
+        onnxRuntimeThreading = threading;
+    }
+
+    OnnxRuntimeThreading getOnnxRuntimeThreading()
+    {
+        std::lock_guard<std::mutex> lock(onnxRuntimeThreadingMutex);
+        return onnxRuntimeThreading;
+    }
+
+    OnnxRuntimeThreading getOnnxRuntimeThreading(const Configuration& config)
+    {
+        static const std::string intraOpThreadsParamPath = "params.onnxruntime.intra_op_threads";
+        static const std::string interOpThreadsParamPath = "params.onnxruntime.inter_op_threads";
+
+        auto threading = getOnnxRuntimeThreading();
+        double numThreads = 0;
+        if (config.GetNumber(intraOpThreadsParamPath, numThreads))
+            threading.intraOpThreads = static_cast<int>(numThreads);
+        if (config.GetNumber(interOpThreadsParamPath, numThreads))
+            threading.interOpThreads = static_cast<int>(numThreads);
+        return threading;
+    }
+
+    Ort::SessionOptions CreateOnnxRuntimeSessionOptions(const OnnxRuntimeThreading& threading)
+    {
+        Ort::SessionOptions options;
+        if (threading.forkSafe)
+        {
+            // thread pools do not survive a fork; with a single thread the operators run in the calling thread
+            options.SetIntraOpNumThreads(1);
+            options.SetInterOpNumThreads(1);
+            options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+            // an arena would be grown by each forked process separately and never shrink
+            options.DisableCpuMemArena();
+        }
+        else
+        {
+            options.SetIntraOpNumThreads(threading.intraOpThreads);
+            options.SetInterOpNumThreads(threading.interOpThreads);
+        }
+        return options;
+    }
 }
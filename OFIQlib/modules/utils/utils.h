@@ -40,6 +40,17 @@ namespace cv
     class Mat;
 }
 
+/**
+ * @brief ONNXRuntime's namespace.
+ */
+namespace Ort
+{
+    /**
+     * @brief Forward declaration of the ONNXRuntime class Ort::SessionOptions.
+     */
+    struct SessionOptions;
+}
+
 /**
  * @brief Representation of a point with floating point arithmetics.
  * 
@@ -54,6 +65,8 @@ struct Point2f
 
 namespace OFIQ_LIB
 {
+    class Configuration;
+
     /**
      * @brief Representation of a point with integer arithmetics.
      * 
@@ -105,7 +118,7 @@ namespace OFIQ_LIB
         const std::vector<OFIQ::BoundingBox>& faceRects);
 
     /**
-     * @brief Convert images in OFIQ::Image format into the OpenCV cv::Mat format. The image can be converted from color to gray scale by setting the parameter asGrayImage to true.
+     * @brief Convert images in OFIQ::Image format into the OpenCV cv::Mat format with BGR channel order. The image can be converted from color to gray scale by setting the parameter asGrayImage to true.
      * 
      * @param sourceImage Input image.
      * @param asGrayImage Switch for adding gray scale conversion.
@@ -113,6 +126,57 @@ namespace OFIQ_LIB
      */
     OFIQ_EXPORT cv::Mat copyToCvImage(const OFIQ::Image& sourceImage, bool asGrayImage = false);
 
+    /**
+     * @brief Creates an OpenCV header referencing the pixel data of an image in OFIQ::Image format without copying them.
+     * The channel order and the row stride are the ones of the source image, i.e. three channels in the order given by
+     * OFIQ::Image::pixelFormat for color images and a single channel for gray scale images.
+     * The returned matrix shares the memory of the source image: it must not outlive the source image and must not be modified.
+     * 
+     * @param sourceImage Input image.
+     * @return cv::Mat Header referencing the pixel data of the input image.
+     */
+    OFIQ_EXPORT cv::Mat wrapToCvImage(const OFIQ::Image& sourceImage);
+
+    /**
+     * @brief Copies a rectangular region of an image in OFIQ::Image format into the OpenCV cv::Mat format.
+     * Only the pixels inside the region are copied and converted, either to BGR or to gray scale if asGrayImage is true.
+     * Parts of the region lying outside the image are filled with black, which is the same as cropping the region
+     * from an image that has been padded with a black border beforehand.
+     * 
+     * @param sourceImage Input image.
+     * @param region Region to be copied, may exceed the image borders.
+     * @param asGrayImage Switch for adding gray scale conversion.
+     * @return cv::Mat Copied region in cv::Mat format with the size of the region.
+     */
+    OFIQ_EXPORT cv::Mat copyRegionToCvImage(
+        const OFIQ::Image& sourceImage,
+        const OFIQ::BoundingBox& region,
+        bool asGrayImage = false);
+
+    /**
+     * @brief Computes the similarity transformation used for the face alignment, see \link OFIQ_LIB::alignImage() alignImage()\endlink.
+     * The eye centers, the nose tip and the mouth corners are mapped to pre-defined positions in an image with a resolution of 616x616.
+     * 
+     * @param faceLandmarks Face landmarks, based on the face represented in the input image.
+     * @return cv::Mat 2x3 transformation matrix.
+     */
+    OFIQ_EXPORT cv::Mat calculateAlignmentTransformation(const OFIQ::FaceLandmarks& faceLandmarks);
+
+    /**
+     * @brief Warps a face image with an alignment transformation, see \link OFIQ_LIB::alignImage() alignImage()\endlink.
+     * 
+     * @param faceImage Input image.
+     * @param transformationMatrix 2x3 transformation matrix as computed by
+     * \link OFIQ_LIB::calculateAlignmentTransformation() calculateAlignmentTransformation()\endlink.
+     * @param keepGrayScale If true and the input is a gray scale image (depth 8), the aligned image is
+     * returned as single channel image instead of being replicated to BGR.
+     * @return cv::Mat Aligned face image with a resolution of 616x616.
+     */
+    OFIQ_EXPORT cv::Mat warpToAlignedImage(
+        const OFIQ::Image& faceImage,
+        const cv::Mat& transformationMatrix,
+        bool keepGrayScale = false);
+
     /**
      * @brief This function transforms a face image so that the position of the eyes, nose and mouth are roughly at a pre-defined position. Face alignment is the translation, rotation and scaling of the image to do this.
      * 
@@ -120,13 +184,16 @@ namespace OFIQ_LIB
      * @param faceLandmarks  Face landmarks, based on the face represented in the input image.
      * @param alignedFaceLandmarks  Face landmarks of the aligned face image.
      * @param transformationMatrix Transformation matrix used to transform the landmarks.
+     * @param keepGrayScale If true and the input is a gray scale image (depth 8), the aligned image is
+     * returned as single channel image instead of being replicated to BGR.
      * @return cv::Mat Aligned face image with a resolution of 616x616.
      */
     OFIQ_EXPORT cv::Mat alignImage(
         const OFIQ::Image& faceImage,
         const OFIQ::FaceLandmarks& faceLandmarks,
         OFIQ::FaceLandmarks& alignedFaceLandmarks,
-        cv::Mat& transformationMatrix);
+        cv::Mat& transformationMatrix,
+        bool keepGrayScale = false);
 
     /**
      * @brief Based on face landmarks the center of the left and right eye are computed.
@@ -156,6 +223,64 @@ namespace OFIQ_LIB
      * @return float Computed distance.
      */
     OFIQ_EXPORT float tmetric(const OFIQ::FaceLandmarks& faceLandmarks);
+
+    /**
+     * @brief Threading of the ONNXRuntime sessions.
+     */
+    struct OnnxRuntimeThreading
+    {
+        /**
+         * @brief Number of threads used within an operator, 0 for the ONNXRuntime default.
+         */
+        int intraOpThreads = 0;
+
+        /**
+         * @brief Number of threads running independent operators concurrently, 0 for the ONNXRuntime default.
+         */
+        int interOpThreads = 0;
+
+        /**
+         * @brief If true, the sessions create no thread pools and no memory arena, such that the
+         * process can be forked after the initialization. Overrides the numbers of threads.
+         */
+        bool forkSafe = false;
+    };
+
+    /**
+     * @brief Sets the default threading of the ONNXRuntime sessions created subsequently, e.g. by
+     * \link OFIQ::Interface::initialize() initialize()\endlink.
+     * @details The numbers of threads can be overridden by the configuration of an instance,
+     * see \link OFIQ_LIB::getOnnxRuntimeThreading(const Configuration&) getOnnxRuntimeThreading()\endlink.
+     * 
+     * @param threading Threading of the sessions.
+     */
+    OFIQ_EXPORT void setOnnxRuntimeThreading(const OnnxRuntimeThreading& threading);
+
+    /**
+     * @brief Returns the threading set by \link OFIQ_LIB::setOnnxRuntimeThreading() setOnnxRuntimeThreading()\endlink.
+     * 
+     * @return OnnxRuntimeThreading Threading of the ONNXRuntime sessions.
+     */
+    OFIQ_EXPORT OnnxRuntimeThreading getOnnxRuntimeThreading();
+
+    /**
+     * @brief Returns the threading of the ONNXRuntime sessions of an instance.
+     * @details The numbers of threads given by <code>params.onnxruntime.intra_op_threads</code> and
+     * <code>params.onnxruntime.inter_op_threads</code> of the configuration override the default set by
+     * \link OFIQ_LIB::setOnnxRuntimeThreading() setOnnxRuntimeThreading()\endlink; the fork safety is kept.
+     * 
+     * @param config Configuration of the instance.
+     * @return OnnxRuntimeThreading Threading of the ONNXRuntime sessions of the instance.
+     */
+    OFIQ_EXPORT OnnxRuntimeThreading getOnnxRuntimeThreading(const Configuration& config);
+
+    /**
+     * @brief Creates the options of an ONNXRuntime session with the specified threading.
+     * 
+     * @param threading Threading of the session.
+     * @return Ort::SessionOptions Options for a new session.
+     */
+    Ort::SessionOptions CreateOnnxRuntimeSessionOptions(const OnnxRuntimeThreading& threading);
 }
 
 #endif
\ No newline at end of file
@@ -31,7 +31,11 @@
 #include "FaceMeasures.h"
 #include "utils.h"
 #include "image_io.h"
+#include "EncodedImage.h"
+#include "ArtifactStore.h"
+#include <algorithm>
 #include <chrono>
+#include <filesystem>
 using hrclock = std::chrono::high_resolution_clock;
 
 using namespace std;
@@ -39,6 +43,75 @@ using namespace OFIQ;
 using namespace OFIQ_LIB;
 using namespace OFIQ_LIB::modules::measures;
 
+namespace
+{
+    /**
+     * @brief Minimal length of the shorter side of the down-scaled image used for the face detection.
+     * The SSD face detector works on an input of 300x300 pixels.
+     */
+    const int detectionImageMinimalSize = 300;
+
+    /**
+     * @brief Clip a rectangle to the image and convert it to a bounding box.
+     */
+    BoundingBox ClipToImage(const cv::Rect& rect, const OFIQ::Image& image)
+    {
+        cv::Rect clipped = rect & cv::Rect(0, 0, image.width, image.height);
+        return BoundingBox(
+            static_cast<int16_t>(clipped.x),
+            static_cast<int16_t>(clipped.y),
+            static_cast<int16_t>(clipped.width),
+            static_cast<int16_t>(clipped.height),
+            FaceDetectorType::NotSet);
+    }
+
+    /**
+     * @brief Region of the input image covering the face crops of the pose estimation and the
+     * landmark extraction, i.e. the squared face bounding box with a margin of 10%.
+     */
+    BoundingBox GetFaceCropRegion(const OFIQ::Image& image, const BoundingBox& face)
+    {
+        auto square = makeSquareBoundingBox(face);
+        int margin = square.width / 10 + 1;
+        return ClipToImage(
+            cv::Rect(square.xleft - margin, square.ytop - margin, square.width + 2 * margin, square.height + 2 * margin),
+            image);
+    }
+
+    /**
+     * @brief Region of the input image covering the face alignment as well as the face region
+     * derived from the landmarks of the input image, e.g. used by the sharpness measure.
+     */
+    BoundingBox GetAlignmentRegion(const OFIQ::Image& image, const FaceLandmarks& landmarks, double alpha)
+    {
+        std::vector<cv::Point> landmarkPoints;
+        for (const auto& landmark : landmarks.landmarks)
+            landmarkPoints.emplace_back(landmark.x, landmark.y);
+        cv::Rect region = cv::boundingRect(landmarkPoints);
+        // the face region can be extended at the forehead by alpha times the distance of eyes and chin
+        auto margin = static_cast<int>(region.height * (0.1 + 1.5 * std::max(alpha, 0.0)));
+        region -= cv::Point(margin, margin);
+        region += cv::Size(2 * margin, 2 * margin);
+
+        cv::Mat transformationMatrix = calculateAlignmentTransformation(landmarks);
+        if (!transformationMatrix.empty())
+        {
+            cv::Mat inverseMatrix;
+            cv::invertAffineTransform(transformationMatrix, inverseMatrix);
+            std::vector<cv::Point2f> alignedCorners = { {0, 0}, {616, 0}, {0, 616}, {616, 616} };
+            std::vector<cv::Point2f> corners;
+            cv::transform(alignedCorners, corners, inverseMatrix);
+            cv::Rect alignedRegion = cv::boundingRect(corners);
+            // one additional pixel for the bilinear interpolation
+            alignedRegion -= cv::Point(1, 1);
+            alignedRegion += cv::Size(2, 2);
+            region |= alignedRegion;
+        }
+
+        return ClipToImage(region, image);
+    }
+}
+
 
 OFIQImpl::OFIQImpl():m_emptySession({this->dummyImage, this->dummyAssement}) {}
 
@@ -49,6 +122,7 @@ ReturnStatus OFIQImpl::initialize(const std::string& configDir, const std::strin
         this->config = std::make_unique<Configuration>(configDir, configFilename);
         CreateNetworks();
         m_executorPtr = CreateExecutor();
+        CreateResultCache();
     }
     catch (const OFIQError & ex)
     {
@@ -95,6 +169,17 @@ void OFIQImpl::performPreprocessing(Session& session)
 {
     std::chrono::time_point<hrclock> tic;
 
+    static const std::string alphaParamPath = "params.measures.FaceRegion.alpha";
+    double alpha = 0.0f;
+    try
+    {
+        alpha = this->config->GetNumber(alphaParamPath);
+    }
+    catch(OFIQError&)
+    {
+        alpha = 0.0f;
+    }
+
     log("\t1. detectFaces ");
     tic = hrclock::now();
 
@@ -109,6 +194,9 @@ void OFIQImpl::performPreprocessing(Session& session)
             hrclock::now() - tic).count()) + std::string(" ms "));
 
     session.setDetectedFaces(faces);
+    // only relevant if the image is decoded on demand
+    session.requireImageRegion(GetFaceCropRegion(session.image(), faces[0]));
+
     log("2. estimatePose ");
     tic = hrclock::now();
 
@@ -129,6 +217,7 @@ void OFIQImpl::performPreprocessing(Session& session)
 
     log("4. alignFaceImage ");
     tic = hrclock::now();
+    session.requireImageRegion(GetAlignmentRegion(session.image(), session.getLandmarks(), alpha));
     // aligned face requires the landmarks of the face thus it must come after the landmark extraction.
     alignFaceImage(session);
     log(std::to_string(
@@ -158,25 +247,16 @@ void OFIQImpl::performPreprocessing(Session& session)
         std::chrono::duration_cast<std::chrono::milliseconds>(
             hrclock::now() - tic).count()) + std::string(" ms "));
 
-    static const std::string alphaParamPath = "params.measures.FaceRegion.alpha";
-    double alpha = 0.0f;
-    try
-    {
-        alpha = this->config->GetNumber(alphaParamPath);
-    }
-    catch(OFIQError&)
-    {
-        alpha = 0.0f;
-    }
-
     log("7. getAlignedFaceMask ");
     tic = hrclock::now();
 
+    const cv::Size alignedFaceSize = session.getAlignedFaceSize();
     session.setAlignedFaceLandmarkedRegion(
          OFIQ_LIB::modules::landmarks::FaceMeasures::GetFaceMask(
+            session,
             session.getAlignedFaceLandmarks(),
-            session.getAlignedFace().rows,
-            session.getAlignedFace().cols,
+            alignedFaceSize.height,
+            alignedFaceSize.width,
             (float)alpha
          )
     );
@@ -193,23 +273,183 @@ void OFIQImpl::alignFaceImage(Session& session) const
     OFIQ::FaceLandmarks alignedFaceLandmarks;
     alignedFaceLandmarks.type = landmarks.type;
     cv::Mat transformationMatrix;
-    cv::Mat alignedBGRimage = alignImage(session.image(), landmarks, alignedFaceLandmarks, transformationMatrix);
 
-    session.setAlignedFace(alignedBGRimage);
+    cv::Mat alignedImage = alignImage(
+        session.image(), landmarks, alignedFaceLandmarks, transformationMatrix, keepGrayScale());
+
+    session.setAlignedFace(alignedImage);
     session.setAlignedFaceLandmarks(alignedFaceLandmarks);
     session.setAlignedFaceTransformationMatrix(transformationMatrix);
 
 }
 
+bool OFIQImpl::keepGrayScale() const
+{
+    // gray scale input may be kept single channel; networks replicate the channels on demand
+    static const std::string keepGrayScaleParamPath = "params.preprocessing.keep_gray_scale";
+    bool keepGrayScale = false;
+    config->GetBool(keepGrayScaleParamPath, keepGrayScale);
+    return keepGrayScale;
+}
+
+void OFIQImpl::restorePreprocessing(Session& session, const uint8_t* artifacts, size_t artifactsSize) const
+{
+    if (artifactsSize == 0)
+        throw OFIQError(ReturnCode::FaceDetectionError, "No faces were detected");
+
+    try
+    {
+        // the artifacts outlive the session, thus the matrices can refer to them
+        session.deserialize(artifacts, artifactsSize, false);
+        if (!session.hasAlignedFace())
+            session.setAlignedFace(warpToAlignedImage(
+                session.image(), session.getAlignedFaceTransformationMatrix(), keepGrayScale()));
+    }
+    catch (const OFIQError&)
+    {
+        throw;
+    }
+    catch (const std::exception& e)
+    {
+        // e.g. allocation failures or OpenCV errors on corrupt artifacts are reported as failed pre-processing
+        throw OFIQError(ReturnCode::UnknownError, std::string("Cannot restore the artifacts: ") + e.what());
+    }
+}
+
+void OFIQImpl::CreateResultCache()
+{
+    static const std::string capacityParamPath = "params.result_cache.capacity";
+    static const std::string fileParamPath = "params.result_cache.file";
+
+    m_resultCache.reset();
+    double capacity = 0;
+    if (!config->GetNumber(capacityParamPath, capacity) || capacity < 1)
+        return;
+
+    std::string persistencePath;
+    if (config->GetString(fileParamPath, persistencePath) && !persistencePath.empty() &&
+        std::filesystem::path(persistencePath).is_relative())
+        persistencePath = (std::filesystem::path(config->getDataDir()) / persistencePath).string();
+
+    // the models are referenced relative to the data directory, thus it is part of the fingerprint
+    std::string configString = config->getDataDir() + "\n" + config->ToString();
+    m_resultCache = std::make_unique<ResultCache>(
+        static_cast<size_t>(capacity),
+        ResultCache::HashBytes(configString.data(), configString.size()),
+        persistencePath);
+}
+
 ReturnStatus OFIQImpl::vectorQuality(
     const OFIQ::Image& image, OFIQ::FaceImageQualityAssessment& assessments)
 {
+    uint64_t cacheKey = 0;
+    if (m_resultCache)
+    {
+        cacheKey = ResultCache::HashImage(image, m_resultCache->GetConfigFingerprint());
+        if (m_resultCache->Lookup(cacheKey, assessments))
+            return ReturnStatus(ReturnCode::Success);
+    }
+
     auto session = Session(image, assessments);
+    auto result = assessQuality(session);
+    if (m_resultCache && result.code == ReturnCode::Success)
+        m_resultCache->Insert(cacheKey, assessments);
+    return result;
+}
+
+ReturnStatus OFIQImpl::vectorQualityFromEncodedImage(
+    const std::vector<uint8_t>& encodedImage, OFIQ::FaceImageQualityAssessment& assessments)
+{
+    uint64_t cacheKey = 0;
+    if (m_resultCache)
+    {
+        cacheKey = ResultCache::HashBytes(
+            encodedImage.data(), encodedImage.size(), m_resultCache->GetConfigFingerprint());
+        if (m_resultCache->Lookup(cacheKey, assessments))
+            return ReturnStatus(ReturnCode::Success);
+    }
+
+    try
+    {
+        EncodedImage image(encodedImage);
+        auto session = Session(image.image(), assessments);
+        if (image.SupportsRegionDecoding())
+        {
+            int scaleDenominator = 1;
+            OFIQ::Image detectionImage = image.DecodeThumbnail(detectionImageMinimalSize, scaleDenominator);
+            session.setDetectionImage(detectionImage, scaleDenominator);
+            session.setImageRegionLoader(
+                [&image](const OFIQ::BoundingBox& region) { image.DecodeRegion(region); });
+        }
+        auto result = assessQuality(session);
+        if (m_resultCache && result.code == ReturnCode::Success)
+            m_resultCache->Insert(cacheKey, assessments);
+        return result;
+    }
+    catch (const OFIQError& e)
+    {
+        return { e.whatCode(), e.what() };
+    }
+}
 
+ReturnStatus OFIQImpl::rescoreQuality(OFIQ::FaceImageQualityAssessment& assessments)
+{
+    try
+    {
+        m_executorPtr->RescoreAll(assessments);
+    }
+    catch (const OFIQError& e)
+    {
+        return { e.whatCode(), e.what() };
+    }
+    catch (const std::exception& e)
+    {
+        return { ReturnCode::UnknownError, e.what() };
+    }
+
+    return ReturnStatus(ReturnCode::Success);
+}
+
+ReturnStatus OFIQImpl::vectorQualityWithArtifacts(
+    const OFIQ::Image& image,
+    OFIQ::FaceImageQualityAssessment& assessments,
+    std::vector<uint8_t>& artifacts)
+{
+    artifacts.clear();
+    bool isPreprocessed = false;
+    auto session = Session(image, assessments);
+    auto result = assessQuality(session, [this, &isPreprocessed](Session& s)
+        {
+            performPreprocessing(s);
+            isPreprocessed = true;
+        });
+    if (isPreprocessed)
+        artifacts = session.serialize();
+    return result;
+}
+
+ReturnStatus OFIQImpl::vectorQualityFromArtifacts(
+    const OFIQ::Image& image,
+    const uint8_t* artifacts,
+    size_t artifactsSize,
+    OFIQ::FaceImageQualityAssessment& assessments)
+{
+    auto session = Session(image, assessments);
+    return assessQuality(session, [this, artifacts, artifactsSize](Session& s)
+        {
+            restorePreprocessing(s, artifacts, artifactsSize);
+        });
+}
+
+ReturnStatus OFIQImpl::assessQuality(Session& session, const std::function<void(Session&)>& preprocessing)
+{
     try
     {
         log("perform preprocessing:\n");
-        performPreprocessing(session);
+        if (preprocessing)
+            preprocessing(session);
+        else
+            performPreprocessing(session);
     }
     catch (const OFIQError& e)
     {
@@ -29,8 +29,11 @@
 #endif
 
 #include "ofiq_lib.h"
+#include "OFIQSampleServer.h"
 #include "image_io.h"
 #include "utils.h"
+#include "ArtifactStore.h"
+#include "ColumnarResults.h"
 
 #include <cstring>
 #include <fstream>
@@ -42,10 +45,18 @@
 #include <magic_enum.hpp>
 #include <filesystem>
 #include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 
-constexpr int SUCCESS = 0;
-constexpr int FAILURE = 1;
-
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <opencv2/core.hpp>
+#endif
 
 namespace fs = std::filesystem;
 
@@ -57,192 +68,825 @@ using namespace OFIQ_LIB;
 int getQualityAssessmentResults(
     const std::shared_ptr<Interface>& implPtr,
     const string& inputFile,
-    FaceImageQualityAssessment& assessments, int & r_elapsed );
+    const Image& image,
+    FaceImageQualityAssessment& assessments, int & r_elapsed,
+    std::vector<uint8_t>* artifacts = nullptr,
+    const ArtifactStoreReader* storeReader = nullptr);
 
-std::vector<std::string> readFileLines(
-    const std::string& inputFile);
+std::string to_lower(std::string data)
+{
+    std::transform(data.begin(), data.end(), data.begin(),
+        [](unsigned char c) { return std::tolower(c); });
+    return data;
+}
 
-string exportAssessmentResultsToString(
-    const FaceImageQualityAssessment& assessments,
-    bool doExportScalar = false);
+bool isImageFile(const fs::path& path)
+{
+    std::string extension = to_lower(path.extension().generic_string());
+    return extension == ".jpg" || extension == ".jpeg" || extension == ".png";
+}
 
-std::vector<std::string> readFileLines(const std::string& inputFile)
+/**
+ * @brief 64-bit FNV-1a hash of a path, used for sharding and for the checkpoint journal.
+ */
+uint64_t hashImageFile(const std::string& imageFile)
 {
-    std::vector<std::string> filenames;
-    std::ifstream ifs(inputFile);
-    std::string line;
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : imageFile)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
 
-    while (ifs)
+/**
+ * @brief Selects the part of a corpus processed by one of several independent runs.
+ * @details An image belongs to the shard index of the hash of its path modulo the number of
+ * shards, such that the split neither depends on the enumeration order nor on the host.
+ */
+struct Shard
+{
+    uint64_t index = 0;
+    uint64_t count = 1;
+
+    bool Contains(const std::string& imageFile) const
     {
-        std::getline(ifs, line);
-        // ignore empty lines and comment lines
-        if (line.empty() || line.at(0) == '#')
-            continue;
-        filenames.push_back(line);
+        return count <= 1 || hashImageFile(imageFile) % count == index;
     }
+};
 
-    return filenames;
-}
+/**
+ * @brief Enumerates the images of a batch lazily from a directory, a list file or a single path.
+ * @details Only the entries between the oldest one not yet taken and the newest one
+ * requested are held in memory, such that arbitrarily large corpora can be streamed.
+ * Entries of other shards and entries contained in the skip set are not enumerated.
+ * Each index is taken once with Get(); Peek() returns an entry without taking it.
+ * The class is thread-safe.
+ */
+class ImageFileList
+{
+public:
+    ImageFileList(
+        const fs::path& input,
+        bool recursive,
+        const Shard& shard,
+        const std::unordered_set<uint64_t>* skip = nullptr)
+        : m_shard(shard), m_skip(skip)
+    {
+        if (fs::is_directory(input))
+        {
+            if (recursive)
+                m_recursiveIterator = fs::recursive_directory_iterator(
+                    input, fs::directory_options::skip_permission_denied);
+            else
+                m_iterator = fs::directory_iterator(input);
+        }
+        else if (std::string fileExt = to_lower(input.extension().string());
+            fileExt == ".txt" || fileExt == ".csv")
+        {
+            // a list of image files
+            m_listStream.open(input);
+        }
+        else
+        {
+            // single image file
+            m_single = input.generic_string();
+        }
+    }
 
-std::string to_lower(std::string data)
+    bool Get(size_t index, std::string& imageFile)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!EnumerateTo(index))
+            return false;
+        auto it = m_pending.find(index);
+        imageFile = std::move(it->second);
+        m_pending.erase(it);
+        return true;
+    }
+
+    bool Peek(size_t index, std::string& imageFile)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!EnumerateTo(index))
+            return false;
+        imageFile = m_pending.at(index);
+        return true;
+    }
+
+private:
+    bool EnumerateTo(size_t index)
+    {
+        std::string imageFile;
+        while (m_numEnumerated <= index)
+        {
+            if (!Next(imageFile))
+                return false;
+            if (!m_shard.Contains(imageFile) ||
+                (m_skip != nullptr && m_skip->count(hashImageFile(imageFile)) != 0))
+                continue;
+            m_pending.emplace(m_numEnumerated++, std::move(imageFile));
+        }
+        return true;
+    }
+
+    bool Next(std::string& imageFile)
+    {
+        std::error_code ec;
+        while (m_iterator != fs::directory_iterator())
+        {
+            fs::path path = m_iterator->path();
+            bool isFile = m_iterator->is_regular_file(ec);
+            m_iterator.increment(ec);
+            if (ec)
+                m_iterator = fs::directory_iterator();
+            if (isFile && isImageFile(path))
+            {
+                imageFile = path.generic_string();
+                return true;
+            }
+        }
+        while (m_recursiveIterator != fs::recursive_directory_iterator())
+        {
+            fs::path path = m_recursiveIterator->path();
+            bool isFile = m_recursiveIterator->is_regular_file(ec);
+            m_recursiveIterator.increment(ec);
+            if (ec)
+                m_recursiveIterator = fs::recursive_directory_iterator();
+            if (isFile && isImageFile(path))
+            {
+                imageFile = path.generic_string();
+                return true;
+            }
+        }
+        while (m_listStream && std::getline(m_listStream, imageFile))
+        {
+            // ignore empty lines and comment lines
+            if (!imageFile.empty() && imageFile.at(0) != '#')
+                return true;
+        }
+        if (!m_single.empty())
+        {
+            imageFile = std::move(m_single);
+            m_single.clear();
+            return true;
+        }
+        return false;
+    }
+
+    Shard m_shard;
+    const std::unordered_set<uint64_t>* m_skip;
+    fs::directory_iterator m_iterator;
+    fs::recursive_directory_iterator m_recursiveIterator;
+    std::ifstream m_listStream;
+    std::string m_single;
+    std::map<size_t, std::string> m_pending;
+    size_t m_numEnumerated = 0;
+    std::mutex m_mutex;
+};
+
+/**
+ * @brief Journal of the images of a batch whose results have been written to the output file.
+ * @details Each line holds the size of the output file after the result followed by the path
+ * of the image. When a run is resumed, the output file is truncated to the last recorded size,
+ * which drops a result written but not journaled, and the journaled images are skipped.
+ */
+class CheckpointJournal
 {
-    std::transform(data.begin(), data.end(), data.begin(),
-        [](unsigned char c) { return std::tolower(c); });
-    return data;
-}
+public:
+    /**
+     * @brief Opens the journal and reads the entries of a previous run, if any.
+     * @details A line interrupted while written is removed.
+     */
+    explicit CheckpointJournal(const fs::path& path)
+    {
+        std::streamoff journalSize = 0;
+        {
+            std::ifstream ifs(path, std::ios::binary);
+            std::string line;
+            while (std::getline(ifs, line) && !ifs.eof())
+            {
+                auto separator = line.find(';');
+                if (separator == std::string::npos || separator == 0 ||
+                    line.find_first_not_of("0123456789") != separator)
+                    break;
+                m_outputSize = std::stoll(line.substr(0, separator));
+                m_done.insert(hashImageFile(line.substr(separator + 1)));
+                journalSize = ifs.tellg();
+            }
+        }
+        if (fs::exists(path))
+            fs::resize_file(path, static_cast<uintmax_t>(journalSize));
+
+        m_stream.open(path, std::ios::binary | std::ios::app);
+        if (!m_stream)
+            throw std::runtime_error("Cannot open journal " + path.string());
+    }
+
+    /**
+     * @brief Size of the output file after the last journaled result, 0 for a new run.
+     */
+    std::streamoff GetOutputSize() const { return m_outputSize; }
 
-std::vector<std::string> readImageFilesFromDirectory(const std::string& inputDirectory)
+    /**
+     * @brief Hashes of the paths of the journaled images, see hashImageFile().
+     */
+    const std::unordered_set<uint64_t>& GetDone() const { return m_done; }
+
+    void Add(std::streamoff outputSize, const std::string& imageFile)
+    {
+        m_stream << outputSize << ';' << imageFile << '\n';
+        m_stream.flush();
+    }
+
+private:
+    std::streamoff m_outputSize = 0;
+    std::unordered_set<uint64_t> m_done;
+    std::ofstream m_stream;
+};
+
+/**
+ * @brief Result of the assessment of one image of a batch.
+ */
+struct QualityResult
+{
+    std::string imageFile;
+    FaceImageQualityAssessment assessments;
+    int time_elapsed_ms = 0;
+    int resCode = FAILURE;
+    std::vector<uint8_t> artifacts;
+};
+
+/**
+ * @brief Writes the result of one image, preceded by the header for the first image.
+ */
+int writeQualityResult(
+    QualityResult& result,
+    bool& outputHeader,
+    std::ostream* outStreamPtr,
+    bool doConsoleOut,
+    ArtifactStoreWriter* storeWriter)
 {
-    std::vector<std::string> filenames;
+    constexpr bool EXPORT_RAW = false;
+    constexpr bool EXPORT_SCALAR = true;
 
-    for (const auto& entry : fs::directory_iterator(inputDirectory))
+    if (storeWriter != nullptr)
     {
-        std::string extension = to_lower(entry.path().extension().generic_string());
-        if (extension == ".jpg" || extension == ".jpeg" || extension == ".png")
+        try
+        {
+            storeWriter->Add(result.imageFile, result.artifacts);
+        }
+        catch (const std::exception& e)
         {
-            filenames.push_back(entry.path().generic_string());
+            cerr << "[ERROR] " << e.what() << "." << endl;
+            result.resCode = FAILURE;
         }
     }
 
-    return filenames;
+    // only the columnar results are written
+    if (outStreamPtr == nullptr)
+        return result.resCode;
+
+    string strQAresRaw = exportAssessmentResultsToString(
+        result.assessments, EXPORT_RAW);
+    string strQAresScalar = exportAssessmentResultsToString(
+        result.assessments, EXPORT_SCALAR);
+
+    // output result of each file right after it was processed
+    if (outputHeader)
+    {
+        // print the header. the format is the following
+        // "Filename", MeasurementName1, ..., MeasurementNameN, MeasurementName1.scalar, ..., MeasurementNameN.scalar
+        // Filename,      Measurement1.raw, ..., MeasurementN.raw, Measurement1.scalar, ..., MeasurementN.scalar
+        *outStreamPtr << exportAssessmentHeaderToString(result.assessments) << std::endl;
+
+        outputHeader = false;
+    }
+
+    *outStreamPtr << result.imageFile << ';' << strQAresRaw << ';' << strQAresScalar << ';' << result.time_elapsed_ms << std::endl;
+
+    if (doConsoleOut)
+    {
+        std::cout << "-------------------------------------------------------" << std::endl;
+        std::cout << "Image file: '" << result.imageFile << "' has attributes:" << std::endl;
+        for (const auto& [measure, measure_result] : result.assessments.qAssessments)
+        {
+            auto mName = static_cast<std::string>(magic_enum::enum_name(measure));
+            auto rawScore = measure_result.rawScore;
+            auto scalarScore = measure_result.scalar;
+            if (measure_result.code != QualityMeasureReturnCode::Success)
+                scalarScore = -1;
+            std::cout << mName << "-> rawScore:  " << rawScore << "   scalar: " << scalarScore
+                << std::endl;
+        }
+        std::cout << "-------------------------------------------------------" << std::endl;
+    }
+
+    return result.resCode;
 }
 
-bool isStringContained(
-    const std::vector<std::string>& strings, 
-    const std::string& str,
-    bool isCaseSensitive=false)
+/**
+ * @brief Hints the operating system that a file will be read soon, such that it is
+ * fetched into the page cache in the background.
+ */
+void adviseWillRead(const std::string& file)
 {
-    std::string s = str;
-    if (!isCaseSensitive)
-        std::transform(s.begin(), s.end(), s.begin(),
-            [](unsigned char c) { return std::tolower(c); });
-
-    return (!s.empty() &&
-        std::find(strings.begin(), strings.end(), s) != strings.end());
+#if !defined _WIN32 && !defined __APPLE__
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        close(fd);
+    }
+#else
+    (void)file;
+#endif
 }
 
-int runQuality(
-    const std::shared_ptr<Interface>& implPtr,
-    const fs::path& inputFile,
-    std::ostream* outStreamPtr = &std::cout,
-    bool doConsoleOut = false)
+/**
+ * @brief Decodes the images of a batch ahead of their assessment.
+ * @details Decoder threads read the images in the order of the list while at most lookAhead
+ * decoded images wait for their assessment. The files following the ones being decoded are
+ * announced to the operating system, such that reading them overlaps with the decoding and
+ * the assessment, e.g. for network file systems.
+ */
+class ImagePrefetcher
 {
-    std::vector<std::string> imageFiles;
-    std::vector<FaceImageQualityAssessment> faceImageQAs;
-    std::vector<int> faceImageQAresultCodes;
-    std::vector<int> faceImageQAassessmentTimes;
+public:
+    ImagePrefetcher(ImageFileList& imageFiles, size_t lookAhead, size_t numThreads)
+        : m_imageFiles(imageFiles), m_lookAhead(lookAhead)
+    {
+        for (size_t i = 0; i < numThreads; i++)
+            m_threads.emplace_back(&ImagePrefetcher::Decode, this);
+    }
 
-    if (fs::is_directory(fs::path(inputFile)))
+    ~ImagePrefetcher()
     {
-        imageFiles = readImageFilesFromDirectory(inputFile.generic_string());
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopped = true;
+        }
+        m_condition.notify_all();
+        for (auto& thread : m_threads)
+            thread.join();
     }
-    else if (std::string fileExt = inputFile.extension().string();
-        isStringContained({ ".txt", ".csv" }, fileExt))
-        // a list of image files
-        imageFiles = readFileLines(inputFile.generic_string());
-    else
-        // single image file
-        imageFiles.push_back(inputFile.generic_string());
 
-    // process image file(s)
-    constexpr bool EXPORT_RAW = false;
-    constexpr bool EXPORT_SCALAR = true;
-    bool outputHeaderIn1stIter = true;
-    for (auto const& imageFile: imageFiles)
+    ImagePrefetcher(const ImagePrefetcher&) = delete;
+    ImagePrefetcher& operator=(const ImagePrefetcher&) = delete;
+
+    /**
+     * @brief Waits for the decoded image. Each image is taken once, in about the order of the list.
+     * @return false if the index is beyond the end of the list.
+     */
+    bool Get(size_t index, std::string& imageFile, Image& image, ReturnStatus& retStatus)
     {
-        FaceImageQualityAssessment assessmentResult;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [&] { return m_decoded.count(index) != 0 || index >= m_numFiles; });
+        auto it = m_decoded.find(index);
+        if (it == m_decoded.end())
+            return false;
+        imageFile = std::move(it->second.imageFile);
+        image = it->second.image;
+        retStatus = it->second.retStatus;
+        m_decoded.erase(it);
+        m_numTaken++;
+        lock.unlock();
+        m_condition.notify_all();
+        return true;
+    }
 
-        int time_elapsed_ms = 0;
-        int resCode = getQualityAssessmentResults(implPtr, imageFile, assessmentResult, time_elapsed_ms);
-        faceImageQAresultCodes.push_back(resCode);
-        faceImageQAassessmentTimes.push_back(time_elapsed_ms);
+private:
+    struct DecodedImage
+    {
+        std::string imageFile;
+        ReturnStatus retStatus;
+        Image image;
+    };
 
-        faceImageQAs.push_back(assessmentResult);
+    void Decode()
+    {
+        while (true)
+        {
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [&]
+                    {
+                        return m_stopped || m_nextIndex >= m_numFiles ||
+                            m_nextIndex < m_numTaken + m_lookAhead;
+                    });
+                if (m_stopped || m_nextIndex >= m_numFiles)
+                    return;
+                index = m_nextIndex++;
+            }
 
-        string strQAresRaw = exportAssessmentResultsToString(
-            assessmentResult, EXPORT_RAW);
-        string strQAresScalar = exportAssessmentResultsToString(
-            assessmentResult, EXPORT_SCALAR);
+            DecodedImage decoded;
+            if (!m_imageFiles.Get(index, decoded.imageFile))
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_numFiles = std::min(m_numFiles, index);
+                }
+                m_condition.notify_all();
+                return;
+            }
 
-        // output result of each file right after it was processed
-        if (outputHeaderIn1stIter)
+            if (std::string nextFile; m_imageFiles.Peek(index + m_lookAhead, nextFile))
+                adviseWillRead(nextFile);
+
+            try
+            {
+                decoded.retStatus = readImage(decoded.imageFile, decoded.image);
+            }
+            catch (const std::exception& e)
+            {
+                decoded.retStatus = { ReturnCode::ImageReadingError, e.what() };
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_decoded.emplace(index, std::move(decoded));
+            }
+            m_condition.notify_all();
+        }
+    }
+
+    ImageFileList& m_imageFiles;
+    size_t m_lookAhead;
+    std::vector<std::thread> m_threads;
+    std::map<size_t, DecodedImage> m_decoded;
+    size_t m_numFiles = std::numeric_limits<size_t>::max();
+    size_t m_nextIndex = 0;
+    size_t m_numTaken = 0;
+    bool m_stopped = false;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+};
+
+/**
+ * @brief Options of a batch run besides the input and the output.
+ */
+struct BatchOptions
+{
+    /** Number of images decoded ahead of their assessment, 0 to decode on demand. */
+    size_t prefetchLookAhead = 0;
+    /** Number of threads decoding ahead. */
+    size_t numDecodeThreads = 1;
+    /** Whether subdirectories of an input directory are enumerated. */
+    bool recursive = false;
+    /** Part of the corpus processed by this run. */
+    Shard shard;
+    /** Images already processed by a previous run of a resumed job. */
+    const std::unordered_set<uint64_t>* done = nullptr;
+    /** Journal of the processed images, requires an output file. */
+    CheckpointJournal* journal = nullptr;
+    /** Writer of the columnar results file, if any. */
+    ColumnarResultsWriter* columnarWriter = nullptr;
+};
+
+int runQuality(
+    const std::vector<std::shared_ptr<Interface>>& implPtrs,
+    const fs::path& inputFile,
+    std::ostream* outStreamPtr = &std::cout,
+    bool doConsoleOut = false,
+    ArtifactStoreWriter* storeWriter = nullptr,
+    const ArtifactStoreReader* storeReader = nullptr,
+    const BatchOptions& options = BatchOptions(),
+    bool outputHeader = true)
+{
+    ImageFileList imageFiles(inputFile, options.recursive, options.shard, options.done);
+
+    std::unique_ptr<ImagePrefetcher> prefetcher;
+    if (options.prefetchLookAhead > 0)
+        prefetcher = std::make_unique<ImagePrefetcher>(
+            imageFiles, options.prefetchLookAhead, options.numDecodeThreads);
+
+    // returns false if the index is beyond the end of the list
+    auto assess = [&imageFiles, &prefetcher, storeWriter, storeReader](
+        const std::shared_ptr<Interface>& implPtr, size_t index, QualityResult& result)
         {
-            // print the header. the format is the following
-            // "Filename", MeasurementName1, ..., MeasurementNameN, MeasurementName1.scalar, ..., MeasurementNameN.scalar
-            // Filename,      Measurement1.raw, ..., MeasurementN.raw, Measurement1.scalar, ..., MeasurementN.scalar
-            vector<string> measureNames;
-            vector<string> measureNamesScalar;
-            for (const auto& [measure, measure_result] : faceImageQAs[0].qAssessments)
+            Image image;
+            ReturnStatus retStatus;
+            if (prefetcher)
             {
-                auto mName = static_cast<std::string>(magic_enum::enum_name(measure));
-                measureNames.push_back(mName);
-                measureNamesScalar.push_back(mName + string(".scalar"));
+                if (!prefetcher->Get(index, result.imageFile, image, retStatus))
+                    return false;
+            }
+            else
+            {
+                if (!imageFiles.Get(index, result.imageFile))
+                    return false;
+                retStatus = readImage(result.imageFile, image);
+            }
+
+            if (retStatus.code != ReturnCode::Success)
+            {
+                cerr << "[ERROR] " << retStatus.info << "." << endl;
+                return true;
             }
 
-            *outStreamPtr << "Filename;";
-            for (const auto& mn : measureNames)
-                *outStreamPtr << mn << ';';
-            for (const auto& mn : measureNamesScalar)
-                *outStreamPtr << mn << ';';
-            *outStreamPtr << "assessment_time_in_ms;" << std::endl;
+            result.resCode = getQualityAssessmentResults(
+                implPtr, result.imageFile, image, result.assessments, result.time_elapsed_ms,
+                storeWriter != nullptr ? &result.artifacts : nullptr, storeReader);
+            return true;
+        };
 
-            outputHeaderIn1stIter = false;
+    auto write = [&](QualityResult& result)
+        {
+            writeQualityResult(result, outputHeader, outStreamPtr, doConsoleOut, storeWriter);
+            if (options.columnarWriter != nullptr)
+            {
+                try
+                {
+                    options.columnarWriter->Add(result.imageFile, result.assessments, result.time_elapsed_ms);
+                }
+                catch (const std::exception& e)
+                {
+                    cerr << "[ERROR] " << e.what() << "." << endl;
+                }
+            }
+            if (options.journal != nullptr)
+                options.journal->Add(outStreamPtr->tellp(), result.imageFile);
+        };
+
+    // process image file(s)
+    size_t numImages = 0;
+    if (implPtrs.size() == 1)
+    {
+        for (QualityResult result; assess(implPtrs[0], numImages, result); result = QualityResult())
+        {
+            write(result);
+            numImages++;
         }
+    }
+    else
+    {
+        // Each instance is used by one thread. The results are written in the order of the image files
+        // through a reorder buffer; an image is not started before all but the last
+        // reorderWindow results have been written, which bounds the memory.
+        const size_t reorderWindow = 2 * implPtrs.size();
+        std::map<size_t, QualityResult> reorderBuffer;
+        size_t numFiles = std::numeric_limits<size_t>::max();
+        size_t nextIndex = 0;
+        size_t nextToWrite = 0;
+        std::mutex mutex;
+        std::condition_variable condition;
 
-        *outStreamPtr << imageFile << ';' << strQAresRaw << ';' << strQAresScalar << ';' << time_elapsed_ms << std::endl;
+        std::vector<std::thread> workers;
+        for (const auto& implPtr : implPtrs)
+        {
+            workers.emplace_back([&, implPtr]
+                {
+                    while (true)
+                    {
+                        size_t index;
+                        {
+                            std::unique_lock<std::mutex> lock(mutex);
+                            condition.wait(lock, [&]
+                                {
+                                    return nextIndex >= numFiles || nextIndex < nextToWrite + reorderWindow;
+                                });
+                            if (nextIndex >= numFiles)
+                                return;
+                            index = nextIndex++;
+                        }
+                        QualityResult result;
+                        bool isValid = assess(implPtr, index, result);
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            if (isValid)
+                                reorderBuffer.emplace(index, std::move(result));
+                            else
+                                numFiles = std::min(numFiles, index);
+                        }
+                        condition.notify_all();
+                    }
+                });
+        }
 
-        if (doConsoleOut)
+        while (true)
         {
-            std::cout << "-------------------------------------------------------" << std::endl;
-            std::cout << "Image file: '" << imageFile << "' has attributes:" << std::endl;
-            for (const auto& [measure, measure_result] : assessmentResult.qAssessments)
+            QualityResult result;
             {
-                auto mName = static_cast<std::string>(magic_enum::enum_name(measure));
-                auto rawScore = measure_result.rawScore;
-                auto scalarScore = measure_result.scalar;
-                if (measure_result.code != QualityMeasureReturnCode::Success)
-                    scalarScore = -1;
-                std::cout << mName << "-> rawScore:  " << rawScore << "   scalar: " << scalarScore
-                    << std::endl;
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&]
+                    {
+                        return reorderBuffer.count(nextToWrite) != 0 || nextToWrite >= numFiles;
+                    });
+                if (nextToWrite >= numFiles)
+                    break;
+                auto it = reorderBuffer.find(nextToWrite);
+                result = std::move(it->second);
+                reorderBuffer.erase(it);
             }
-            std::cout << "-------------------------------------------------------" << std::endl;
+            write(result);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                nextToWrite++;
+            }
+            condition.notify_all();
         }
+
+        for (auto& worker : workers)
+            worker.join();
+        numImages = nextToWrite;
     }
 
-    if (faceImageQAs.empty())
+    // a shard may be empty, e.g. if there are more shards than images; a resumed job may be done already
+    if (numImages == 0 && options.done == nullptr && options.shard.count <= 1)
     {
         cerr << "[ERROR] " << "empty result list" << "." << endl;
         return FAILURE;
     }
 
-    if (faceImageQAs.size() != imageFiles.size())
+    return SUCCESS;
+}
+
+/**
+ * @brief Concatenates the outputs of the shards of a batch into one CSV file.
+ * @details The input is a directory containing the outputs or a list file naming them.
+ * All outputs have to share the same header.
+ */
+int runMerge(const fs::path& inputFile, std::ostream* outStreamPtr)
+{
+    std::vector<std::string> shardFiles;
+    if (fs::is_directory(inputFile))
+    {
+        for (const auto& entry : fs::directory_iterator(inputFile))
+            if (to_lower(entry.path().extension().generic_string()) == ".csv")
+                shardFiles.push_back(entry.path().generic_string());
+        std::sort(shardFiles.begin(), shardFiles.end());
+    }
+    else
+    {
+        std::ifstream ifs(inputFile);
+        std::string line;
+        while (std::getline(ifs, line))
+        {
+            // ignore empty lines and comment lines
+            if (!line.empty() && line.at(0) != '#')
+                shardFiles.push_back(line);
+        }
+    }
+
+    if (shardFiles.empty())
     {
-        cerr << "[ERROR] " << "invalid number of measurement results. Is " << imageFiles.size() <<
-            ", has to be " << faceImageQAs.size() << endl;
+        cerr << "[ERROR] No shard outputs found in '" << inputFile.generic_string() << "'." << endl;
         return FAILURE;
     }
 
+    std::string header;
+    for (const auto& shardFile : shardFiles)
+    {
+        std::ifstream ifs(shardFile);
+        if (!ifs)
+        {
+            cerr << "[ERROR] Could not open '" << shardFile << "'." << endl;
+            return FAILURE;
+        }
+
+        std::string line;
+        // a shard without any image has no header
+        if (!std::getline(ifs, line))
+            continue;
+        if (header.empty())
+        {
+            header = line;
+            *outStreamPtr << header << '\n';
+        }
+        else if (line != header)
+        {
+            cerr << "[ERROR] The header of '" << shardFile << "' differs from the previous outputs." << endl;
+            return FAILURE;
+        }
+
+        while (std::getline(ifs, line))
+            if (!line.empty())
+                *outStreamPtr << line << '\n';
+    }
+    outStreamPtr->flush();
+
     return SUCCESS;
 }
 
-int getQualityAssessmentResults(
+std::vector<std::string> splitCsvLine(const std::string& line)
+{
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, ';'))
+        fields.push_back(field);
+    return fields;
+}
+
+int runRescore(
     const std::shared_ptr<Interface>& implPtr,
-    const string& inputFile,
-    FaceImageQualityAssessment& assessments,
-    int & r_elapsed)
+    const fs::path& inputFile,
+    std::ostream* outStreamPtr = &std::cout)
 {
-    Image image;
-    ReturnStatus retStatus = readImage(inputFile, image);
+    // the input is a result file written by runQuality(), i.e.
+    // Filename;Measure1;...;MeasureN;Measure1.scalar;...;MeasureN.scalar;assessment_time_in_ms;
+    std::ifstream ifs(inputFile);
+    std::string header;
+    if (!std::getline(ifs, header))
+    {
+        cerr << "[ERROR] " << "Could not read '" << inputFile.generic_string() << "'." << endl;
+        return FAILURE;
+    }
 
-    if (retStatus.code != ReturnCode::Success)
+    auto columns = splitCsvLine(header);
+    std::vector<QualityMeasure> measures;
+    for (size_t i = 1; i < columns.size(); i++)
     {
-        cerr << "[ERROR] " << retStatus.info << "." << endl;
+        auto measure = magic_enum::enum_cast<QualityMeasure>(columns[i]);
+        if (!measure.has_value())
+            break;
+        measures.push_back(measure.value());
+    }
+    if (measures.empty() || columns.size() < 2 * measures.size() + 2)
+    {
+        cerr << "[ERROR] " << "'" << inputFile.generic_string() << "' is not a result file." << endl;
         return FAILURE;
     }
 
+    *outStreamPtr << header << std::endl;
+
+    std::string line;
+    while (std::getline(ifs, line))
+    {
+        if (line.empty())
+            continue;
+        auto fields = splitCsvLine(line);
+        if (fields.size() < 2 * measures.size() + 2)
+        {
+            cerr << "[ERROR] " << "Invalid line: " << line << endl;
+            return FAILURE;
+        }
+
+        FaceImageQualityAssessment assessments;
+        try
+        {
+            for (size_t i = 0; i < measures.size(); i++)
+            {
+                double rawScore = std::stod(fields[1 + i]);
+                double scalarScore = std::stod(fields[1 + measures.size() + i]);
+                // the result file does not contain the return codes, failures are exported as -1
+                auto code = scalarScore == -1 ?
+                    QualityMeasureReturnCode::FailureToAssess : QualityMeasureReturnCode::Success;
+                assessments.qAssessments[measures[i]] = { rawScore, scalarScore, code };
+            }
+        }
+        catch (const std::exception&)
+        {
+            cerr << "[ERROR] " << "Invalid line: " << line << endl;
+            return FAILURE;
+        }
+
+        if (auto ret = implPtr->rescoreQuality(assessments); ret.code != ReturnCode::Success)
+        {
+            cerr << "[ERROR] " << ret.info << "." << endl;
+            return FAILURE;
+        }
+
+        *outStreamPtr << fields[0] << ';'
+            << exportAssessmentResultsToString(assessments, false) << ';'
+            << exportAssessmentResultsToString(assessments, true) << ';'
+            << fields[1 + 2 * measures.size()] << std::endl;
+    }
+
+    return SUCCESS;
+}
+
+int getQualityAssessmentResults(
+    const std::shared_ptr<Interface>& implPtr,
+    const string& inputFile,
+    const Image& image,
+    FaceImageQualityAssessment& assessments,
+    int & r_elapsed,
+    std::vector<uint8_t>* artifacts,
+    const ArtifactStoreReader* storeReader)
+{
+    ReturnStatus retStatus;
+
     //std::cout << "--> Start processing image file: " << inputFile << std::endl;
     auto start_time = std::chrono::high_resolution_clock::now();
-    retStatus = implPtr->vectorQuality(image, assessments);
+    if (storeReader != nullptr)
+    {
+        // images without artifacts are those for which the pre-processing failed
+        const uint8_t* artifacts = nullptr;
+        size_t artifactsSize = 0;
+        storeReader->Find(inputFile, artifacts, artifactsSize);
+        retStatus = implPtr->vectorQualityFromArtifacts(image, artifacts, artifactsSize, assessments);
+    }
+    else if (artifacts != nullptr)
+    {
+        retStatus = implPtr->vectorQualityWithArtifacts(image, assessments, *artifacts);
+    }
+    else
+    {
+        retStatus = implPtr->vectorQuality(image, assessments);
+    }
     auto end_time = std::chrono::high_resolution_clock::now();
     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
     r_elapsed = static_cast<int>(elapsed.count());
@@ -288,13 +932,130 @@ string exportAssessmentResultsToString(
     return resultStr;
 }
 
+string exportAssessmentHeaderToString(
+    const FaceImageQualityAssessment& assessments)
+{
+    std::string measureNames;
+    std::string measureNamesScalar;
+    for (const auto& [measure, measure_result] : assessments.qAssessments)
+    {
+        auto mName = static_cast<std::string>(magic_enum::enum_name(measure));
+        measureNames += mName + ';';
+        measureNamesScalar += mName + ".scalar;";
+    }
+    return "Filename;" + measureNames + measureNamesScalar + "assessment_time_in_ms;";
+}
+
+
+
+/**
+ * @brief Creates the instances used by concurrent threads.
+ * @details The instances are not shared between threads, each thread gets its own.
+ * 
+ * @param implPtr Initialized instance, used as first instance.
+ * @param numInstances Number of instances.
+ * @param configDir Configuration directory passed to initialize().
+ * @param configFile Configuration file passed to initialize().
+ * @param implPtrs Created instances.
+ * @return false if an instance could not be initialized.
+ */
+bool createInstances(
+    const std::shared_ptr<Interface>& implPtr,
+    int numInstances,
+    const fs::path& configDir,
+    const fs::path& configFile,
+    std::vector<std::shared_ptr<Interface>>& implPtrs)
+{
+    implPtrs = { implPtr };
+    while (implPtrs.size() < static_cast<size_t>(numInstances))
+    {
+        auto instanceImplPtr = Interface::getImplementation();
+        auto ret = instanceImplPtr->initialize(configDir.generic_string(), configFile.generic_string());
+        if (ret.code != ReturnCode::Success)
+        {
+            cerr << "[ERROR] initialize() returned error: " << ret.code << "." << endl
+                 << ret.info << endl;
+            return false;
+        }
+        implPtrs.push_back(instanceImplPtr);
+    }
+    return true;
+}
 
 void usage(const string& executable)
 {
     cerr << "Usage: " << executable
          << " -c configDir "
-            "-o outputFile -h outputStem -i inputFile -cf configFile"
-         << endl;
+            "-o outputFile -h outputStem -i inputFile -cf configFile [-rescore] "
+            "[-store artifactFile | -restore artifactFile] [-j N] "
+            "[-prefetch N [-decode-threads M]] [-recursive] [-shard i/N] [-journal journalFile] "
+            "[-columnar resultsFile]"
+         << endl
+         << "  -rescore: inputFile is a result file of a previous run; the scalar values"
+         << endl
+         << "            are recomputed from its raw scores with the current configuration"
+         << endl
+         << "  -store:   writes the pre-processing artifacts of all images to artifactFile"
+         << endl
+         << "  -restore: reads the pre-processing artifacts from artifactFile instead of"
+         << endl
+         << "            running the pre-processing"
+         << endl
+         << "  -j:       number of images processed concurrently, each by its own OFIQ"
+         << endl
+         << "            instance; the results are written in the order of the input (default 1)"
+         << endl
+         << "  -prefetch: number of images decoded ahead of their assessment (default 0, off)"
+         << endl
+         << "  -decode-threads: number of threads decoding images ahead (default 1)"
+         << endl
+         << "  -recursive: enumerates the subdirectories of an input directory"
+         << endl
+         << "  -shard:   processes only the images whose path hash modulo N equals i"
+         << endl
+         << "  -journal: records the processed images in journalFile; a job interrupted"
+         << endl
+         << "            is resumed with the same flags and skips the recorded images"
+         << endl
+         << "  -columnar: writes the results additionally into the columnar binary file"
+         << endl
+         << "            resultsFile; without -o, no CSV output is written"
+         << endl
+         << "   or: " << executable << " -merge -i shardOutputs [-o outputFile]"
+         << endl
+         << "  -merge:   concatenates the CSV files of a directory or list file shardOutputs"
+         << endl
+#ifndef _WIN32
+         << "   or: " << executable
+         << " -c configDir -cf configFile -server socketPath [-workers N | -prefork N] [-queue M]"
+         << endl
+         << "  -server:  serves assessment requests on the Unix domain socket socketPath"
+         << endl
+         << "  -workers: number of OFIQ instances processing requests concurrently (default 1)"
+         << endl
+         << "  -prefork: number of processes forked after the initialization, sharing the"
+         << endl
+         << "            models copy-on-write; each process serves with one instance"
+         << endl
+         << "  -queue:   number of requests waiting for a worker before further requests"
+         << endl
+         << "            are rejected with BUSY (default 16)"
+         << endl
+         << "   or: " << executable
+         << " -c configDir -cf configFile -shm name [-shm-slots N] [-shm-slot-size bytes]"
+         << endl
+         << "  -shm:     assesses the frames of the shared memory ring name_frames and writes"
+         << endl
+         << "            the results to the ring name_results"
+         << endl
+         << "  -shm-slots: number of slots of both rings (default 4)"
+         << endl
+         << "  -shm-slot-size: number of bytes of a frame slot including its 64 byte"
+         << endl
+         << "            header (default 64 MiB)"
+         << endl
+#endif
+         ;
 }
 
 int main(int argc, char* argv[])
@@ -310,6 +1071,24 @@ int main(int argc, char* argv[])
     const char* outputFile = nullptr;
     fs::path inputFile;
     fs::path configFile;
+    bool doRescore = false;
+    fs::path storeFile;
+    fs::path restoreFile;
+    int numJobs = 1;
+    int prefetchLookAhead = 0;
+    int numDecodeThreads = 1;
+    bool recursive = false;
+    Shard shard;
+    fs::path journalFile;
+    fs::path columnarFile;
+    bool doMerge = false;
+    std::string socketPath;
+    int numWorkers = 1;
+    int queueCapacity = 16;
+    int numProcesses = 0;
+    std::string shmName;
+    int shmSlotCount = 4;
+    long long shmSlotSize = 64 * 1024 * 1024;
 
     int i = 0;
     while (i < argc - requiredArgs)
@@ -322,6 +1101,54 @@ int main(int argc, char* argv[])
             inputFile = fs::path(argv[requiredArgs + (++i)]);
         else if (strcmp(argv[requiredArgs + i], "-cf") == 0)
             configFile = fs::path(argv[requiredArgs + (++i)]);
+        else if (strcmp(argv[requiredArgs + i], "-rescore") == 0)
+            doRescore = true;
+        else if (strcmp(argv[requiredArgs + i], "-store") == 0)
+            storeFile = fs::path(argv[requiredArgs + (++i)]);
+        else if (strcmp(argv[requiredArgs + i], "-restore") == 0)
+            restoreFile = fs::path(argv[requiredArgs + (++i)]);
+        else if (strcmp(argv[requiredArgs + i], "-j") == 0)
+            numJobs = std::atoi(argv[requiredArgs + (++i)]);
+        else if (strcmp(argv[requiredArgs + i], "-prefetch") == 0)
+            prefetchLookAhead = std::atoi(argv[requiredArgs + (++i)]);
+        else if (strcmp(argv[requiredArgs + i], "-decode-threads") == 0)
+            numDecodeThreads = std::atoi(argv[requiredArgs + (++i)]);
+        else if (strcmp(argv[requiredArgs + i], "-recursive") == 0)
+            recursive = true;
+        else if (strcmp(argv[requiredArgs + i], "-shard") == 0)
+        {
+            unsigned long long index = 0;
+            unsigned long long count = 0;
+            if (sscanf(argv[requiredArgs + (++i)], "%llu/%llu", &index, &count) != 2 ||
+                count == 0 || index >= count)
+            {
+                cerr << "[ERROR] The shard has to be specified as i/N with 0 <= i < N." << endl;
+                return FAILURE;
+            }
+            shard = { index, count };
+        }
+        else if (strcmp(argv[requiredArgs + i], "-journal") == 0)
+            journalFile = fs::path(argv[requiredArgs + (++i)]);
+        else if (strcmp(argv[requiredArgs + i], "-merge") == 0)
+            doMerge = true;
+        else if (strcmp(argv[requiredArgs + i], "-columnar") == 0)
+            columnarFile = fs::path(argv[requiredArgs + (++i)]);
+#ifndef _WIN32
+        else if (strcmp(argv[requiredArgs + i], "-server") == 0)
+            socketPath = argv[requiredArgs + (++i)];
+        else if (strcmp(argv[requiredArgs + i], "-workers") == 0)
+            numWorkers = std::atoi(argv[requiredArgs + (++i)]);
+        else if (strcmp(argv[requiredArgs + i], "-queue") == 0)
+            queueCapacity = std::atoi(argv[requiredArgs + (++i)]);
+        else if (strcmp(argv[requiredArgs + i], "-prefork") == 0)
+            numProcesses = std::atoi(argv[requiredArgs + (++i)]);
+        else if (strcmp(argv[requiredArgs + i], "-shm") == 0)
+            shmName = argv[requiredArgs + (++i)];
+        else if (strcmp(argv[requiredArgs + i], "-shm-slots") == 0)
+            shmSlotCount = std::atoi(argv[requiredArgs + (++i)]);
+        else if (strcmp(argv[requiredArgs + i], "-shm-slot-size") == 0)
+            shmSlotSize = std::atoll(argv[requiredArgs + (++i)]);
+#endif
         else
         {
             cerr << "[ERROR] Unrecognized flag: " << argv[requiredArgs + i] << endl;
@@ -331,6 +1158,55 @@ int main(int argc, char* argv[])
         ++i;
     }
 
+    if (!storeFile.empty() && !restoreFile.empty())
+    {
+        cerr << "[ERROR] The flags -store and -restore are exclusive." << endl;
+        return FAILURE;
+    }
+
+    if (!journalFile.empty() && (outputFile == nullptr || !storeFile.empty() || !columnarFile.empty() || doRescore))
+    {
+        cerr << "[ERROR] The flag -journal requires -o and excludes -store, -columnar and -rescore." << endl;
+        return FAILURE;
+    }
+
+    if (doMerge)
+    {
+        if (outputFile == nullptr)
+            return runMerge(inputFile, &std::cout);
+        std::ofstream ofs(outputFile);
+        if (!ofs.good())
+        {
+            cerr << "[ERROR] Could not open '" << outputFile << "'." << endl;
+            return FAILURE;
+        }
+        return runMerge(inputFile, &ofs);
+    }
+
+    if (numJobs < 1 || prefetchLookAhead < 0 || numDecodeThreads < 1)
+    {
+        cerr << "[ERROR] The number of jobs and decode threads has to be positive, the look-ahead must not be negative." << endl;
+        return FAILURE;
+    }
+
+    if (numWorkers < 1 || queueCapacity < 1)
+    {
+        cerr << "[ERROR] The number of workers and the queue capacity have to be positive." << endl;
+        return FAILURE;
+    }
+
+    if (numProcesses < 0 || (numProcesses > 0 && (numWorkers > 1 || socketPath.empty())))
+    {
+        cerr << "[ERROR] The flag -prefork requires -server and a positive number of processes and excludes -workers." << endl;
+        return FAILURE;
+    }
+
+    if (shmSlotCount < 1 || shmSlotSize < 1)
+    {
+        cerr << "[ERROR] The number and the size of the shared memory slots have to be positive." << endl;
+        return FAILURE;
+    }
+
     if (fs::is_regular_file(configDir))
     {
         if (!configFile.empty())
@@ -343,6 +1219,15 @@ int main(int argc, char* argv[])
         configDir = fs::path(configDir).parent_path();
     }
 
+#ifndef _WIN32
+    if (numProcesses > 0)
+    {
+        // no thread may be running when forking, the thread pools are created by the forked processes
+        setOnnxRuntimeThreading({ 0, 0, true });
+        cv::setNumThreads(0);
+    }
+#endif
+
     /* Get implementation pointer */
     auto implPtr = Interface::getImplementation();
     /* Initialization */
@@ -369,13 +1254,96 @@ int main(int argc, char* argv[])
     
     cout << "OFIQ library version: " << major << '.' << minor << '.' << patch << endl;
 
+#ifndef _WIN32
+    if (!socketPath.empty())
+    {
+        std::vector<std::shared_ptr<Interface>> implPtrs;
+        if (!createInstances(implPtr, numWorkers, configDir, configFile, implPtrs))
+            return FAILURE;
+        return runSocketServer(implPtrs, socketPath, numProcesses, static_cast<size_t>(queueCapacity));
+    }
+
+    if (!shmName.empty())
+        return runSharedMemory(
+            implPtr, shmName, static_cast<uint32_t>(shmSlotCount), static_cast<uint64_t>(shmSlotSize));
+#endif
+
+    std::vector<std::shared_ptr<Interface>> implPtrs;
+    if (!doRescore && !createInstances(implPtr, numJobs, configDir, configFile, implPtrs))
+        return FAILURE;
+
+    std::unique_ptr<ArtifactStoreWriter> storeWriter;
+    std::unique_ptr<ArtifactStoreReader> storeReader;
+    try
+    {
+        if (!storeFile.empty())
+            storeWriter = std::make_unique<ArtifactStoreWriter>(storeFile.string());
+        if (!restoreFile.empty())
+            storeReader = std::make_unique<ArtifactStoreReader>(restoreFile.string());
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "[ERROR] " << e.what() << endl;
+        return FAILURE;
+    }
+
+    BatchOptions options;
+    options.prefetchLookAhead = static_cast<size_t>(prefetchLookAhead);
+    options.numDecodeThreads = static_cast<size_t>(numDecodeThreads);
+    options.recursive = recursive;
+    options.shard = shard;
+
+    // resume a job from its journal: drop a result written after the last checkpoint
+    // and skip the images processed before
+    std::unique_ptr<CheckpointJournal> journal;
+    std::streamoff resumeOffset = 0;
+    if (!journalFile.empty())
+    {
+        try
+        {
+            journal = std::make_unique<CheckpointJournal>(journalFile);
+            resumeOffset = journal->GetOutputSize();
+            if (resumeOffset > 0)
+            {
+                fs::resize_file(outputFile, static_cast<uintmax_t>(resumeOffset));
+                cout << "[INFO] Resuming after " << journal->GetDone().size() << " image(s)" << endl;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            cerr << "[ERROR] " << e.what() << endl;
+            return FAILURE;
+        }
+        options.done = &journal->GetDone();
+        options.journal = journal.get();
+    }
+
+    std::unique_ptr<ColumnarResultsWriter> columnarWriter;
+    if (!columnarFile.empty() && !doRescore)
+    {
+        try
+        {
+            columnarWriter = std::make_unique<ColumnarResultsWriter>(columnarFile.string());
+        }
+        catch (const std::exception& e)
+        {
+            cerr << "[ERROR] " << e.what() << endl;
+            return FAILURE;
+        }
+        options.columnarWriter = columnarWriter.get();
+    }
+
     // write to output file
+    int result = SUCCESS;
     if (outputFile != nullptr)
     {
-        std::ofstream ofs(outputFile);
+        std::ofstream ofs(outputFile, resumeOffset > 0 ? std::ios::app : std::ios::trunc);
         if (ofs.good())
         {
-            runQuality(implPtr, inputFile, &ofs);
+            if (doRescore)
+                return runRescore(implPtr, inputFile, &ofs);
+            result = runQuality(implPtrs, inputFile, &ofs, false, storeWriter.get(), storeReader.get(),
+                options, resumeOffset == 0);
         }
         else
         {
@@ -384,10 +1352,29 @@ int main(int argc, char* argv[])
         return FAILURE;
         }
     }
+    else if (doRescore)
+    {
+        return runRescore(implPtr, inputFile, &std::cout);
+    }
     else
     {
-        runQuality(implPtr, inputFile, &std::cout);
+        // without an output file, only the columnar results are written if requested
+        result = runQuality(implPtrs, inputFile, columnarWriter ? nullptr : &std::cout, false,
+            storeWriter.get(), storeReader.get(), options);
+    }
+
+    if (columnarWriter)
+    {
+        try
+        {
+            columnarWriter->Close();
+        }
+        catch (const std::exception& e)
+        {
+            cerr << "[ERROR] " << e.what() << endl;
+            return FAILURE;
+        }
     }
 
-    return 0;
+    return result;
 }
@@ -0,0 +1,687 @@
+/**
+ * @file OFIQSampleServer.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#if defined _WIN32 && defined OFIQ_EXPORTS
+#undef OFIQ_EXPORTS
+#endif
+
+#include "OFIQSampleServer.h"
+
+#ifndef _WIN32
+#include "image_io.h"
+#include "SharedMemoryRing.h"
+#include "OFIQError.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <opencv2/core.hpp>
+
+using namespace std;
+using namespace OFIQ;
+using namespace OFIQ_LIB;
+
+/**
+ * @brief Set by the signal handlers to stop the server modes.
+ */
+static volatile std::sig_atomic_t stopRequested = 0;
+
+extern "C" void onStopSignal(int)
+{
+    stopRequested = 1;
+}
+
+namespace
+{
+    /**
+     * @brief Response of the server mode to a single request.
+     */
+    struct ServerResponse
+    {
+        /**
+         * @brief Column names of an assessment result, empty for errors.
+         */
+        std::string header;
+
+        /**
+         * @brief Response line without line break.
+         */
+        std::string line;
+    };
+
+    /**
+     * @brief Request of a client of the server mode.
+     */
+    struct ServerRequest
+    {
+        /**
+         * @brief Image path, or name of an image passed as encoded bytes.
+         */
+        std::string reference;
+
+        /**
+         * @brief JPEG or PNG encoded image, empty if the image is read from the path.
+         */
+        std::vector<uint8_t> encodedImage;
+
+        /**
+         * @brief Promise fulfilled by the worker processing the request.
+         */
+        std::promise<ServerResponse> response;
+    };
+
+    /**
+     * @brief Bounded queue of requests shared by the workers of the server mode.
+     * @details Requests exceeding the capacity are not queued but rejected, such that
+     * clients learn about an overload immediately instead of experiencing growing latencies.
+     */
+    class ServerRequestQueue
+    {
+    public:
+        explicit ServerRequestQueue(size_t capacity) : m_capacity(capacity) {}
+
+        bool TryPush(std::unique_ptr<ServerRequest>& request)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_closed || m_requests.size() >= m_capacity)
+                    return false;
+                m_requests.push_back(std::move(request));
+            }
+            m_condition.notify_one();
+            return true;
+        }
+
+        std::unique_ptr<ServerRequest> Pop()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_closed || !m_requests.empty(); });
+            if (m_requests.empty())
+                return nullptr;
+            auto request = std::move(m_requests.front());
+            m_requests.pop_front();
+            return request;
+        }
+
+        void Close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_closed = true;
+            }
+            m_condition.notify_all();
+        }
+
+    private:
+        size_t m_capacity;
+        bool m_closed = false;
+        std::deque<std::unique_ptr<ServerRequest>> m_requests;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+    };
+
+    /**
+     * @brief Buffered reading of lines and byte blocks from a socket.
+     */
+    class SocketReader
+    {
+    public:
+        explicit SocketReader(int fd) : m_fd(fd) {}
+
+        bool ReadLine(std::string& line)
+        {
+            line.clear();
+            while (true)
+            {
+                auto newline = std::find(m_buffer.begin() + m_position, m_buffer.end(), '\n');
+                if (newline != m_buffer.end())
+                {
+                    line.assign(m_buffer.begin() + m_position, newline);
+                    m_position = newline - m_buffer.begin() + 1;
+                    if (!line.empty() && line.back() == '\r')
+                        line.pop_back();
+                    return true;
+                }
+                if (!Fill())
+                    return false;
+            }
+        }
+
+        bool ReadBytes(size_t size, std::vector<uint8_t>& bytes)
+        {
+            bytes.clear();
+            bytes.reserve(size);
+            while (bytes.size() < size)
+            {
+                if (m_position == m_buffer.size() && !Fill())
+                    return false;
+                auto n = std::min(size - bytes.size(), m_buffer.size() - m_position);
+                bytes.insert(bytes.end(), m_buffer.begin() + m_position, m_buffer.begin() + m_position + n);
+                m_position += n;
+            }
+            return true;
+        }
+
+    private:
+        bool Fill()
+        {
+            m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_position);
+            m_position = 0;
+            char chunk[65536];
+            ssize_t n;
+            do
+                n = recv(m_fd, chunk, sizeof(chunk), 0);
+            while (n < 0 && errno == EINTR);
+            if (n <= 0)
+                return false;
+            m_buffer.insert(m_buffer.end(), chunk, chunk + n);
+            return true;
+        }
+
+        int m_fd;
+        std::vector<char> m_buffer;
+        size_t m_position = 0;
+    };
+
+    bool sendAll(int fd, const std::string& data)
+    {
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            auto n = send(fd, data.data() + sent, data.size() - sent, 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    std::string toResponseField(std::string text)
+    {
+        std::replace(text.begin(), text.end(), '\n', ' ');
+        std::replace(text.begin(), text.end(), ';', ',');
+        return text;
+    }
+
+    void serverWorker(const std::shared_ptr<Interface>& implPtr, ServerRequestQueue& queue)
+    {
+        while (auto request = queue.Pop())
+        {
+            ServerResponse response;
+            try
+            {
+                FaceImageQualityAssessment assessments;
+                auto start_time = std::chrono::high_resolution_clock::now();
+                ReturnStatus retStatus;
+                if (request->encodedImage.empty())
+                {
+                    Image image;
+                    retStatus = readImage(request->reference, image);
+                    if (retStatus.code == ReturnCode::Success)
+                        retStatus = implPtr->vectorQuality(image, assessments);
+                }
+                else
+                {
+                    retStatus = implPtr->vectorQualityFromEncodedImage(request->encodedImage, assessments);
+                }
+                auto end_time = std::chrono::high_resolution_clock::now();
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+
+                // like in the result file, images without a face are reported with failed measures
+                if (assessments.qAssessments.empty())
+                {
+                    response.line = "ERROR;" + toResponseField(request->reference) + ';' + toResponseField(retStatus.info);
+                }
+                else
+                {
+                    response.header = "HEADER;" + exportAssessmentHeaderToString(assessments);
+                    response.line = "OK;" + toResponseField(request->reference) + ';'
+                        + exportAssessmentResultsToString(assessments, false) + ';'
+                        + exportAssessmentResultsToString(assessments, true) + ';'
+                        + std::to_string(elapsed.count());
+                }
+            }
+            catch (const std::exception& e)
+            {
+                response.line = "ERROR;" + toResponseField(request->reference) + ';' + toResponseField(e.what());
+            }
+            request->response.set_value(std::move(response));
+        }
+    }
+
+    ServerResponse immediateResponse(const std::string& status, const std::string& reference, const std::string& info = "")
+    {
+        ServerResponse response;
+        response.line = status + ';' + toResponseField(reference);
+        if (!info.empty())
+            response.line += ';' + info;
+        return response;
+    }
+
+    /**
+     * @brief Serves the requests of one client.
+     * @details The requests are read and queued while earlier ones are processed; the responses
+     * are written in the order of the requests by a separate thread. The socket is shut down
+     * when the client has quit, but closed by the caller.
+     */
+    void serveConnection(int fd, ServerRequestQueue& queue, size_t maxPending)
+    {
+        std::deque<std::future<ServerResponse>> pending;
+        bool readerDone = false;
+        std::mutex mutex;
+        std::condition_variable condition;
+
+        std::thread writer([&]
+            {
+                bool headerSent = false;
+                bool connected = true;
+                while (true)
+                {
+                    std::future<ServerResponse> next;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        condition.wait(lock, [&] { return readerDone || !pending.empty(); });
+                        if (pending.empty())
+                            break;
+                        next = std::move(pending.front());
+                    }
+                    ServerResponse response;
+                    try
+                    {
+                        response = next.get();
+                    }
+                    catch (const std::future_error&)
+                    {
+                        response = immediateResponse("ERROR", "", "server shutting down");
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        pending.pop_front();
+                    }
+                    condition.notify_all();
+
+                    std::string data;
+                    if (!headerSent && !response.header.empty())
+                    {
+                        data = response.header + '\n';
+                        headerSent = true;
+                    }
+                    data += response.line + '\n';
+                    // keep draining after the client has gone to not block the reader
+                    connected = connected && sendAll(fd, data);
+                }
+            });
+
+        auto addResponse = [&](std::future<ServerResponse> response)
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                // back pressure on clients sending requests faster than reading responses
+                condition.wait(lock, [&] { return pending.size() < maxPending; });
+                pending.push_back(std::move(response));
+                lock.unlock();
+                condition.notify_all();
+            };
+        auto addImmediateResponse = [&](const ServerResponse& response)
+            {
+                std::promise<ServerResponse> promise;
+                promise.set_value(response);
+                addResponse(promise.get_future());
+            };
+
+        // maximal size of an encoded image passed with BYTES
+        constexpr size_t maxEncodedImageSize = 256 * 1024 * 1024;
+
+        SocketReader reader(fd);
+        std::string line;
+        while (reader.ReadLine(line))
+        {
+            if (line.empty())
+                continue;
+            auto request = std::make_unique<ServerRequest>();
+            if (line.rfind("PATH ", 0) == 0)
+            {
+                request->reference = line.substr(5);
+            }
+            else if (line.rfind("BYTES ", 0) == 0)
+            {
+                std::stringstream stream(line.substr(6));
+                size_t size = 0;
+                stream >> size;
+                std::getline(stream >> std::ws, request->reference);
+                if (size == 0 || size > maxEncodedImageSize)
+                {
+                    // the request cannot be skipped, thus the connection is closed
+                    addImmediateResponse(immediateResponse("ERROR", request->reference, "invalid image size"));
+                    break;
+                }
+                if (!reader.ReadBytes(size, request->encodedImage))
+                    break;
+            }
+            else if (line == "QUIT")
+            {
+                break;
+            }
+            else
+            {
+                addImmediateResponse(immediateResponse("ERROR", "", "unknown request"));
+                continue;
+            }
+
+            auto reference = request->reference;
+            auto response = request->response.get_future();
+            if (queue.TryPush(request))
+                addResponse(std::move(response));
+            else
+                addImmediateResponse(immediateResponse("BUSY", reference));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            readerDone = true;
+        }
+        condition.notify_all();
+        writer.join();
+        shutdown(fd, SHUT_RDWR);
+    }
+
+    /**
+     * @brief Creates the listening Unix domain socket and installs the signal handlers.
+     * @return File descriptor of the socket, -1 on failure.
+     */
+    int createServerSocket(const std::string& socketPath)
+    {
+        sockaddr_un address{};
+        if (socketPath.size() >= sizeof(address.sun_path))
+        {
+            cerr << "[ERROR] Socket path too long: " << socketPath << endl;
+            return -1;
+        }
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+        int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(socketPath.c_str());
+        if (listenFd < 0 ||
+            bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listenFd, SOMAXCONN) != 0)
+        {
+            cerr << "[ERROR] Could not listen on " << socketPath << ": " << std::strerror(errno) << endl;
+            if (listenFd >= 0)
+                close(listenFd);
+            return -1;
+        }
+        // the socket may be shared by forked processes, accept() must not block if another one was faster
+        fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL) | O_NONBLOCK);
+
+        std::signal(SIGPIPE, SIG_IGN);
+        std::signal(SIGINT, onStopSignal);
+        std::signal(SIGTERM, onStopSignal);
+        return listenFd;
+    }
+
+    int runServer(
+        const std::vector<std::shared_ptr<Interface>>& implPtrs,
+        int listenFd,
+        size_t queueCapacity)
+    {
+        constexpr size_t maxConnections = 64;
+
+        ServerRequestQueue queue(queueCapacity);
+        std::vector<std::thread> workers;
+        for (const auto& implPtr : implPtrs)
+            workers.emplace_back(serverWorker, implPtr, std::ref(queue));
+
+        struct Connection
+        {
+            int fd;
+            std::thread thread;
+            std::shared_ptr<std::atomic<bool>> done;
+        };
+        std::list<Connection> connections;
+
+        while (!stopRequested)
+        {
+            connections.remove_if([](Connection& connection)
+                {
+                    if (!connection.done->load())
+                        return false;
+                    connection.thread.join();
+                    close(connection.fd);
+                    return true;
+                });
+
+            pollfd pfd{ listenFd, POLLIN, 0 };
+            if (poll(&pfd, 1, 200) <= 0)
+                continue;
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0)
+                continue;
+            // on some platforms the connection inherits the non-blocking mode of the listening socket
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+            if (connections.size() >= maxConnections)
+            {
+                sendAll(fd, "BUSY;\n");
+                close(fd);
+                continue;
+            }
+
+            auto done = std::make_shared<std::atomic<bool>>(false);
+            std::thread thread([fd, &queue, queueCapacity, done]
+                {
+                    serveConnection(fd, queue, queueCapacity);
+                    done->store(true);
+                });
+            connections.push_back({ fd, std::move(thread), done });
+        }
+
+        for (auto& connection : connections)
+        {
+            if (!connection.done->load())
+                shutdown(connection.fd, SHUT_RDWR);
+        }
+        queue.Close();
+        for (auto& worker : workers)
+            worker.join();
+        for (auto& connection : connections)
+        {
+            connection.thread.join();
+            close(connection.fd);
+        }
+
+        return SUCCESS;
+    }
+
+    /**
+     * @brief Runs the server mode in several processes sharing the models.
+     * @details The instance has been initialized with fork safe threading before, such that the
+     * forked processes share the model weights copy-on-write and create their own thread pools.
+     * Each process serves the listening socket with the instance; processes terminating
+     * unexpectedly are replaced.
+     */
+    int runPreforkServer(
+        const std::shared_ptr<Interface>& implPtr,
+        int listenFd,
+        int numProcesses,
+        size_t queueCapacity)
+    {
+        auto startProcess = [&]() -> pid_t
+            {
+                // avoid writing buffered output twice
+                cout.flush();
+                cerr.flush();
+                pid_t pid = fork();
+                if (pid == 0)
+                {
+                    // OpenCV has been single threaded in the parent, the pool is created here on demand
+                    cv::setNumThreads(std::max(1, cv::getNumberOfCPUs() / numProcesses));
+                    std::exit(runServer({ implPtr }, listenFd, queueCapacity));
+                }
+                if (pid < 0)
+                    cerr << "[ERROR] fork() failed: " << std::strerror(errno) << endl;
+                return pid;
+            };
+
+        std::set<pid_t> processes;
+        for (int i = 0; i < numProcesses; i++)
+        {
+            if (pid_t pid = startProcess(); pid > 0)
+                processes.insert(pid);
+        }
+
+        while (!stopRequested && !processes.empty())
+        {
+            int status = 0;
+            pid_t pid = waitpid(-1, &status, WNOHANG);
+            if (pid <= 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                continue;
+            }
+            processes.erase(pid);
+            if (stopRequested)
+                break;
+            cerr << "[ERROR] Worker process " << pid << " terminated unexpectedly, restarting it." << endl;
+            if (pid_t newPid = startProcess(); newPid > 0)
+                processes.insert(newPid);
+        }
+
+        for (pid_t pid : processes)
+            kill(pid, SIGTERM);
+        for (pid_t pid : processes)
+            waitpid(pid, nullptr, 0);
+        return SUCCESS;
+    }
+
+}
+
+int runSocketServer(
+    const std::vector<std::shared_ptr<Interface>>& implPtrs,
+    const std::string& socketPath,
+    int numProcesses,
+    size_t queueCapacity)
+{
+    int listenFd = createServerSocket(socketPath);
+    if (listenFd < 0)
+        return FAILURE;
+    cout << "[INFO] Listening on " << socketPath << " with "
+         << (numProcesses > 0 ? numProcesses : static_cast<int>(implPtrs.size()))
+         << (numProcesses > 0 ? " process(es)" : " worker(s)") << endl;
+    int result = numProcesses > 0 ?
+        runPreforkServer(implPtrs.front(), listenFd, numProcesses, queueCapacity) :
+        runServer(implPtrs, listenFd, queueCapacity);
+    cout << "[INFO] Stopping server" << endl;
+    close(listenFd);
+    unlink(socketPath.c_str());
+    return result;
+}
+
+int runSharedMemory(
+    const std::shared_ptr<Interface>& implPtr,
+    const std::string& name,
+    uint32_t slotCount,
+    uint64_t slotSize)
+{
+    std::unique_ptr<SharedMemoryRing> frames;
+    std::unique_ptr<SharedMemoryRing> results;
+    try
+    {
+        frames = SharedMemoryRing::Create(name + "_frames", slotCount, slotSize);
+        results = SharedMemoryRing::Create(name + "_results", slotCount, sizeof(SharedMemoryResult));
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "[ERROR] " << e.what() << endl;
+        return FAILURE;
+    }
+
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+
+    // the rings have no blocking wait, poll them with a short pause when idle
+    constexpr auto idlePause = std::chrono::microseconds(200);
+
+    cout << "[INFO] Reading frames from " << name << "_frames with " << slotCount << " slots of "
+         << frames->GetSlotSize() << " bytes" << endl;
+    while (!stopRequested)
+    {
+        const uint8_t* slot = frames->TryAcquireRead();
+        if (slot == nullptr)
+        {
+            if (frames->IsClosed())
+                break;
+            std::this_thread::sleep_for(idlePause);
+            continue;
+        }
+
+        uint64_t sequence = 0;
+        FaceImageQualityAssessment assessments;
+        ReturnStatus retStatus;
+        try
+        {
+            Image image = wrapSharedMemoryFrame(slot, frames->GetSlotSize(), sequence);
+            retStatus = implPtr->vectorQuality(image, assessments);
+        }
+        catch (const OFIQError& e)
+        {
+            retStatus = { e.whatCode(), e.what() };
+        }
+
+        uint8_t* resultSlot;
+        while ((resultSlot = results->TryAcquireWrite()) == nullptr && !stopRequested)
+            std::this_thread::sleep_for(idlePause);
+        if (resultSlot != nullptr)
+        {
+            writeSharedMemoryResult(resultSlot, sequence, retStatus, assessments);
+            results->CommitWrite();
+        }
+        // the frame is returned to the producer not until the assessment is done
+        frames->ReleaseRead();
+    }
+
+    results->Close();
+    return SUCCESS;
+}
+#endif
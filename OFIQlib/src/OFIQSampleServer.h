@@ -0,0 +1,109 @@
+/**
+ * @file OFIQSampleServer.h
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#ifndef OFIQ_SAMPLE_SERVER_H
+#define OFIQ_SAMPLE_SERVER_H
+
+#include "ofiq_lib.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Exit code of the sample application on success.
+ */
+constexpr int SUCCESS = 0;
+
+/**
+ * @brief Exit code of the sample application on failure.
+ */
+constexpr int FAILURE = 1;
+
+/**
+ * @brief Formats the raw scores or scalar values of an assessment as semicolon separated list,
+ * implemented by the sample application.
+ */
+std::string exportAssessmentResultsToString(
+    const OFIQ::FaceImageQualityAssessment& assessments,
+    bool doExportScalar = false);
+
+/**
+ * @brief Formats the column names of an assessment, implemented by the sample application.
+ */
+std::string exportAssessmentHeaderToString(
+    const OFIQ::FaceImageQualityAssessment& assessments);
+
+#ifndef _WIN32
+/**
+ * @brief Runs the server mode until SIGINT or SIGTERM.
+ * @details Clients connect to the Unix domain socket and send requests line by line:
+ *   PATH imageFile             assess the image file
+ *   BYTES size [name]          assess the JPEG or PNG encoded image following the line
+ *   QUIT                       close the connection
+ * For each request one line is returned, in the order of the requests:
+ *   OK;name;raw scores;scalar values;assessment_time_in_ms
+ *   ERROR;name;message
+ *   BUSY;name                  the request queue is full, retry later
+ * The first OK line of a connection is preceded by a line HEADER;column names.
+ *
+ * @param implPtrs Initialized instances, each owned by one worker thread.
+ * @param socketPath Path of the Unix domain socket.
+ * @param numProcesses Number of processes forked to serve the socket with the first
+ * instance, which must have been initialized with fork safe threading; 0 to serve with
+ * worker threads in this process.
+ * @param queueCapacity Number of requests waiting for a worker before further requests
+ * are rejected.
+ * @return SUCCESS or FAILURE.
+ */
+int runSocketServer(
+    const std::vector<std::shared_ptr<OFIQ::Interface>>& implPtrs,
+    const std::string& socketPath,
+    int numProcesses,
+    size_t queueCapacity);
+
+/**
+ * @brief Runs the shared memory mode.
+ * @details The frames are read in place from the ring name_frames and the results are
+ * written to the ring name_results, see \link OFIQ_LIB::SharedMemoryRing SharedMemoryRing\endlink.
+ * Both rings are created here, the capture application opens them. The mode ends when the
+ * capture application closes the frame ring or on SIGINT or SIGTERM.
+ *
+ * @param implPtr Initialized instance.
+ * @param name Name prefix of the rings.
+ * @param slotCount Number of slots of both rings.
+ * @param slotSize Number of bytes of a frame slot including its header.
+ * @return SUCCESS or FAILURE.
+ */
+int runSharedMemory(
+    const std::shared_ptr<OFIQ::Interface>& implPtr,
+    const std::string& name,
+    uint32_t slotCount,
+    uint64_t slotSize);
+#endif
+
+#endif
@@ -48,10 +48,18 @@ list(APPEND module_sources
 	${OFIQLIB_SOURCE_DIR}/modules/segmentations/src/FaceOcclusionSegmentation.cpp
 	${OFIQLIB_SOURCE_DIR}/modules/segmentations/src/segmentations.cpp
 	${OFIQLIB_SOURCE_DIR}/modules/utils/src/Configuration.cpp
+	${OFIQLIB_SOURCE_DIR}/modules/utils/src/EncodedImage.cpp
+	${OFIQLIB_SOURCE_DIR}/modules/utils/src/ResultCache.cpp
+	${OFIQLIB_SOURCE_DIR}/modules/utils/src/ArtifactStore.cpp
+	${OFIQLIB_SOURCE_DIR}/modules/utils/src/BitMask.cpp
+	${OFIQLIB_SOURCE_DIR}/modules/utils/src/ClassHistogram.cpp
+	${OFIQLIB_SOURCE_DIR}/modules/utils/src/ColumnarResults.cpp
+	${OFIQLIB_SOURCE_DIR}/modules/utils/src/SharedMemoryRing.cpp
 	${OFIQLIB_SOURCE_DIR}/modules/utils/src/OFIQError.cpp
 	${OFIQLIB_SOURCE_DIR}/modules/utils/src/image_io.cpp
 	${OFIQLIB_SOURCE_DIR}/modules/utils/src/image_utils.cpp
 	${OFIQLIB_SOURCE_DIR}/modules/utils/src/Session.cpp
+	${OFIQLIB_SOURCE_DIR}/modules/utils/src/TreeEnsemble.cpp
 	${OFIQLIB_SOURCE_DIR}/modules/utils/src/utils.cpp
 )
 
@@ -102,10 +110,18 @@ list(APPEND module_headers
 	${OFIQLIB_SOURCE_DIR}/modules/segmentations/FaceOcclusionSegmentation.h
 	${OFIQLIB_SOURCE_DIR}/modules/segmentations/segmentations.h
 	${OFIQLIB_SOURCE_DIR}/modules/utils/Configuration.h
+	${OFIQLIB_SOURCE_DIR}/modules/utils/EncodedImage.h
+	${OFIQLIB_SOURCE_DIR}/modules/utils/ResultCache.h
+	${OFIQLIB_SOURCE_DIR}/modules/utils/ArtifactStore.h
+	${OFIQLIB_SOURCE_DIR}/modules/utils/BitMask.h
+	${OFIQLIB_SOURCE_DIR}/modules/utils/ClassHistogram.h
+	${OFIQLIB_SOURCE_DIR}/modules/utils/ColumnarResults.h
+	${OFIQLIB_SOURCE_DIR}/modules/utils/SharedMemoryRing.h
 	${OFIQLIB_SOURCE_DIR}/modules/utils/OFIQError.h
 	${OFIQLIB_SOURCE_DIR}/modules/utils/image_io.h
 	${OFIQLIB_SOURCE_DIR}/modules/utils/image_utils.h
 	${OFIQLIB_SOURCE_DIR}/modules/utils/NeuronalNetworkContainer.h
 	${OFIQLIB_SOURCE_DIR}/modules/utils/Session.h
+	${OFIQLIB_SOURCE_DIR}/modules/utils/TreeEnsemble.h
 	${OFIQLIB_SOURCE_DIR}/modules/utils/utils.h
 )
\ No newline at end of file
@@ -148,6 +148,15 @@
  *   original image prior face detection. Note, the specified value 0.2 (fixed for OFIQ) has 
  *   been determined experimentally.</td> 
  *  </tr>
+ *  <tr>
+ *   <td>downscaled_input</td><td>optional, <code>false</code> by default; if <code>true</code>,
+ *   the image is resampled directly into the 300x300 input of the network instead of being padded
+ *   and resized, which saves a padded copy of the full resolution image. The sub-pixel positions
+ *   of the resampling differ from those of the resize, such that detected bounding boxes may differ
+ *   by a pixel and the conformance test table is not necessarily reproduced. Encoded images
+ *   assessed via \link OFIQ::Interface::vectorQualityFromEncodedImage() vectorQualityFromEncodedImage()\endlink
+ *   are always detected on a down-scaled thumbnail this way.</td>
+ *  </tr>
  * </table>
  * 
  * @subsection sec_facelandmark_cfg Configuration of the landmark extractor
@@ -297,7 +306,12 @@
  *  <td>Unified quality score</td>
  *  <td>"config".<br/>"params".<br/>"measures".<br/>"UnifiedQualityScore"</td>
  *  <td>"config".<br/>"measures".<br/>"UnifiedQualityScore"</td>
- *  <td><code>model_path</code>: Path to an iResNet50 model file in ONNX format</td>
+ *  <td><code>model_path</code>: Path to an iResNet50 model file in ONNX format
+ *   <br/><br/>
+ *   <code>export_embedding</code>: If true, the first output of the model with more than one element, e.g. the
+ *   MagFace feature vector, is returned in <code>FaceImageQualityAssessment::embedding</code>. Default is false.
+ *   The model shipped with OFIQ only outputs the feature norm, i.e. the embedding stays empty.
+ *  </td>
  *  <td>yes</td>
  *  </tr>
  *
@@ -542,6 +556,8 @@
  *   <br/><br/>
  *   <code>adaboost_model_path</code>: Path to the AdaBoost classifier model file <code>hse_1_2_C_adaboost.yml.gz</code> from
  *   <a href="https://github.com/dasec/Efficient-Expression-Neutrality-Estimation">here</a>
+ *   <br/><br/>
+ *   <code>concurrent_inference</code>: If true (default), the two CNN models run concurrently in separate threads
  *  </td>
  *  <td>yes</td>
  *  </tr>
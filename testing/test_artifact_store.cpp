@@ -0,0 +1,236 @@
+/**
+ * @file test_artifact_store.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "ArtifactStore.h"
+#include "OFIQError.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using namespace OFIQ_LIB;
+
+namespace
+{
+	std::vector<uint8_t> recordOf(size_t size, uint8_t seed)
+	{
+		std::vector<uint8_t> record(size);
+		for (size_t i = 0; i < size; i++)
+			record[i] = static_cast<uint8_t>(seed + i * 7);
+		return record;
+	}
+
+	class ArtifactStoreTest : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			path = (fs::temp_directory_path() / "ofiq_test_artifact_store.bin").string();
+			fs::remove(path);
+		}
+
+		void TearDown() override
+		{
+			fs::remove(path);
+		}
+
+		std::vector<char> readFile() const
+		{
+			std::ifstream stream(path, std::ios::binary);
+			return std::vector<char>((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		}
+
+		void writeFile(const std::vector<char>& file) const
+		{
+			std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+			stream.write(file.data(), static_cast<std::streamsize>(file.size()));
+		}
+
+		template<typename T>
+		void patch(std::vector<char>& file, size_t offset, T value) const
+		{
+			std::memcpy(file.data() + offset, &value, sizeof(T));
+		}
+
+		// writes a store of three records and returns its bytes
+		std::vector<char> writeStore() const
+		{
+			ArtifactStoreWriter writer(path);
+			writer.Add("first.png", recordOf(100, 1));
+			writer.Add("second.png", recordOf(3, 2));
+			writer.Add("third.png", recordOf(64, 3));
+			writer.Close();
+			return readFile();
+		}
+
+		std::string path;
+	};
+}
+
+TEST_F(ArtifactStoreTest, RoundTrip)
+{
+	const std::vector<std::pair<std::string, std::vector<uint8_t>>> records = {
+		{ "images/a.png", recordOf(1000, 1) },
+		{ "images/b.png", recordOf(1, 2) },
+		{ "images/empty.png", {} },
+		{ "", recordOf(65, 3) },
+		{ "images/c.png", recordOf(64, 4) }
+	};
+	{
+		ArtifactStoreWriter writer(path);
+		for (const auto& [key, record] : records)
+			writer.Add(key, record);
+	}
+
+	ArtifactStoreReader reader(path);
+	std::vector<std::string> keys;
+	for (const auto& record : records)
+		keys.push_back(record.first);
+	EXPECT_EQ(reader.GetKeys(), keys);
+
+	for (const auto& [key, record] : records)
+	{
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+		ASSERT_TRUE(reader.Find(key, data, size)) << key;
+		ASSERT_EQ(size, record.size()) << key;
+		EXPECT_EQ(std::vector<uint8_t>(data, data + size), record) << key;
+		// the mapping starts at a page boundary, thus the records are aligned in memory
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % 64, 0u) << key;
+	}
+
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	EXPECT_FALSE(reader.Find("images/missing.png", data, size));
+}
+
+TEST_F(ArtifactStoreTest, LastRecordOfAKeyIsFound)
+{
+	{
+		ArtifactStoreWriter writer(path);
+		writer.Add("image.png", recordOf(10, 1));
+		writer.Add("other.png", recordOf(10, 2));
+		writer.Add("image.png", recordOf(20, 3));
+	}
+	ArtifactStoreReader reader(path);
+	EXPECT_EQ(reader.GetKeys(), std::vector<std::string>({ "image.png", "other.png" }));
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	ASSERT_TRUE(reader.Find("image.png", data, size));
+	EXPECT_EQ(std::vector<uint8_t>(data, data + size), recordOf(20, 3));
+}
+
+TEST_F(ArtifactStoreTest, EmptyStore)
+{
+	{
+		ArtifactStoreWriter writer(path);
+	}
+	ArtifactStoreReader reader(path);
+	EXPECT_TRUE(reader.GetKeys().empty());
+}
+
+TEST_F(ArtifactStoreTest, AddAfterCloseThrows)
+{
+	ArtifactStoreWriter writer(path);
+	writer.Close();
+	EXPECT_THROW(writer.Add("image.png", recordOf(1, 1)), OFIQError);
+}
+
+TEST_F(ArtifactStoreTest, MissingFileThrows)
+{
+	EXPECT_THROW(ArtifactStoreReader reader(path), OFIQError);
+}
+
+TEST_F(ArtifactStoreTest, CorruptStoresAreRejected)
+{
+	const std::vector<char> valid = writeStore();
+	ASSERT_NO_THROW(ArtifactStoreReader reader(path));
+
+	const size_t footer = valid.size() - 24;
+	uint64_t indexOffset;
+	std::memcpy(&indexOffset, valid.data() + footer, sizeof(indexOffset));
+
+	auto expectRejected = [this](const std::vector<char>& file, const std::string& description)
+		{
+			writeFile(file);
+			EXPECT_THROW(ArtifactStoreReader reader(path), OFIQError) << description;
+		};
+
+	auto file = valid;
+	file[0] ^= 1;
+	expectRejected(file, "bad leading magic");
+
+	file = valid;
+	file.back() ^= 1;
+	expectRejected(file, "bad trailing magic");
+
+	expectRejected(std::vector<char>(valid.begin(), valid.end() - 1), "truncated footer");
+	expectRejected(std::vector<char>(valid.begin(), valid.begin() + 20), "truncated store");
+	expectRejected(std::vector<char>(), "empty file");
+
+	file = valid;
+	patch<uint64_t>(file, footer, valid.size());
+	expectRejected(file, "index offset beyond the file");
+
+	file = valid;
+	patch<uint64_t>(file, footer, footer - 8);
+	expectRejected(file, "index offset within the footer");
+
+	file = valid;
+	patch<uint64_t>(file, footer + 8, 4);
+	expectRejected(file, "more records than the index holds");
+
+	file = valid;
+	patch<uint64_t>(file, footer + 8, ~0ULL);
+	expectRejected(file, "huge number of records");
+
+	file = valid;
+	patch<uint64_t>(file, indexOffset, indexOffset);
+	expectRejected(file, "record starting at the index");
+
+	file = valid;
+	patch<uint64_t>(file, indexOffset + 8, indexOffset);
+	expectRejected(file, "record overlapping the index");
+
+	file = valid;
+	patch<uint64_t>(file, indexOffset + 8, ~0ULL);
+	expectRejected(file, "huge record size");
+
+	file = valid;
+	patch<uint64_t>(file, indexOffset + 16, 1000);
+	expectRejected(file, "key exceeding the index");
+
+	file = valid;
+	patch<uint64_t>(file, indexOffset + 16, ~0ULL);
+	expectRejected(file, "huge key length");
+}
@@ -0,0 +1,190 @@
+/**
+ * @file test_bit_mask.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "BitMask.h"
+
+#include <gtest/gtest.h>
+#include <opencv2/core.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace OFIQ_LIB;
+
+namespace
+{
+	// origins around word boundaries, such that the masks start at different words
+	const std::vector<int> origins = { -130, -65, -64, -63, -1, 0, 1, 63, 64, 65, 127, 200 };
+
+	// widths of at most one word as well as rows spanning two and more words
+	const std::vector<int> widths = { 1, 5, 63, 64, 65, 130, 200 };
+
+	cv::Mat randomMask(int rows, int cols, double density, std::mt19937& generator)
+	{
+		cv::Mat mask = cv::Mat::zeros(rows, cols, CV_8UC1);
+		std::bernoulli_distribution set(density);
+		std::uniform_int_distribution<int> value(1, 255);
+		for (int y = 0; y < rows; y++)
+			for (int x = 0; x < cols; x++)
+				if (set(generator))
+					mask.at<uchar>(y, x) = static_cast<uchar>(value(generator));
+		return mask;
+	}
+
+	bool isSet(const cv::Mat& mask, const cv::Point& origin, int x, int y)
+	{
+		const int col = x - origin.x;
+		const int row = y - origin.y;
+		return row >= 0 && row < mask.rows && col >= 0 && col < mask.cols && mask.at<uchar>(row, col) != 0;
+	}
+}
+
+TEST(BitMaskTest, EmptyMask)
+{
+	BitMask empty;
+	EXPECT_EQ(empty.CountNonZero(), 0);
+	EXPECT_TRUE(empty.GetRegion().empty());
+
+	BitMask zeroSized(cv::Mat::zeros(0, 0, CV_8UC1), cv::Point(17, 3));
+	EXPECT_EQ(zeroSized.CountNonZero(), 0);
+
+	BitMask mask(cv::Mat::zeros(4, 70, CV_8UC1), cv::Point(-5, 2));
+	EXPECT_EQ(mask.CountNonZero(), 0);
+	EXPECT_EQ(mask.CountNonZeroWithout(empty), 0);
+	EXPECT_EQ(empty.CountNonZeroWithout(mask), 0);
+}
+
+TEST(BitMaskTest, SinglePixelsAtWordBoundaries)
+{
+	for (int origin : origins)
+	{
+		cv::Mat row = cv::Mat::zeros(1, 130, CV_8UC1);
+		for (int x = 0; x < row.cols; x++)
+		{
+			// the last and first pixel of each word of the image
+			const int imageX = origin + x;
+			const int bit = ((imageX % 64) + 64) % 64;
+			if (bit == 0 || bit == 63)
+				row.at<uchar>(0, x) = 255;
+		}
+		BitMask mask(row, cv::Point(origin, -1));
+		EXPECT_EQ(mask.CountNonZero(), cv::countNonZero(row)) << "origin " << origin;
+
+		cv::Mat unpacked = mask.Unpack(mask.GetRegion());
+		for (int x = 0; x < row.cols; x++)
+			EXPECT_EQ(unpacked.at<uchar>(0, x), row.at<uchar>(0, x) ? 1 : 0) << "origin " << origin << ", x " << x;
+	}
+}
+
+TEST(BitMaskTest, CountNonZeroOfRandomMasks)
+{
+	std::mt19937 generator(4711);
+	for (int origin : origins)
+	{
+		for (int width : widths)
+		{
+			for (double density : { 0.0, 0.1, 0.5, 1.0 })
+			{
+				cv::Mat image = randomMask(7, width, density, generator);
+				BitMask mask(image, cv::Point(origin, origin / 2));
+				EXPECT_EQ(mask.CountNonZero(), cv::countNonZero(image))
+					<< "origin " << origin << ", width " << width << ", density " << density;
+				EXPECT_EQ(mask.GetRegion().x, origin);
+				EXPECT_EQ(mask.GetRegion().y, origin / 2);
+				EXPECT_EQ(mask.GetRegion().width, width);
+				EXPECT_EQ(mask.GetRegion().height, 7);
+			}
+		}
+	}
+}
+
+TEST(BitMaskTest, Unpack)
+{
+	std::mt19937 generator(815);
+	for (int origin : origins)
+	{
+		for (int width : widths)
+		{
+			cv::Mat image = randomMask(5, width, 0.4, generator);
+			const cv::Point position(origin, -2);
+			BitMask mask(image, position);
+
+			// the region of the mask, a region exceeding it on all sides and a partially overlapping region
+			const std::vector<cv::Rect> regions = {
+				mask.GetRegion(),
+				cv::Rect(origin - 70, -5, width + 140, 11),
+				cv::Rect(origin + width / 2, -1, width, 6)
+			};
+			for (const auto& region : regions)
+			{
+				cv::Mat unpacked = mask.Unpack(region);
+				ASSERT_EQ(unpacked.rows, region.height);
+				ASSERT_EQ(unpacked.cols, region.width);
+				for (int y = 0; y < region.height; y++)
+					for (int x = 0; x < region.width; x++)
+						ASSERT_EQ(unpacked.at<uchar>(y, x), isSet(image, position, region.x + x, region.y + y) ? 1 : 0)
+							<< "origin " << origin << ", width " << width << ", x " << region.x + x << ", y " << region.y + y;
+			}
+		}
+	}
+}
+
+TEST(BitMaskTest, CountNonZeroWithout)
+{
+	std::mt19937 generator(1234);
+	std::uniform_int_distribution<int> offset(-3, 3);
+	for (int origin : origins)
+	{
+		for (int width : widths)
+		{
+			cv::Mat image = randomMask(6, width, 0.5, generator);
+			const cv::Point position(origin, 0);
+			BitMask mask(image, position);
+
+			// masks overlapping at different word offsets, shifted rows and masks without overlap
+			for (int otherOrigin : origins)
+			{
+				for (int otherWidth : { 3, 64, 150 })
+				{
+					cv::Mat otherImage = randomMask(6, otherWidth, 0.5, generator);
+					const cv::Point otherPosition(otherOrigin, offset(generator));
+					BitMask other(otherImage, otherPosition);
+
+					int64_t expected = 0;
+					for (int y = 0; y < image.rows; y++)
+						for (int x = origin; x < origin + width; x++)
+							if (isSet(image, position, x, y) && !isSet(otherImage, otherPosition, x, y))
+								expected++;
+					EXPECT_EQ(mask.CountNonZeroWithout(other), expected)
+						<< "origin " << origin << ", width " << width
+						<< ", other origin " << otherOrigin << ", other width " << otherWidth;
+				}
+			}
+			EXPECT_EQ(mask.CountNonZeroWithout(mask), 0);
+			EXPECT_EQ(mask.CountNonZeroWithout(BitMask()), mask.CountNonZero());
+		}
+	}
+}
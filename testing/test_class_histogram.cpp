@@ -0,0 +1,163 @@
+/**
+ * @file test_class_histogram.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "ClassHistogram.h"
+
+#include <gtest/gtest.h>
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace OFIQ_LIB;
+
+namespace
+{
+	const int numRows = 37;
+	const int numCols = 53;
+
+	// labels of the face parsing classes and a label not occurring in the image
+	const std::vector<uchar> labels = { 0, 1, 5, 10, 17, 18, 200, 255 };
+
+	cv::Mat randomLabels(std::mt19937& generator)
+	{
+		cv::Mat image(numRows, numCols, CV_8UC1);
+		std::uniform_int_distribution<int> label(0, 18);
+		std::bernoulli_distribution maximal(0.02);
+		for (int y = 0; y < numRows; y++)
+			for (int x = 0; x < numCols; x++)
+				image.at<uchar>(y, x) = static_cast<uchar>(maximal(generator) ? 255 : label(generator));
+		return image;
+	}
+
+	int64_t bruteForceCount(const cv::Mat& image, uchar label, const cv::Range& rows, const cv::Range& cols)
+	{
+		int64_t count = 0;
+		for (int y = std::max(rows.start, 0); y < std::min(rows.end, image.rows); y++)
+			for (int x = std::max(cols.start, 0); x < std::min(cols.end, image.cols); x++)
+				count += image.at<uchar>(y, x) == label;
+		return count;
+	}
+
+	// empty, reversed, full, exceeding and single ranges of an interval of the given size
+	std::vector<cv::Range> specialRanges(int size)
+	{
+		return {
+			cv::Range(0, 0), cv::Range(5, 5), cv::Range(size, size), cv::Range(9, 4),
+			cv::Range(0, size), cv::Range(-7, size + 7), cv::Range(-3, 2), cv::Range(size - 2, size + 5),
+			cv::Range(size + 1, size + 9), cv::Range(3, 4), cv::Range(size - 1, size)
+		};
+	}
+
+	std::vector<cv::Range> randomRanges(int size, int count, std::mt19937& generator)
+	{
+		std::uniform_int_distribution<int> bound(0, size);
+		std::vector<cv::Range> ranges;
+		for (int i = 0; i < count; i++)
+		{
+			int start = bound(generator);
+			int end = bound(generator);
+			ranges.emplace_back(std::min(start, end), std::max(start, end));
+		}
+		return ranges;
+	}
+}
+
+TEST(ClassHistogramTest, EmptyLabelMap)
+{
+	ClassHistogram histogram;
+	EXPECT_EQ(histogram.Count(0), 0);
+	EXPECT_EQ(histogram.Count(0, cv::Range(0, 10), cv::Range(0, 10)), 0);
+	EXPECT_TRUE(histogram.GetMask(0).empty());
+}
+
+TEST(ClassHistogramTest, CountOfRows)
+{
+	std::mt19937 generator(2024);
+	cv::Mat image = randomLabels(generator);
+	ClassHistogram histogram(image);
+	EXPECT_EQ(histogram.GetSize().width, numCols);
+	EXPECT_EQ(histogram.GetSize().height, numRows);
+
+	auto ranges = specialRanges(numRows);
+	auto random = randomRanges(numRows, 50, generator);
+	ranges.insert(ranges.end(), random.begin(), random.end());
+	const cv::Range allCols(0, numCols);
+	for (uchar label : labels)
+	{
+		EXPECT_EQ(histogram.Count(label), bruteForceCount(image, label, cv::Range(0, numRows), allCols))
+			<< "label " << int(label);
+		for (const auto& rows : ranges)
+			EXPECT_EQ(histogram.Count(label, rows), bruteForceCount(image, label, rows, allCols))
+				<< "label " << int(label) << ", rows " << rows.start << ".." << rows.end;
+	}
+}
+
+TEST(ClassHistogramTest, CountOfRectangles)
+{
+	std::mt19937 generator(42);
+	cv::Mat image = randomLabels(generator);
+	ClassHistogram histogram(image);
+
+	auto rowRanges = specialRanges(numRows);
+	auto colRanges = specialRanges(numCols);
+	auto randomRows = randomRanges(numRows, 15, generator);
+	auto randomCols = randomRanges(numCols, 15, generator);
+	rowRanges.insert(rowRanges.end(), randomRows.begin(), randomRows.end());
+	colRanges.insert(colRanges.end(), randomCols.begin(), randomCols.end());
+	for (uchar label : labels)
+	{
+		for (const auto& rows : rowRanges)
+		{
+			for (const auto& cols : colRanges)
+				EXPECT_EQ(histogram.Count(label, rows, cols), bruteForceCount(image, label, rows, cols))
+					<< "label " << int(label) << ", rows " << rows.start << ".." << rows.end
+					<< ", cols " << cols.start << ".." << cols.end;
+
+			EXPECT_EQ(histogram.Count(label, rows, cv::Range::all()), histogram.Count(label, rows));
+		}
+		EXPECT_EQ(histogram.Count(label, cv::Range::all(), cv::Range::all()), histogram.Count(label));
+	}
+}
+
+TEST(ClassHistogramTest, GetMask)
+{
+	std::mt19937 generator(7);
+	cv::Mat image = randomLabels(generator);
+	ClassHistogram histogram(image);
+	for (uchar label : labels)
+	{
+		cv::Mat mask = histogram.GetMask(label);
+		ASSERT_EQ(mask.rows, numRows);
+		ASSERT_EQ(mask.cols, numCols);
+		for (int y = 0; y < numRows; y++)
+			for (int x = 0; x < numCols; x++)
+				ASSERT_EQ(mask.at<uchar>(y, x), image.at<uchar>(y, x) == label ? 255 : 0)
+					<< "label " << int(label) << ", x " << x << ", y " << y;
+		EXPECT_EQ(cv::countNonZero(mask), histogram.Count(label));
+	}
+}
@@ -0,0 +1,214 @@
+/**
+ * @file test_columnar_results.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "ColumnarResults.h"
+
+#include <gtest/gtest.h>
+#include <magic_enum.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using namespace OFIQ;
+using namespace OFIQ_LIB;
+
+namespace
+{
+	template<typename T>
+	T readAt(const std::vector<char>& file, uint64_t offset)
+	{
+		T value;
+		std::memcpy(&value, file.data() + offset, sizeof(T));
+		return value;
+	}
+
+	// measures are left out of some rows to check the columns of measures not assessed
+	bool isAssessed(size_t row, int measureId)
+	{
+		return (row + static_cast<size_t>(measureId)) % 5 != 0;
+	}
+
+	double rawScoreOf(size_t row, int measureId)
+	{
+		return row * 1000.0 + measureId + 0.25;
+	}
+
+	double scalarOf(size_t row, int measureId)
+	{
+		return static_cast<double>((row + static_cast<size_t>(measureId)) % 101);
+	}
+
+	QualityMeasureReturnCode codeOf(size_t row)
+	{
+		return row % 3 == 0 ? QualityMeasureReturnCode::FailureToAssess : QualityMeasureReturnCode::Success;
+	}
+
+	std::string referenceOf(size_t row)
+	{
+		return "images/image_" + std::string(row % 4, 'x') + std::to_string(row) + ".png";
+	}
+}
+
+TEST(ColumnarResultsTest, RoundTrip)
+{
+	const size_t numRows = 20;
+	const uint32_t rowsPerBlock = 7;
+	const fs::path path = fs::temp_directory_path() / "ofiq_test_columnar_results.bin";
+
+	{
+		ColumnarResultsWriter writer(path.string(), rowsPerBlock);
+		for (size_t row = 0; row < numRows; row++)
+		{
+			FaceImageQualityAssessment assessments;
+			for (int id = 0x41; id <= 0x5c; id++)
+			{
+				if (!isAssessed(row, id))
+					continue;
+				QualityMeasureResult result;
+				result.rawScore = rawScoreOf(row, id);
+				result.scalar = scalarOf(row, id);
+				result.code = codeOf(row);
+				assessments.qAssessments[static_cast<QualityMeasure>(id)] = result;
+			}
+			writer.Add(referenceOf(row), assessments, static_cast<int32_t>(row * 10));
+		}
+		writer.Close();
+	}
+
+	std::ifstream stream(path, std::ios::binary);
+	std::vector<char> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	stream.close();
+	fs::remove(path);
+	ASSERT_GE(file.size(), 64u + 40u);
+
+	// file header and schema
+	ASSERT_EQ(std::memcmp(file.data(), "OFIQCR01", 8), 0);
+	const auto numMeasures = readAt<uint32_t>(file, 8);
+	ASSERT_EQ(numMeasures, 0x5cu - 0x41u + 1);
+	EXPECT_EQ(readAt<uint32_t>(file, 12), rowsPerBlock);
+	for (uint32_t m = 0; m < numMeasures; m++)
+	{
+		const uint64_t entry = 64 + m * 32;
+		const int id = 0x41 + static_cast<int>(m);
+		EXPECT_EQ(readAt<int32_t>(file, entry), id);
+		auto name = magic_enum::enum_name(static_cast<QualityMeasure>(id));
+		EXPECT_EQ(std::string(file.data() + entry + 4), std::string(name.substr(0, 27)));
+	}
+
+	// footer
+	ASSERT_EQ(std::memcmp(file.data() + file.size() - 8, "OFIQCR01", 8), 0);
+	const auto footerOffset = readAt<uint64_t>(file, file.size() - 16);
+	const auto numBlocks = readAt<uint64_t>(file, file.size() - 24);
+	const auto totalRows = readAt<uint64_t>(file, file.size() - 32);
+	EXPECT_EQ(totalRows, numRows);
+	ASSERT_EQ(numBlocks, (numRows + rowsPerBlock - 1) / rowsPerBlock);
+	EXPECT_EQ(footerOffset % 64, 0u);
+	ASSERT_EQ(footerOffset + numBlocks * 8 + 32, file.size());
+
+	// blocks
+	size_t row = 0;
+	for (uint64_t b = 0; b < numBlocks; b++)
+	{
+		const auto blockOffset = readAt<uint64_t>(file, footerOffset + b * 8);
+		EXPECT_EQ(blockOffset % 64, 0u) << "block " << b;
+		const auto blockRows = readAt<uint64_t>(file, blockOffset);
+		const auto numColumns = readAt<uint64_t>(file, blockOffset + 8);
+		ASSERT_EQ(blockRows, std::min<uint64_t>(rowsPerBlock, numRows - row));
+		ASSERT_EQ(numColumns, 3 + 3 * numMeasures);
+
+		std::vector<uint64_t> columns(numColumns);
+		for (uint64_t c = 0; c < numColumns; c++)
+		{
+			columns[c] = blockOffset + readAt<uint64_t>(file, blockOffset + 16 + c * 8);
+			EXPECT_EQ(columns[c] % 64, 0u) << "block " << b << ", column " << c;
+			ASSERT_LT(columns[c], footerOffset);
+		}
+
+		for (uint64_t r = 0; r < blockRows; r++, row++)
+		{
+			const auto begin = r == 0 ? 0 : readAt<uint64_t>(file, columns[0] + (r - 1) * 8);
+			const auto end = readAt<uint64_t>(file, columns[0] + r * 8);
+			EXPECT_EQ(std::string(file.data() + columns[1] + begin, end - begin), referenceOf(row));
+			EXPECT_EQ(readAt<int32_t>(file, columns[2] + r * 4), static_cast<int32_t>(row * 10));
+
+			for (uint32_t m = 0; m < numMeasures; m++)
+			{
+				const int id = 0x41 + static_cast<int>(m);
+				const auto rawScore = readAt<double>(file, columns[3 + 3 * m] + r * 8);
+				const auto scalar = readAt<double>(file, columns[4 + 3 * m] + r * 8);
+				const auto code = readAt<int8_t>(file, columns[5 + 3 * m] + r);
+				if (isAssessed(row, id))
+				{
+					EXPECT_EQ(rawScore, rawScoreOf(row, id));
+					EXPECT_EQ(scalar, scalarOf(row, id));
+					EXPECT_EQ(code, static_cast<int8_t>(codeOf(row)));
+				}
+				else
+				{
+					EXPECT_TRUE(std::isnan(rawScore));
+					EXPECT_TRUE(std::isnan(scalar));
+					EXPECT_EQ(code, -1);
+				}
+			}
+		}
+	}
+	EXPECT_EQ(row, numRows);
+}
+
+TEST(ColumnarResultsTest, EmptyFile)
+{
+	const fs::path path = fs::temp_directory_path() / "ofiq_test_columnar_results_empty.bin";
+	{
+		ColumnarResultsWriter writer(path.string());
+		writer.Close();
+	}
+
+	std::ifstream stream(path, std::ios::binary);
+	std::vector<char> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	stream.close();
+	fs::remove(path);
+
+	ASSERT_GE(file.size(), 32u);
+	EXPECT_EQ(readAt<uint64_t>(file, file.size() - 32), 0u);
+	EXPECT_EQ(readAt<uint64_t>(file, file.size() - 24), 0u);
+	EXPECT_EQ(readAt<uint64_t>(file, file.size() - 16) + 32, file.size());
+}
+
+TEST(ColumnarResultsTest, AddAfterCloseThrows)
+{
+	const fs::path path = fs::temp_directory_path() / "ofiq_test_columnar_results_closed.bin";
+	ColumnarResultsWriter writer(path.string());
+	writer.Close();
+	EXPECT_ANY_THROW(writer.Add("image.png", FaceImageQualityAssessment(), 0));
+	fs::remove(path);
+}
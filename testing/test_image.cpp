@@ -0,0 +1,80 @@
+/**
+ * @file test_image.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include <ofiq_lib.h>
+#include "utils.h"
+
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+
+using namespace OFIQ;
+
+static std::shared_ptr<uint8_t> makePixels(const std::vector<uint8_t>& values)
+{
+	std::shared_ptr<uint8_t> pixels(new uint8_t[values.size()], std::default_delete<uint8_t[]>());
+	std::copy(values.begin(), values.end(), pixels.get());
+	return pixels;
+}
+
+TEST(ImageTest, DeepcopyIntoBorrowedBGRImageResetsPixelFormat)
+{
+	// 2x2 BGR image with a row stride of 8 bytes
+	std::vector<uint8_t> bgrPixels(16, 0);
+	Image image = Image::borrow(2, 2, PixelFormat::BGR, bgrPixels.data(), 8);
+	ASSERT_EQ(image.pixelFormat, PixelFormat::BGR);
+
+	// 2x1 RGB image with a red and a blue pixel
+	auto rgbPixels = makePixels({ 255, 0, 0, 0, 0, 255 });
+	image.deepcopy(2, 1, 24, rgbPixels);
+
+	EXPECT_EQ(image.pixelFormat, PixelFormat::RGB);
+	EXPECT_EQ(image.stride, 0u);
+	EXPECT_EQ(image.rowStride(), 6u);
+	EXPECT_NE(image.data.get(), rgbPixels.get());
+	EXPECT_NE(image.data.get(), bgrPixels.data());
+
+	// the channels must not be swapped by the conversion to OpenCV's BGR order
+	cv::Mat bgrImage = OFIQ_LIB::copyToCvImage(image);
+	ASSERT_EQ(bgrImage.type(), CV_8UC3);
+	EXPECT_EQ(bgrImage.at<cv::Vec3b>(0, 0), cv::Vec3b(0, 0, 255));
+	EXPECT_EQ(bgrImage.at<cv::Vec3b>(0, 1), cv::Vec3b(255, 0, 0));
+}
+
+TEST(ImageTest, DeepcopyOfGrayImage)
+{
+	Image image = Image::borrow(1, 1, PixelFormat::BGR, nullptr);
+	auto grayPixels = makePixels({ 10, 20, 30 });
+	image.deepcopy(3, 1, 8, grayPixels);
+
+	EXPECT_EQ(image.depth, 8);
+	EXPECT_EQ(image.stride, 0u);
+	EXPECT_EQ(image.rowStride(), 3u);
+	cv::Mat grayImage = OFIQ_LIB::copyToCvImage(image, true);
+	ASSERT_EQ(grayImage.type(), CV_8UC1);
+	EXPECT_EQ(grayImage.at<uint8_t>(0, 2), 30);
+}
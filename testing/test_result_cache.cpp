@@ -0,0 +1,317 @@
+/**
+ * @file test_result_cache.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "ResultCache.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using namespace OFIQ;
+using namespace OFIQ_LIB;
+
+namespace
+{
+	FaceImageQualityAssessment makeAssessment(int value, size_t embeddingSize = 0)
+	{
+		FaceImageQualityAssessment assessment;
+		assessment.boundingBox = BoundingBox(
+			static_cast<int16_t>(value), static_cast<int16_t>(value + 1), 100, 120, FaceDetectorType::OPENCVSSD);
+		QualityMeasureResult result;
+		result.rawScore = value + 0.5;
+		result.scalar = value % 101;
+		result.code = QualityMeasureReturnCode::Success;
+		assessment.qAssessments[QualityMeasure::Sharpness] = result;
+		result.code = QualityMeasureReturnCode::FailureToAssess;
+		assessment.qAssessments[QualityMeasure::MouthClosed] = result;
+		for (size_t i = 0; i < embeddingSize; i++)
+			assessment.embedding.push_back(static_cast<float>(value) + static_cast<float>(i) / 8);
+		return assessment;
+	}
+
+	void expectEqual(const FaceImageQualityAssessment& actual, const FaceImageQualityAssessment& expected)
+	{
+		EXPECT_EQ(actual.boundingBox.xleft, expected.boundingBox.xleft);
+		EXPECT_EQ(actual.boundingBox.ytop, expected.boundingBox.ytop);
+		EXPECT_EQ(actual.boundingBox.width, expected.boundingBox.width);
+		EXPECT_EQ(actual.boundingBox.height, expected.boundingBox.height);
+		EXPECT_EQ(actual.boundingBox.faceDetector, expected.boundingBox.faceDetector);
+		ASSERT_EQ(actual.qAssessments.size(), expected.qAssessments.size());
+		for (const auto& [measure, result] : expected.qAssessments)
+		{
+			auto it = actual.qAssessments.find(measure);
+			ASSERT_NE(it, actual.qAssessments.end());
+			EXPECT_EQ(it->second.rawScore, result.rawScore);
+			EXPECT_EQ(it->second.scalar, result.scalar);
+			EXPECT_EQ(it->second.code, result.code);
+		}
+		EXPECT_EQ(actual.embedding, expected.embedding);
+	}
+
+	class ResultCachePersistenceTest : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			directory = fs::temp_directory_path() / "ofiq_test_result_cache";
+			fs::remove_all(directory);
+			fs::create_directories(directory);
+			path = (directory / "cache.bin").string();
+		}
+
+		void TearDown() override
+		{
+			fs::remove_all(directory);
+		}
+
+		size_t countTemporaryFiles() const
+		{
+			size_t count = 0;
+			for (const auto& entry : fs::directory_iterator(directory))
+				count += entry.path().extension() == ".tmp";
+			return count;
+		}
+
+		fs::path directory;
+		std::string path;
+	};
+}
+
+TEST(ResultCacheTest, HashBytesKnownAnswers)
+{
+	EXPECT_EQ(ResultCache::HashBytes("", 0, 0), 0xEF46DB3751D8E999ULL);
+	EXPECT_EQ(ResultCache::HashBytes("a", 1, 0), 0xD24EC4F1A98C6E5BULL);
+	EXPECT_EQ(ResultCache::HashBytes("abc", 3, 0), 0x44BC2CF5AD770999ULL);
+	EXPECT_EQ(ResultCache::HashBytes("xxhash", 6, 0), 0x32DD38952C4BC720ULL);
+	EXPECT_EQ(ResultCache::HashBytes("xxhash", 6, 20141025), 0xB559B98D844E0635ULL);
+
+	// longer than a stripe of 32 bytes
+	const std::string text = "Nobody inspects the spammish repetition";
+	EXPECT_EQ(ResultCache::HashBytes(text.data(), text.size(), 0), 0xFBCEA83C8A378BF1ULL);
+}
+
+TEST(ResultCacheTest, HashImageIgnoresStridePadding)
+{
+	const uint16_t width = 13;
+	const uint16_t height = 7;
+	const size_t rowLength = width * 3;
+	const size_t stride = rowLength + 9;
+
+	std::vector<uint8_t> packed(rowLength * height);
+	std::vector<uint8_t> padded(stride * height, 0xAB);
+	for (size_t y = 0; y < height; y++)
+	{
+		for (size_t x = 0; x < rowLength; x++)
+		{
+			packed[y * rowLength + x] = static_cast<uint8_t>(y * 31 + x);
+			padded[y * stride + x] = static_cast<uint8_t>(y * 31 + x);
+		}
+	}
+
+	auto packedImage = Image::borrow(width, height, PixelFormat::RGB, packed.data());
+	auto paddedImage = Image::borrow(width, height, PixelFormat::RGB, padded.data(), stride);
+	const uint64_t hash = ResultCache::HashImage(packedImage, 42);
+	EXPECT_EQ(ResultCache::HashImage(paddedImage, 42), hash);
+
+	// the hash depends on the seed
+	EXPECT_NE(ResultCache::HashImage(packedImage, 43), hash);
+
+	// the padding does not matter, the pixels and the pixel format do
+	padded[rowLength] = 0x12;
+	EXPECT_EQ(ResultCache::HashImage(paddedImage, 42), hash);
+	padded[stride + 1] ^= 1;
+	EXPECT_NE(ResultCache::HashImage(paddedImage, 42), hash);
+	padded[stride + 1] ^= 1;
+	auto bgrImage = Image::borrow(width, height, PixelFormat::BGR, padded.data(), stride);
+	EXPECT_NE(ResultCache::HashImage(bgrImage, 42), hash);
+}
+
+TEST(ResultCacheTest, LeastRecentlyUsedEviction)
+{
+	ResultCache cache(3, 1);
+	FaceImageQualityAssessment assessment;
+	for (int key = 1; key <= 3; key++)
+		cache.Insert(key, makeAssessment(key));
+
+	// looking up 1 makes 2 the least recently used entry
+	ASSERT_TRUE(cache.Lookup(1, assessment));
+	expectEqual(assessment, makeAssessment(1));
+	cache.Insert(4, makeAssessment(4));
+	EXPECT_FALSE(cache.Lookup(2, assessment));
+	EXPECT_TRUE(cache.Lookup(3, assessment));
+	EXPECT_TRUE(cache.Lookup(1, assessment));
+	EXPECT_TRUE(cache.Lookup(4, assessment));
+
+	// replacing 3 makes it the most recently used entry, 1 is evicted next
+	cache.Insert(3, makeAssessment(30));
+	cache.Insert(5, makeAssessment(5));
+	EXPECT_FALSE(cache.Lookup(1, assessment));
+	ASSERT_TRUE(cache.Lookup(3, assessment));
+	expectEqual(assessment, makeAssessment(30));
+
+	// a failed lookup leaves the assessment unchanged
+	EXPECT_FALSE(cache.Lookup(99, assessment));
+	expectEqual(assessment, makeAssessment(30));
+}
+
+TEST(ResultCacheTest, ZeroCapacity)
+{
+	ResultCache cache(0, 1);
+	cache.Insert(1, makeAssessment(1));
+	FaceImageQualityAssessment assessment;
+	EXPECT_FALSE(cache.Lookup(1, assessment));
+}
+
+TEST_F(ResultCachePersistenceTest, RoundTrip)
+{
+	{
+		ResultCache cache(10, 7, path);
+		for (int key = 1; key <= 4; key++)
+			cache.Insert(key, makeAssessment(key, key == 2 ? 512 : 0));
+	}
+	ASSERT_TRUE(fs::exists(path));
+	EXPECT_EQ(countTemporaryFiles(), 0u);
+
+	ResultCache cache(10, 7, path);
+	for (int key = 1; key <= 4; key++)
+	{
+		FaceImageQualityAssessment assessment;
+		ASSERT_TRUE(cache.Lookup(key, assessment)) << "key " << key;
+		expectEqual(assessment, makeAssessment(key, key == 2 ? 512 : 0));
+	}
+}
+
+TEST_F(ResultCachePersistenceTest, RecencyIsRestored)
+{
+	{
+		ResultCache cache(10, 7, path);
+		for (int key = 1; key <= 4; key++)
+			cache.Insert(key, makeAssessment(key));
+		FaceImageQualityAssessment assessment;
+		cache.Lookup(1, assessment);
+	}
+
+	// loaded into a smaller cache, the least recently used entries 2 and 3 are evicted
+	ResultCache cache(2, 7, path);
+	FaceImageQualityAssessment assessment;
+	EXPECT_TRUE(cache.Lookup(1, assessment));
+	EXPECT_TRUE(cache.Lookup(4, assessment));
+	EXPECT_FALSE(cache.Lookup(2, assessment));
+	EXPECT_FALSE(cache.Lookup(3, assessment));
+}
+
+TEST_F(ResultCachePersistenceTest, FingerprintMismatchIsIgnored)
+{
+	{
+		ResultCache cache(10, 7, path);
+		cache.Insert(1, makeAssessment(1));
+	}
+
+	FaceImageQualityAssessment assessment;
+	{
+		ResultCache cache(10, 8, path);
+		EXPECT_FALSE(cache.Lookup(1, assessment));
+	}
+	// the cache of the other configuration has replaced the file
+	ResultCache cache(10, 7, path);
+	EXPECT_FALSE(cache.Lookup(1, assessment));
+}
+
+TEST_F(ResultCachePersistenceTest, CorruptFileIsIgnored)
+{
+	{
+		ResultCache cache(10, 7, path);
+		for (int key = 1; key <= 3; key++)
+			cache.Insert(key, makeAssessment(key, 4));
+	}
+	// truncating the file keeps the entries before the first incomplete one
+	fs::resize_file(path, fs::file_size(path) - 3);
+	ResultCache cache(10, 7, path);
+	FaceImageQualityAssessment assessment;
+	EXPECT_TRUE(cache.Lookup(1, assessment));
+	EXPECT_TRUE(cache.Lookup(2, assessment));
+	EXPECT_FALSE(cache.Lookup(3, assessment));
+}
+
+TEST_F(ResultCachePersistenceTest, CachesSharingTheFileAreMerged)
+{
+	{
+		ResultCache first(10, 7, path);
+		ResultCache second(10, 7, path);
+		first.Insert(1, makeAssessment(1));
+		first.Insert(2, makeAssessment(2));
+		second.Insert(2, makeAssessment(20));
+		second.Insert(3, makeAssessment(3));
+		first.Save();
+		// second is destroyed first and saves its entries, first saves its entries on top of them
+	}
+
+	ResultCache cache(10, 7, path);
+	FaceImageQualityAssessment assessment;
+	ASSERT_TRUE(cache.Lookup(1, assessment));
+	ASSERT_TRUE(cache.Lookup(3, assessment));
+	ASSERT_TRUE(cache.Lookup(2, assessment));
+	expectEqual(assessment, makeAssessment(2));
+	EXPECT_EQ(countTemporaryFiles(), 0u);
+}
+
+TEST_F(ResultCachePersistenceTest, ConcurrentSaves)
+{
+	const int numCaches = 4;
+	const int entriesPerCache = 50;
+	std::vector<std::thread> threads;
+	for (int c = 0; c < numCaches; c++)
+	{
+		threads.emplace_back([this, c]()
+			{
+				ResultCache cache(numCaches * entriesPerCache, 7, path);
+				for (int i = 0; i < entriesPerCache; i++)
+				{
+					const int key = c * entriesPerCache + i;
+					cache.Insert(key, makeAssessment(key, 16));
+					if (i % 10 == 0)
+						cache.Save();
+				}
+			});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	ResultCache cache(numCaches * entriesPerCache, 7, path);
+	for (int key = 0; key < numCaches * entriesPerCache; key++)
+	{
+		FaceImageQualityAssessment assessment;
+		ASSERT_TRUE(cache.Lookup(key, assessment)) << "key " << key;
+		expectEqual(assessment, makeAssessment(key, 16));
+	}
+	EXPECT_EQ(countTemporaryFiles(), 0u);
+}
@@ -0,0 +1,322 @@
+/**
+ * @file test_session_serialization.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "Session.h"
+#include "OFIQError.h"
+
+#include <gtest/gtest.h>
+#include <opencv2/core.hpp>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace OFIQ;
+using namespace OFIQ_LIB;
+
+namespace
+{
+	// layout of serialized sessions: 64 byte header with the number of sections at offset 8,
+	// followed by section entries of 24 bytes (id, reserved, offset, size)
+	const size_t headerSize = 64;
+	const size_t sectionEntrySize = 24;
+	const uint32_t detectedFacesId = 2;
+	const uint32_t landmarksId = 4;
+	const uint32_t transformationMatrixId = 6;
+	const uint32_t faceParsingImageId = 7;
+
+	Image makeImage(uint16_t width, uint16_t height)
+	{
+		const size_t size = static_cast<size_t>(width) * height * 3;
+		std::shared_ptr<uint8_t> data(new uint8_t[size](), std::default_delete<uint8_t[]>());
+		return Image(width, height, 24, data);
+	}
+
+	FaceLandmarks makeLandmarks(int16_t offset)
+	{
+		FaceLandmarks landmarks;
+		landmarks.type = LandmarkType::LM_98;
+		for (int16_t i = 0; i < 98; i++)
+		{
+			LandmarkPoint point;
+			point.x = static_cast<int16_t>(offset + 3 * i);
+			point.y = static_cast<int16_t>(offset - i);
+			landmarks.landmarks.push_back(point);
+		}
+		return landmarks;
+	}
+
+	cv::Mat randomMat(int rows, int cols, int type, int maxValue)
+	{
+		cv::Mat mat(rows, cols, type);
+		cv::randu(mat, cv::Scalar::all(0), cv::Scalar::all(maxValue));
+		return mat;
+	}
+
+	bool equalMats(const cv::Mat& a, const cv::Mat& b)
+	{
+		return a.size() == b.size() && a.type() == b.type() && (a.empty() || cv::norm(a, b, cv::NORM_INF) == 0);
+	}
+
+	void expectEqualLandmarks(const FaceLandmarks& actual, const FaceLandmarks& expected)
+	{
+		EXPECT_EQ(actual.type, expected.type);
+		ASSERT_EQ(actual.landmarks.size(), expected.landmarks.size());
+		for (size_t i = 0; i < expected.landmarks.size(); i++)
+		{
+			EXPECT_EQ(actual.landmarks[i].x, expected.landmarks[i].x);
+			EXPECT_EQ(actual.landmarks[i].y, expected.landmarks[i].y);
+		}
+	}
+
+	class SessionSerializationTest : public ::testing::Test
+	{
+	protected:
+		SessionSerializationTest()
+			: image(makeImage(640, 480)),
+			  session(image, assessment)
+		{
+			session.setDetectedFaces({
+				BoundingBox(120, 80, 300, 320, FaceDetectorType::OPENCVSSD),
+				BoundingBox(-10, 5, 40, 44, FaceDetectorType::OPENCVSSD) });
+			session.setPose({ 1.5, -2.25, 30.125 });
+			session.setLandmarks(makeLandmarks(100));
+			session.setAlignedFaceLandmarks(makeLandmarks(200));
+			cv::Mat transformationMatrix = (cv::Mat_<double>(2, 3) << 0.5, -0.125, 10.25, 0.125, 0.5, -3.75);
+			session.setAlignedFaceTransformationMatrix(transformationMatrix);
+			session.setAlignedFace(randomMat(616, 616, CV_8UC3, 256));
+			session.setFaceParsingImage(randomMat(400, 400, CV_8UC1, 19));
+			session.setFaceOcclusionSegmentationImage(randomMat(616, 616, CV_8UC1, 2));
+			session.setAlignedFaceLandmarkedRegion(randomMat(616, 616, CV_8UC1, 2));
+		}
+
+		void expectRestored(const Session& restored, bool withAlignedFace) const
+		{
+			auto faces = restored.getDetectedFaces();
+			auto expectedFaces = session.getDetectedFaces();
+			ASSERT_EQ(faces.size(), expectedFaces.size());
+			for (size_t i = 0; i < faces.size(); i++)
+			{
+				EXPECT_EQ(faces[i].xleft, expectedFaces[i].xleft);
+				EXPECT_EQ(faces[i].ytop, expectedFaces[i].ytop);
+				EXPECT_EQ(faces[i].width, expectedFaces[i].width);
+				EXPECT_EQ(faces[i].height, expectedFaces[i].height);
+				EXPECT_EQ(faces[i].faceDetector, expectedFaces[i].faceDetector);
+			}
+			EXPECT_EQ(restored.getPose(), session.getPose());
+			expectEqualLandmarks(restored.getLandmarks(), session.getLandmarks());
+			expectEqualLandmarks(restored.getAlignedFaceLandmarks(), session.getAlignedFaceLandmarks());
+			EXPECT_TRUE(equalMats(restored.getAlignedFaceTransformationMatrix(), session.getAlignedFaceTransformationMatrix()));
+			EXPECT_TRUE(equalMats(restored.getFaceParsingImage(), session.getFaceParsingImage()));
+			EXPECT_TRUE(equalMats(restored.getFaceOcclusionSegmentationImage(), session.getFaceOcclusionSegmentationImage()));
+			EXPECT_TRUE(equalMats(restored.getAlignedFaceLandmarkedRegion(), session.getAlignedFaceLandmarkedRegion()));
+			EXPECT_EQ(restored.hasAlignedFace(), withAlignedFace);
+			if (withAlignedFace)
+				EXPECT_TRUE(equalMats(restored.getAlignedFaceNative(), session.getAlignedFaceNative()));
+		}
+
+		// offset of the section with the given id, 0 if there is none
+		static uint64_t sectionOffset(const std::vector<uint8_t>& data, uint32_t id)
+		{
+			uint32_t numSections;
+			std::memcpy(&numSections, data.data() + 8, sizeof(numSections));
+			for (uint32_t i = 0; i < numSections; i++)
+			{
+				const uint8_t* entry = data.data() + headerSize + i * sectionEntrySize;
+				uint32_t sectionId;
+				uint64_t offset;
+				std::memcpy(&sectionId, entry, sizeof(sectionId));
+				std::memcpy(&offset, entry + 8, sizeof(offset));
+				if (sectionId == id)
+					return offset;
+			}
+			return 0;
+		}
+
+		template<typename T>
+		static void patch(std::vector<uint8_t>& data, size_t offset, T value)
+		{
+			std::memcpy(data.data() + offset, &value, sizeof(T));
+		}
+
+		Image image;
+		FaceImageQualityAssessment assessment;
+		Session session;
+	};
+}
+
+TEST_F(SessionSerializationTest, RoundTripWithCopy)
+{
+	auto data = session.serialize("images/face.png", true);
+	EXPECT_EQ(Session::readImageReference(data.data(), data.size()), "images/face.png");
+
+	FaceImageQualityAssessment restoredAssessment;
+	Session restored(image, restoredAssessment);
+	restored.deserialize(data.data(), data.size(), true);
+	expectRestored(restored, true);
+	EXPECT_EQ(restoredAssessment.boundingBox.xleft, 120);
+	EXPECT_EQ(restoredAssessment.boundingBox.ytop, 80);
+
+	// the copied matrices do not refer to the serialized data
+	auto matrix = restored.getAlignedFaceTransformationMatrix();
+	EXPECT_TRUE(matrix.data < data.data() || matrix.data >= data.data() + data.size());
+	std::fill(data.begin(), data.end(), static_cast<uint8_t>(0));
+	expectRestored(restored, true);
+}
+
+TEST_F(SessionSerializationTest, RoundTripWithoutCopy)
+{
+	auto data = session.serialize("", false);
+	EXPECT_EQ(Session::readImageReference(data.data(), data.size()), "");
+
+	FaceImageQualityAssessment restoredAssessment;
+	Session restored(image, restoredAssessment);
+	restored.deserialize(data.data(), data.size(), false);
+	expectRestored(restored, false);
+
+	// the matrices refer to the serialized data, their pixels are aligned to 64 bytes within it
+	auto matrix = restored.getAlignedFaceTransformationMatrix();
+	ASSERT_TRUE(matrix.data >= data.data() && matrix.data < data.data() + data.size());
+	EXPECT_EQ((matrix.data - data.data()) % 64, 0);
+	EXPECT_EQ(matrix.at<double>(0, 2), 10.25);
+}
+
+TEST_F(SessionSerializationTest, ImageSizeMismatchIsRejected)
+{
+	auto data = session.serialize();
+	auto otherImage = makeImage(320, 240);
+	FaceImageQualityAssessment otherAssessment;
+	Session other(otherImage, otherAssessment);
+	EXPECT_THROW(other.deserialize(data.data(), data.size()), OFIQError);
+}
+
+TEST_F(SessionSerializationTest, InvalidDataAreRejected)
+{
+	const auto valid = session.serialize("images/face.png", true);
+	const uint64_t facesOffset = sectionOffset(valid, detectedFacesId);
+	const uint64_t landmarksOffset = sectionOffset(valid, landmarksId);
+	const uint64_t matrixOffset = sectionOffset(valid, transformationMatrixId);
+	const uint64_t parsingOffset = sectionOffset(valid, faceParsingImageId);
+	ASSERT_NE(facesOffset, 0u);
+	ASSERT_NE(landmarksOffset, 0u);
+	ASSERT_NE(matrixOffset, 0u);
+	ASSERT_NE(parsingOffset, 0u);
+
+	FaceImageQualityAssessment restoredAssessment;
+	Session restored(image, restoredAssessment);
+	auto expectRejected = [&restored](const std::vector<uint8_t>& data, const std::string& description)
+		{
+			EXPECT_THROW(restored.deserialize(data.data(), data.size()), OFIQError) << description;
+		};
+
+	EXPECT_THROW(restored.deserialize(nullptr, 0), OFIQError);
+	expectRejected(std::vector<uint8_t>(valid.begin(), valid.begin() + 63), "truncated header");
+	expectRejected(std::vector<uint8_t>(valid.begin(), valid.begin() + valid.size() / 2), "truncated sections");
+	expectRejected(std::vector<uint8_t>(valid.begin(), valid.end() - 1), "truncated last section");
+
+	auto data = valid;
+	data[0] ^= 1;
+	expectRejected(data, "bad magic");
+
+	data = valid;
+	patch<uint32_t>(data, 4, 2);
+	expectRejected(data, "unknown version");
+
+	data = valid;
+	patch<uint32_t>(data, 8, 0x10000000);
+	expectRejected(data, "more sections than the data hold");
+
+	data = valid;
+	patch<uint64_t>(data, headerSize + 8, valid.size() + 64);
+	expectRejected(data, "section offset beyond the data");
+
+	data = valid;
+	patch<uint64_t>(data, headerSize + 8, ~0ULL & ~63ULL);
+	expectRejected(data, "huge section offset");
+
+	data = valid;
+	patch<uint64_t>(data, headerSize + 16, ~0ULL);
+	expectRejected(data, "huge section size");
+
+	data = valid;
+	patch<uint64_t>(data, headerSize + 8, sectionOffset(valid, 1) + 1);
+	expectRejected(data, "misaligned section offset");
+
+	data = valid;
+	patch<uint32_t>(data, facesOffset, 0xFFFFFFFF);
+	expectRejected(data, "oversized number of faces");
+
+	data = valid;
+	patch<uint32_t>(data, landmarksOffset + 4, 0xFFFFFFFF);
+	expectRejected(data, "oversized number of landmarks");
+
+	data = valid;
+	patch<uint32_t>(data, landmarksOffset + 4, 99);
+	expectRejected(data, "one landmark more than the section holds");
+
+	// matrix header: rows, cols, type, reserved (int32 each) and the row size (uint64)
+	data = valid;
+	patch<int32_t>(data, parsingOffset, 1 << 30);
+	expectRejected(data, "oversized number of rows");
+
+	data = valid;
+	patch<int32_t>(data, parsingOffset, 1 << 30);
+	patch<int32_t>(data, parsingOffset + 4, 1 << 29);
+	patch<int32_t>(data, parsingOffset + 8, CV_64FC4);
+	patch<uint64_t>(data, parsingOffset + 16, 1ULL << 34);
+	expectRejected(data, "number of bytes wrapping around");
+
+	data = valid;
+	patch<int32_t>(data, parsingOffset, -1);
+	expectRejected(data, "negative number of rows");
+
+	data = valid;
+	patch<uint64_t>(data, parsingOffset + 16, 401);
+	expectRejected(data, "row size not matching the columns");
+
+	data = valid;
+	patch<int32_t>(data, parsingOffset + 8, CV_16UC1);
+	patch<uint64_t>(data, parsingOffset + 16, 800);
+	expectRejected(data, "face parsing image of another type");
+
+	data = valid;
+	patch<int32_t>(data, matrixOffset + 8, CV_8UC1);
+	patch<uint64_t>(data, matrixOffset + 16, 3);
+	expectRejected(data, "transformation matrix of another type");
+
+	data = valid;
+	patch<int32_t>(data, matrixOffset, 1);
+	expectRejected(data, "transformation matrix of another size");
+
+	// invalid data leave the session unchanged
+	EXPECT_TRUE(restored.getDetectedFaces().empty());
+	EXPECT_TRUE(restored.getLandmarks().landmarks.empty());
+	EXPECT_TRUE(restored.getAlignedFaceTransformationMatrix().empty());
+
+	ASSERT_NO_THROW(restored.deserialize(valid.data(), valid.size()));
+	expectRestored(restored, true);
+}
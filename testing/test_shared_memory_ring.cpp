@@ -0,0 +1,227 @@
+/**
+ * @file test_shared_memory_ring.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "SharedMemoryRing.h"
+#include "OFIQError.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+
+using namespace OFIQ_LIB;
+
+static std::string uniqueRingName(const std::string& suffix)
+{
+	return "/ofiq_test_" + std::to_string(getpid()) + "_" + suffix;
+}
+
+static void writeValue(uint8_t* slot, uint64_t value)
+{
+	std::memcpy(slot, &value, sizeof(value));
+}
+
+static uint64_t readValue(const uint8_t* slot)
+{
+	uint64_t value;
+	std::memcpy(&value, slot, sizeof(value));
+	return value;
+}
+
+TEST(SharedMemoryRingTest, SlotSizeIsAligned)
+{
+	auto ring = SharedMemoryRing::Create(uniqueRingName("aligned"), 3, 100);
+	EXPECT_EQ(ring->GetSlotCount(), 3u);
+	EXPECT_EQ(ring->GetSlotSize(), 128u);
+
+	auto slot = ring->TryAcquireWrite();
+	ASSERT_NE(slot, nullptr);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(slot) % 64, 0u);
+}
+
+TEST(SharedMemoryRingTest, InvalidSizesAreRejected)
+{
+	EXPECT_THROW(SharedMemoryRing::Create(uniqueRingName("invalid"), 0, 64), OFIQError);
+	EXPECT_THROW(SharedMemoryRing::Create(uniqueRingName("invalid"), 4, 0), OFIQError);
+	EXPECT_THROW(SharedMemoryRing::Open(uniqueRingName("missing")), OFIQError);
+}
+
+TEST(SharedMemoryRingTest, EmptyRingHasNothingToRead)
+{
+	auto ring = SharedMemoryRing::Create(uniqueRingName("empty"), 4, 64);
+	EXPECT_EQ(ring->TryAcquireRead(), nullptr);
+
+	// an acquired but not yet committed slot is not visible to the consumer
+	ASSERT_NE(ring->TryAcquireWrite(), nullptr);
+	EXPECT_EQ(ring->TryAcquireRead(), nullptr);
+
+	ring->CommitWrite();
+	EXPECT_NE(ring->TryAcquireRead(), nullptr);
+	ring->ReleaseRead();
+	EXPECT_EQ(ring->TryAcquireRead(), nullptr);
+}
+
+TEST(SharedMemoryRingTest, FullRingRejectsWrites)
+{
+	const uint32_t slotCount = 4;
+	auto ring = SharedMemoryRing::Create(uniqueRingName("full"), slotCount, 64);
+	for (uint32_t i = 0; i < slotCount; i++)
+	{
+		auto slot = ring->TryAcquireWrite();
+		ASSERT_NE(slot, nullptr) << "slot " << i;
+		writeValue(slot, i);
+		ring->CommitWrite();
+	}
+	EXPECT_EQ(ring->TryAcquireWrite(), nullptr);
+
+	// reading alone does not free a slot, releasing it does
+	auto slot = ring->TryAcquireRead();
+	ASSERT_NE(slot, nullptr);
+	EXPECT_EQ(readValue(slot), 0u);
+	EXPECT_EQ(ring->TryAcquireWrite(), nullptr);
+	ring->ReleaseRead();
+	EXPECT_NE(ring->TryAcquireWrite(), nullptr);
+}
+
+TEST(SharedMemoryRingTest, WrapAroundKeepsOrder)
+{
+	const uint32_t slotCount = 3;
+	auto ring = SharedMemoryRing::Create(uniqueRingName("wrap"), slotCount, 64);
+
+	std::vector<const uint8_t*> slots;
+	uint64_t nextWrite = 0;
+	uint64_t nextRead = 0;
+	// alternate between filling the ring and draining it partially, such that the
+	// indices pass the end of the ring at different fill levels
+	for (uint32_t round = 0; round < 20; round++)
+	{
+		while (auto slot = ring->TryAcquireWrite())
+		{
+			writeValue(slot, nextWrite++);
+			ring->CommitWrite();
+		}
+		for (uint32_t i = 0; i <= round % slotCount; i++)
+		{
+			auto slot = ring->TryAcquireRead();
+			ASSERT_NE(slot, nullptr);
+			EXPECT_EQ(readValue(slot), nextRead++);
+			if (slots.size() < slotCount)
+				slots.push_back(slot);
+			ring->ReleaseRead();
+		}
+	}
+	EXPECT_GT(nextWrite, 5u * slotCount);
+
+	while (auto slot = ring->TryAcquireRead())
+	{
+		EXPECT_EQ(readValue(slot), nextRead++);
+		ring->ReleaseRead();
+	}
+	EXPECT_EQ(nextRead, nextWrite);
+
+	// the slots are reused cyclically
+	ASSERT_EQ(slots.size(), slotCount);
+	EXPECT_NE(slots[0], slots[1]);
+	EXPECT_NE(slots[1], slots[2]);
+	EXPECT_EQ(slots[1] - slots[0], static_cast<ptrdiff_t>(ring->GetSlotSize()));
+}
+
+TEST(SharedMemoryRingTest, ProducerAndConsumerThreads)
+{
+	const std::string name = uniqueRingName("threads");
+	const uint64_t numItems = 100000;
+	auto consumerRing = SharedMemoryRing::Create(name, 8, 64);
+	auto producerRing = SharedMemoryRing::Open(name);
+	EXPECT_EQ(producerRing->GetSlotCount(), 8u);
+
+	std::thread producer([&producerRing, numItems]
+		{
+			for (uint64_t i = 0; i < numItems; i++)
+			{
+				uint8_t* slot;
+				while ((slot = producerRing->TryAcquireWrite()) == nullptr)
+					std::this_thread::yield();
+				writeValue(slot, i);
+				std::memset(slot + sizeof(uint64_t), static_cast<int>(i & 0xff), 56);
+				producerRing->CommitWrite();
+			}
+			producerRing->Close();
+		});
+
+	uint64_t expected = 0;
+	bool orderKept = true;
+	while (true)
+	{
+		const uint8_t* slot = consumerRing->TryAcquireRead();
+		if (slot == nullptr)
+		{
+			// the ring is closed after the last commit, check for remaining slots once more
+			if (consumerRing->IsClosed() && consumerRing->TryAcquireRead() == nullptr)
+				break;
+			std::this_thread::yield();
+			continue;
+		}
+		uint64_t value = readValue(slot);
+		orderKept = orderKept && value == expected &&
+			slot[sizeof(uint64_t)] == static_cast<uint8_t>(expected & 0xff) &&
+			slot[63] == static_cast<uint8_t>(expected & 0xff);
+		expected++;
+		consumerRing->ReleaseRead();
+	}
+	producer.join();
+
+	EXPECT_TRUE(orderKept);
+	EXPECT_EQ(expected, numItems);
+}
+
+TEST(SharedMemoryRingTest, WrapFrameWithStride)
+{
+	std::vector<uint8_t> slot(SharedMemoryFrame::pixelOffset + 2 * 16, 0);
+	SharedMemoryFrame frame{};
+	frame.sequence = 42;
+	frame.width = 4;
+	frame.height = 2;
+	frame.pixelFormat = static_cast<uint32_t>(OFIQ::PixelFormat::BGR);
+	frame.stride = 16;
+	std::memcpy(slot.data(), &frame, sizeof(frame));
+
+	uint64_t sequence = 0;
+	auto image = wrapSharedMemoryFrame(slot.data(), slot.size(), sequence);
+	EXPECT_EQ(sequence, 42u);
+	EXPECT_EQ(image.depth, 24);
+	EXPECT_EQ(image.pixelFormat, OFIQ::PixelFormat::BGR);
+	EXPECT_EQ(image.rowStride(), 16u);
+	EXPECT_EQ(image.data.get(), slot.data() + SharedMemoryFrame::pixelOffset);
+
+	// the last row does not fit into a smaller slot
+	EXPECT_THROW(wrapSharedMemoryFrame(slot.data(), slot.size() - 5, sequence), OFIQError);
+}
+#endif
@@ -0,0 +1,188 @@
+/**
+ * @file test_sharpness.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "Sharpness.h"
+
+#include <gtest/gtest.h>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+using OFIQ_LIB::modules::measures::Sharpness;
+
+namespace
+{
+	/**
+	 * Tolerance of the fused features relative to the magnitude of the reference feature, at least 1.
+	 * The means are exact, the standard deviations differ by the rounding of the sums of squares.
+	 */
+	const double featureTolerance = 1e-8;
+
+	// the feature computation before the fused single pass implementation
+	cv::Mat referenceFocusFeatures(const cv::Mat& image, const cv::Mat& mask, bool applyBlur)
+	{
+		cv::Mat features;
+		cv::Mat grayImage = image.clone();
+		if (image.channels() == 3)
+			cv::cvtColor(grayImage, grayImage, cv::COLOR_BGR2GRAY);
+		cv::Mat grayBlur3 = grayImage.clone();
+		if (applyBlur)
+			cv::GaussianBlur(grayBlur3, grayBlur3, cv::Size(3, 3), 0);
+
+		const int kernelSizes[] = { 1, 3, 5, 7, 9 };
+		for (int k : kernelSizes)
+		{
+			cv::Mat laplacian;
+			cv::Mat mean;
+			cv::Mat stddev;
+			cv::Laplacian(grayBlur3, laplacian, CV_64F, k);
+			cv::Mat abs = cv::abs(laplacian);
+			cv::meanStdDev(abs, mean, stddev, mask);
+			features.push_back(mean.reshape(1));
+			features.push_back(stddev.reshape(1));
+		}
+		for (int k : { 3, 5, 7 })
+		{
+			cv::Mat grayMeanBlur;
+			cv::Mat absdiff;
+			cv::Mat mean;
+			cv::Mat stddev;
+			cv::blur(grayImage, grayMeanBlur, cv::Size(k, k));
+			cv::absdiff(grayImage, grayMeanBlur, absdiff);
+			cv::meanStdDev(absdiff, mean, stddev, mask);
+			features.push_back(mean.reshape(1));
+			features.push_back(stddev.reshape(1));
+		}
+		for (int k : kernelSizes)
+		{
+			cv::Mat sobel;
+			cv::Mat mean;
+			cv::Mat stddev;
+			cv::Sobel(grayImage, sobel, CV_64F, 1, 1, k);
+			cv::Mat abs = cv::abs(sobel);
+			cv::meanStdDev(abs, mean, stddev, mask);
+			features.push_back(mean.reshape(1));
+			features.push_back(stddev.reshape(1));
+		}
+		cv::transpose(features, features);
+		return features;
+	}
+
+	// a face-like crop: smooth shading with edges and noise
+	cv::Mat faceLikeImage(int rows, int cols, int type, cv::RNG& rng)
+	{
+		cv::Mat image(rows, cols, type);
+		rng.fill(image, cv::RNG::UNIFORM, 0, 256);
+		cv::GaussianBlur(image, image, cv::Size(0, 0), 2.5);
+		cv::ellipse(image, cv::Point(cols / 2, rows / 2), cv::Size(cols / 3, rows / 4), 10, 0, 360,
+			cv::Scalar::all(220), 3);
+		cv::rectangle(image, cv::Rect(cols / 4, rows / 5, cols / 6, rows / 12), cv::Scalar::all(30), cv::FILLED);
+		cv::Mat noise(rows, cols, CV_MAKETYPE(CV_16S, image.channels()));
+		rng.fill(noise, cv::RNG::NORMAL, 0, 6);
+		cv::add(image, noise, image, cv::noArray(), type);
+		return image;
+	}
+
+	cv::Mat ellipseMask(int rows, int cols)
+	{
+		cv::Mat mask = cv::Mat::zeros(rows, cols, CV_8UC1);
+		cv::ellipse(mask, cv::Point(cols / 2, rows / 2), cv::Size(cols * 2 / 5, rows / 2), 0, 0, 360,
+			cv::Scalar(255), cv::FILLED);
+		return mask;
+	}
+
+	void expectFeaturesMatch(const cv::Mat& image, const cv::Mat& mask, bool applyBlur, const std::string& description)
+	{
+		cv::Mat reference = referenceFocusFeatures(image, mask, applyBlur);
+		cv::Mat features = Sharpness::GetClassifierFocusFeatures(image, mask, applyBlur);
+		ASSERT_EQ(reference.rows, 1);
+		ASSERT_EQ(reference.cols, 26);
+		ASSERT_EQ(features.rows, 1);
+		ASSERT_EQ(features.cols, 26);
+		ASSERT_EQ(features.type(), CV_64F);
+		for (int i = 0; i < 26; i++)
+		{
+			const double expected = reference.at<double>(0, i);
+			EXPECT_NEAR(features.at<double>(0, i), expected, featureTolerance * std::max(1.0, std::abs(expected)))
+				<< description << ", feature " << i;
+		}
+	}
+}
+
+TEST(SharpnessTest, FocusFeaturesOfRandomImages)
+{
+	// sizes above the largest kernel, odd and even
+	cv::RNG rng(1701);
+	for (const auto& size : { cv::Size(17, 19), cv::Size(24, 16), cv::Size(33, 65), cv::Size(64, 31) })
+	{
+		cv::Mat image(size, CV_8UC1);
+		rng.fill(image, cv::RNG::UNIFORM, 0, 256);
+		cv::Mat mask(size, CV_8UC1);
+		rng.fill(mask, cv::RNG::UNIFORM, 0, 2);
+		const std::string description = std::to_string(size.width) + "x" + std::to_string(size.height);
+		expectFeaturesMatch(image, mask, true, description + " random mask");
+		expectFeaturesMatch(image, mask, false, description + " random mask without blur");
+		expectFeaturesMatch(image, cv::Mat(size, CV_8UC1, cv::Scalar(255)), true, description + " full mask");
+	}
+}
+
+TEST(SharpnessTest, FocusFeaturesOfFaceSizedCrops)
+{
+	cv::RNG rng(42);
+	// crops of the face region of the aligned face and of input images of different resolutions
+	for (const auto& size : { cv::Size(281, 347), cv::Size(420, 512), cv::Size(167, 203) })
+	{
+		const std::string description = std::to_string(size.width) + "x" + std::to_string(size.height);
+		cv::Mat mask = ellipseMask(size.height, size.width);
+		expectFeaturesMatch(faceLikeImage(size.height, size.width, CV_8UC1, rng), mask, true, description + " gray");
+		expectFeaturesMatch(faceLikeImage(size.height, size.width, CV_8UC3, rng), mask, true, description + " BGR");
+	}
+}
+
+TEST(SharpnessTest, FocusFeaturesOfSaturatedImages)
+{
+	// maximal filter responses at the edges of black and white regions
+	cv::Mat image = cv::Mat::zeros(96, 80, CV_8UC1);
+	for (int y = 0; y < image.rows; y++)
+		for (int x = 0; x < image.cols; x++)
+			image.at<uchar>(y, x) = ((x / 3 + y / 2) % 2) ? 255 : 0;
+	expectFeaturesMatch(image, ellipseMask(image.rows, image.cols), true, "checkerboard");
+	expectFeaturesMatch(image, ellipseMask(image.rows, image.cols), false, "checkerboard without blur");
+}
+
+TEST(SharpnessTest, FocusFeaturesOfEmptyMask)
+{
+	cv::Mat image(40, 30, CV_8UC1);
+	cv::RNG rng(3);
+	rng.fill(image, cv::RNG::UNIFORM, 0, 256);
+	cv::Mat features = Sharpness::GetClassifierFocusFeatures(image, cv::Mat::zeros(40, 30, CV_8UC1), true);
+	ASSERT_EQ(features.cols, 26);
+	for (int i = 0; i < 26; i++)
+		EXPECT_EQ(features.at<double>(0, i), 0.0) << "feature " << i;
+}
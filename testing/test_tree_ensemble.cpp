@@ -0,0 +1,193 @@
+/**
+ * @file test_tree_ensemble.cpp
+ *
+ * @copyright Copyright (c) 2024  Federal Office for Information Security, Germany
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author OFIQ development team
+ */
+
+#include "TreeEnsemble.h"
+#include "OFIQError.h"
+
+#include <gtest/gtest.h>
+#include <opencv2/core.hpp>
+#include <opencv2/ml.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <regex>
+#include <string>
+
+using namespace OFIQ_LIB;
+
+namespace
+{
+	cv::Mat randomSamples(int numSamples, int numVars, unsigned seed)
+	{
+		cv::Mat samples(numSamples, numVars, CV_32F);
+		cv::RNG rng(seed);
+		rng.fill(samples, cv::RNG::UNIFORM, -1.0, 1.0);
+		return samples;
+	}
+
+	cv::Mat regressionResponses(const cv::Mat& samples)
+	{
+		cv::Mat responses(samples.rows, 1, CV_32F);
+		for (int i = 0; i < samples.rows; i++)
+		{
+			const float* x = samples.ptr<float>(i);
+			responses.at<float>(i) = x[0] * x[1] + std::sin(3 * x[2]) - (x[3] > 0.2f ? 0.5f : 0.0f);
+		}
+		return responses;
+	}
+
+	cv::Mat classResponses(const cv::Mat& samples)
+	{
+		cv::Mat responses(samples.rows, 1, CV_32S);
+		for (int i = 0; i < samples.rows; i++)
+		{
+			const float* x = samples.ptr<float>(i);
+			responses.at<int>(i) = x[0] + x[1] * x[2] > 0.1f ? 1 : 0;
+		}
+		return responses;
+	}
+
+	cv::Ptr<cv::ml::RTrees> trainRTrees(const cv::Mat& samples, int numTrees, int maxDepth)
+	{
+		auto model = cv::ml::RTrees::create();
+		model->setMaxDepth(maxDepth);
+		model->setMinSampleCount(2);
+		model->setTermCriteria(cv::TermCriteria(cv::TermCriteria::MAX_ITER, numTrees, 0));
+		model->train(samples, cv::ml::ROW_SAMPLE, regressionResponses(samples));
+		return model;
+	}
+
+	cv::Ptr<cv::ml::Boost> trainBoost(const cv::Mat& samples, int numTrees)
+	{
+		auto model = cv::ml::Boost::create();
+		model->setWeakCount(numTrees);
+		model->setMaxDepth(3);
+		model->train(samples, cv::ml::ROW_SAMPLE, classResponses(samples));
+		return model;
+	}
+
+	size_t countMismatches(const cv::ml::DTrees& model, const TreeEnsemble& ensemble, const cv::Mat& samples)
+	{
+		size_t mismatches = 0;
+		cv::Mat result;
+		for (int i = 0; i < samples.rows; i++)
+		{
+			model.predict(samples.row(i), result, cv::ml::DTrees::PREDICT_SUM);
+			if (result.at<float>(0, 0) != ensemble.PredictSum(samples.ptr<float>(i)))
+				mismatches++;
+		}
+		return mismatches;
+	}
+}
+
+TEST(TreeEnsembleTest, RTreesPredictSum)
+{
+	auto model = trainRTrees(randomSamples(500, 6, 1), 20, 6);
+	ASSERT_TRUE(TreeEnsemble::IsSupported(*model));
+	TreeEnsemble ensemble(*model);
+	EXPECT_EQ(ensemble.GetNumTrees(), model->getRoots().size());
+	EXPECT_EQ(ensemble.GetVarCount(), 6);
+	EXPECT_TRUE(ensemble.MatchesModel(*model, cv::ml::DTrees::PREDICT_SUM));
+	EXPECT_EQ(countMismatches(*model, ensemble, randomSamples(1000, 6, 2)), 0u);
+}
+
+TEST(TreeEnsembleTest, BoostPredictSum)
+{
+	auto model = trainBoost(randomSamples(500, 6, 3), 30);
+	ASSERT_TRUE(TreeEnsemble::IsSupported(*model));
+	TreeEnsemble ensemble(*model);
+	EXPECT_TRUE(ensemble.MatchesModel(*model, cv::ml::DTrees::PREDICT_SUM));
+	EXPECT_EQ(countMismatches(*model, ensemble, randomSamples(1000, 6, 4)), 0u);
+}
+
+TEST(TreeEnsembleTest, InversedSplits)
+{
+	// a stored split "gt" instead of "le" is loaded as inversed split
+	auto trained = trainRTrees(randomSamples(500, 6, 5), 10, 5);
+	cv::FileStorage storage(".yml", cv::FileStorage::WRITE | cv::FileStorage::MEMORY);
+	storage << trained->getDefaultName() << "{";
+	trained->write(storage);
+	storage << "}";
+	std::string yaml = std::regex_replace(storage.releaseAndGetString(), std::regex("(\\s)le:"), "$1gt:");
+	auto model = cv::Algorithm::loadFromString<cv::ml::RTrees>(yaml);
+
+	const auto& splits = model->getSplits();
+	ASSERT_FALSE(splits.empty());
+	ASSERT_TRUE(std::all_of(splits.begin(), splits.end(),
+		[](const cv::ml::DTrees::Split& split) { return split.inversed; }));
+
+	TreeEnsemble ensemble(*model);
+	EXPECT_TRUE(ensemble.MatchesModel(*model, cv::ml::DTrees::PREDICT_SUM));
+	EXPECT_EQ(countMismatches(*model, ensemble, randomSamples(1000, 6, 6)), 0u);
+}
+
+TEST(TreeEnsembleTest, CategoricalSplitsAreRejected)
+{
+	const int numSamples = 500;
+	const int numVars = 3;
+	cv::Mat samples = randomSamples(numSamples, numVars, 7);
+	cv::Mat responses(numSamples, 1, CV_32S);
+	for (int i = 0; i < numSamples; i++)
+	{
+		// the first variable is a category, which alone determines the class
+		const int category = i % 4;
+		samples.at<float>(i, 0) = static_cast<float>(category);
+		responses.at<int>(i) = category == 1 || category == 2 ? 1 : 0;
+	}
+	cv::Mat varType(1, numVars + 1, CV_8U, cv::Scalar(cv::ml::VAR_ORDERED));
+	varType.at<uchar>(0) = cv::ml::VAR_CATEGORICAL;
+	varType.at<uchar>(numVars) = cv::ml::VAR_CATEGORICAL;
+
+	auto model = cv::ml::Boost::create();
+	model->setWeakCount(5);
+	model->setMaxDepth(2);
+	model->train(cv::ml::TrainData::create(samples, cv::ml::ROW_SAMPLE, responses,
+		cv::noArray(), cv::noArray(), cv::noArray(), varType));
+
+	const auto& splits = model->getSplits();
+	ASSERT_TRUE(std::any_of(splits.begin(), splits.end(),
+		[](const cv::ml::DTrees::Split& split) { return split.subsetOfs >= 0; }));
+	EXPECT_FALSE(TreeEnsemble::IsSupported(*model));
+	EXPECT_THROW(TreeEnsemble ensemble(*model), OFIQ_LIB::OFIQError);
+}
+
+TEST(TreeEnsembleTest, LargeForestPredictSum)
+{
+	// the size is in the order of the Sharpness random forest
+	const int numVars = 20;
+	const int numSamples = 2000;
+	auto model = trainRTrees(randomSamples(2000, numVars, 8), 100, 10);
+	TreeEnsemble ensemble(*model);
+	cv::Mat samples = randomSamples(numSamples, numVars, 9);
+
+	cv::Mat result;
+	for (int i = 0; i < numSamples; i++)
+	{
+		model->predict(samples.row(i), result, cv::ml::DTrees::PREDICT_SUM);
+		ASSERT_EQ(result.at<float>(0, 0), ensemble.PredictSum(samples.ptr<float>(i))) << "sample " << i;
+	}
+}